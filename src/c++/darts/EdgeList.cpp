@@ -0,0 +1,209 @@
+/******************************************************************************
+ *
+ * EdgeList.cpp
+ *
+ *
+ * Automated Dart Detection and Scoring System
+ *
+ *
+ * This project was developed as part of the Digital Image / Video Processing
+ * module at HAW Hamburg under Prof. Dr. Marc Hensel
+ *
+ *
+ *
+ * Author(s):   	Mika Paul Salewski <mika.paul.salewski@gmail.com>
+ *
+ * Created on :     2025-01-06
+ * Last revision :  None
+ *
+ *
+ *
+ * Copyright (c) 2025, Mika Paul Salewski
+ * Version: 2025.01.06
+ * License: CC BY-NC-SA 4.0,
+ *      see https://creativecommons.org/licenses/by-nc-sa/4.0/deed.en
+ *
+ *
+ * Further information about this source-file:
+ *      --> sparse list of edge pixels
+******************************************************************************/
+
+
+ /* Include files */
+#include "EdgeList.h"
+#include "Parallel.h"
+#include <cmath>
+#include <opencv2/opencv.hpp>
+
+/* Namespaces */
+using namespace cv;
+
+/* Expected share of edge pixels, used to reserve the lists */
+#define EDGE_LIST_RESERVE_DIV 16
+
+namespace ip {
+	/*! Reset the list for an image geometry.
+	*
+	* \param edges List to reset
+	* \param size Size of the edge image
+	* \param withDirection Reserve the direction array as well
+	*/
+	static void edgeListReset(EdgeList& edges, Size size, bool withDirection) {
+		size_t reserve = (size_t)size.area() / EDGE_LIST_RESERVE_DIV;
+
+		edges.clear();
+		edges.cols = size.width;
+		edges.rows = size.height;
+		edges.x.reserve(reserve);
+		edges.y.reserve(reserve);
+		if (withDirection)
+			edges.dir.reserve(reserve);
+	}
+
+	/*! Collect the selected pixels of an image in row stripes (in parallel), the list is sorted by rows.
+	*
+	* \param image Source image (CV_8U)
+	* \param direction Optional gradient direction (CV_32F), copied to the list
+	* \param edges [out] Edge pixels
+	* \param select Function select(value) deciding if a pixel is an edge pixel
+	*/
+	template <typename Select>
+	static void edgeListCollect(const Mat& image, const Mat& direction, EdgeList& edges, Select select) {
+		bool useDirection = !direction.empty() && (direction.type() == CV_32F) && (direction.size() == image.size());
+		int stripes = parallelStripes(image.rows);
+		std::vector<EdgeList> parts(stripes);
+
+		parallelForStripes(image.rows, stripes, [&](int begin, int end, int s) {
+			EdgeList& part = (stripes > 1) ? parts[s] : edges;
+			edgeListReset(part, Size(image.cols, end - begin), useDirection);
+
+			for (int y = begin; y < end; y++) {
+				const uchar* row = image.ptr<uchar>(y);
+				const float* rowDir = useDirection ? direction.ptr<float>(y) : NULL;
+
+				for (int x = 0; x < image.cols; x++) {
+					if (!select(row[x]))
+						continue;
+					part.x.push_back((int16_t)x);
+					part.y.push_back((int16_t)y);
+					if (useDirection)
+						part.dir.push_back(rowDir[x]);
+				}
+			}
+		});
+
+		// Merge stripes in row order
+		if (stripes > 1) {
+			edgeListReset(edges, Size(image.cols, 0), useDirection);
+			for (const EdgeList& part : parts) {
+				edges.x.insert(edges.x.end(), part.x.begin(), part.x.end());
+				edges.y.insert(edges.y.end(), part.y.begin(), part.y.end());
+				edges.dir.insert(edges.dir.end(), part.dir.begin(), part.dir.end());
+			}
+		}
+		edges.cols = image.cols;
+		edges.rows = image.rows;
+	}
+
+	/*! Threshold an edge magnitude image directly to an edge list.
+	*
+	* Same pixels as threshold(magnitude, bin, thresh, 255, THRESH_BINARY), i.e.
+	* magnitude > thresh, without writing the binary image.
+	*
+	* \param magnitude Edge magnitude (CV_8U), e.g. from ip::sobelFilter()
+	* \param thresh Threshold
+	* \param edges [out] Edge pixels
+	* \param direction Optional gradient direction (CV_32F), copied to the list
+	*/
+	void edgeListThreshold(const Mat& magnitude, double thresh, EdgeList& edges, const Mat& direction) {
+		if (magnitude.type() != CV_8U)
+			return;
+		int t = cvFloor(thresh);
+
+		edgeListCollect(magnitude, direction, edges, [t](uchar value) { return value > t; });
+	}
+
+	/*! Collect the edge pixels (value 255) of a binary edge image.
+	*
+	* \param edgeImage Binary edge image (CV_8U)
+	* \param edges [out] Edge pixels
+	* \param direction Optional gradient direction (CV_32F), copied to the list
+	*/
+	void edgeListFromImage(const Mat& edgeImage, EdgeList& edges, const Mat& direction) {
+		if (edgeImage.type() != CV_8U)
+			return;
+
+		edgeListCollect(edgeImage, direction, edges, [](uchar value) { return value == 255; });
+	}
+
+	/*! Draw an edge list as binary edge image (e.g. for display or image based consumers).
+	*
+	* \param edges Edge pixels
+	* \param edgeImage [out] Binary edge image (CV_8U), edge pixels 255
+	*/
+	void edgeListToImage(const EdgeList& edges, Mat& edgeImage) {
+		edgeImage = Mat::zeros(Size(edges.cols, edges.rows), CV_8U);
+		for (size_t i = 0; i < edges.size(); i++)
+			edgeImage.at<uchar>(edges.y[i], edges.x[i]) = 255;
+	}
+
+	/*! Remove all edge pixels inside a rotated rect (in place, order is kept).
+	*
+	* \param edges Edge pixels
+	* \param rect Rotated rect to erase
+	*/
+	void edgeListEraseRotatedRect(EdgeList& edges, const RotatedRect& rect) {
+		// Rect axes, +0.5 pixel so pixels on the border are erased like by fillConvexPoly()
+		float angle = rect.angle * (float)(CV_PI / 180.0);
+		float ax = std::cos(angle);
+		float ay = std::sin(angle);
+		float halfLength = rect.size.width / 2 + 0.5f;
+		float halfWidth = rect.size.height / 2 + 0.5f;
+		bool hasDirection = edges.hasDirection();
+
+		size_t n = 0;
+		for (size_t i = 0; i < edges.size(); i++) {
+			float dx = edges.x[i] - rect.center.x;
+			float dy = edges.y[i] - rect.center.y;
+			if ((std::abs(dx * ax + dy * ay) <= halfLength) && (std::abs(dy * ax - dx * ay) <= halfWidth))
+				continue;
+
+			edges.x[n] = edges.x[i];
+			edges.y[n] = edges.y[i];
+			if (hasDirection)
+				edges.dir[n] = edges.dir[i];
+			n++;
+		}
+		edges.x.resize(n);
+		edges.y.resize(n);
+		if (hasDirection)
+			edges.dir.resize(n);
+	}
+
+	/*! Keep only the edge pixels inside a mask (in place, order is kept).
+	*
+	* \param edges Edge pixels
+	* \param mask Mask (CV_8U) of the edge image geometry, pixels != 0 are kept
+	*/
+	void edgeListKeepMask(EdgeList& edges, const Mat& mask) {
+		if ((mask.type() != CV_8U) || (mask.cols != edges.cols) || (mask.rows != edges.rows))
+			return;
+
+		bool hasDirection = edges.hasDirection();
+		size_t n = 0;
+		for (size_t i = 0; i < edges.size(); i++) {
+			if (mask.at<uchar>(edges.y[i], edges.x[i]) == 0)
+				continue;
+
+			edges.x[n] = edges.x[i];
+			edges.y[n] = edges.y[i];
+			if (hasDirection)
+				edges.dir[n] = edges.dir[i];
+			n++;
+		}
+		edges.x.resize(n);
+		edges.y.resize(n);
+		if (hasDirection)
+			edges.dir.resize(n);
+	}
+}
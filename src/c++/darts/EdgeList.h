@@ -0,0 +1,66 @@
+/******************************************************************************
+ *
+ * EdgeList.h
+ *
+ *
+ * Automated Dart Detection and Scoring System
+ *
+ *
+ * This project was developed as part of the Digital Image / Video Processing
+ * module at HAW Hamburg under Prof. Dr. Marc Hensel
+ *
+ *
+ *
+ * Author(s):   	Mika Paul Salewski <mika.paul.salewski@gmail.com>
+ *
+ * Created on :     2025-01-06
+ * Last revision :  None
+ *
+ *
+ *
+ * Copyright (c) 2025, Mika Paul Salewski
+ * Version: 2025.01.06
+ * License: CC BY-NC-SA 4.0,
+ *      see https://creativecommons.org/licenses/by-nc-sa/4.0/deed.en
+ *
+ *
+ * Further information about this source-file:
+ *      --> sparse list of edge pixels, darts cover only a few percent of
+ *          the image, so the edge consumers iterate this list instead of
+ *          scanning full binary frames
+******************************************************************************/
+
+
+#ifndef IP_EDGE_LIST_H
+#define IP_EDGE_LIST_H
+
+ /* Include files */
+#include <opencv2/opencv.hpp>
+#include <cstdint>
+#include <vector>
+
+namespace ip
+{
+	/* Edge pixels as structure of arrays, sorted by rows (y, then x) */
+	struct EdgeList {
+		int cols = 0;					// Geometry of the edge image
+		int rows = 0;
+		std::vector<int16_t> x;
+		std::vector<int16_t> y;
+		std::vector<float> dir;			// Gradient direction in [0, pi) (optional, empty if not available)
+
+		size_t size() const { return x.size(); }
+		bool empty() const { return x.empty(); }
+		bool hasDirection() const { return !dir.empty(); }
+		void clear() { x.clear(); y.clear(); dir.clear(); }
+	};
+
+	/* Prototypes */
+	void edgeListThreshold(const cv::Mat& magnitude, double thresh, EdgeList& edges, const cv::Mat& direction = cv::Mat());
+	void edgeListFromImage(const cv::Mat& edgeImage, EdgeList& edges, const cv::Mat& direction = cv::Mat());
+	void edgeListToImage(const EdgeList& edges, cv::Mat& edgeImage);
+	void edgeListEraseRotatedRect(EdgeList& edges, const cv::RotatedRect& rect);
+	void edgeListKeepMask(EdgeList& edges, const cv::Mat& mask);
+}
+
+#endif /* IP_EDGE_LIST_H */
@@ -55,23 +55,672 @@
 
 /* Include files */
 #include "HoughLine.h"
+#include "Parallel.h"
 #include <cmath>
+#include <cstdint>
+#include <vector>
+#include <mutex>
+#include <algorithm>
+#include <memory>
 #include <opencv2/opencv.hpp>
+#include <opencv2/core/hal/intrin.hpp>
 /* Namespaces */
 using namespace cv;
 
 #define CROSS_IMG_COLOR_INTENSITY 20
 
+#define HOUGH_FIXED_POINT_BITS 40		// Fractional bits of the radius LUTs (64 bit fixed point)
+#define HOUGH_CHUNK_EDGES_PER_ROW 4		// Minimum edge pixels per chunk and accumulator row (votes outweigh zeroing and merging)
+#define HOUGH_MAX_CHUNKS 8			// Maximum chunk accumulators (memory bound, one full accumulator each)
+#define HOUGH_LUT_CACHE_SIZE 4			// Cached LUT geometries (full resolution, pyramid levels, ...), cols x width x 8 byte each
+#define HOUGH_WINDOW_DIR_SLACK (M_PI / 20)	// Gradient direction noise allowed on top of the window tolerance
+
 namespace ip {
 
-	/*! Calculate Hough transform for lines.
+	/* Fixed point LUTs, cached across calls (see houghAccumulate()) */
+	struct HoughLUT {
+		int cols = 0;
+		int rows = 0;
+		int height = 0;
+		int width = 0;
+		std::vector<int64_t> cosLUT;	// cos(theta) / deltaRadius in HOUGH_FIXED_POINT_BITS fixed point
+		std::vector<int64_t> sinLUT;	// sin(theta) / deltaRadius in HOUGH_FIXED_POINT_BITS fixed point
+		std::vector<int64_t> colLUT;	// (x - cols / 2) * cosLUT, one row of width entries per column x
+	};
+
+	static std::vector<std::shared_ptr<const HoughLUT>> houghLUTCache;
+	static std::mutex houghLUTMutex;
+
+	/*! Get the cached fixed point LUTs, build them for a new geometry.
+	*
+	* The LUTs are immutable once built, the caller keeps them alive through the
+	* returned pointer without holding the lock (even if they are evicted meanwhile).
+	*
+	* \param cols Edge image width
+	* \param rows Edge image height
+	* \param height Hough space height (r axis)
+	* \param width Hough space width (theta axis)
+	* \return Fixed point LUTs of the geometry
+	*/
+	static std::shared_ptr<const HoughLUT> getHoughLUT(int cols, int rows, int height, int width) {
+		std::lock_guard<std::mutex> lock(houghLUTMutex);
+
+		// Look up geometry (e.g. full resolution and coarse pyramid level)
+		for (const std::shared_ptr<const HoughLUT>& lut : houghLUTCache) {
+			if ((lut->cols == cols) && (lut->rows == rows) && (lut->height == height) && (lut->width == width))
+				return lut;
+		}
+
+		std::shared_ptr<HoughLUT> lut = std::make_shared<HoughLUT>();
+		double deltaTheta = M_PI / (double)width;
+		double deltaRadius = sqrt(cols * cols + rows * rows) / height;
+		double scale = (double)((int64_t)1 << HOUGH_FIXED_POINT_BITS) / deltaRadius;
+
+		lut->cosLUT.resize(width);
+		lut->sinLUT.resize(width);
+		for (int u = 0; u < width; u++) {
+			double theta = deltaTheta * u;
+			lut->cosLUT[u] = (int64_t)llround(cos(theta) * scale);
+			lut->sinLUT[u] = (int64_t)llround(sin(theta) * scale);
+		}
+
+		// Column part of the radius, turns the per edge multiplications into additions
+		lut->colLUT.resize((size_t)cols * width);
+		for (int x = 0; x < cols; x++) {
+			int64_t xc = x - cols / 2;
+			int64_t* colRow = &lut->colLUT[(size_t)x * width];
+			for (int u = 0; u < width; u++)
+				colRow[u] = xc * lut->cosLUT[u];
+		}
+		lut->cols = cols;
+		lut->rows = rows;
+		lut->height = height;
+		lut->width = width;
+
+		if (houghLUTCache.size() >= HOUGH_LUT_CACHE_SIZE)
+			houghLUTCache.erase(houghLUTCache.begin());
+		houghLUTCache.push_back(lut);
+
+		return lut;
+	}
+
+	/*! Accumulator indices of one edge pixel for all angles theta (fixed point, SIMD).
+	*
+	* The radius bin of angle u is (colRow[u] + rowLUT[u]) >> HOUGH_FIXED_POINT_BITS,
+	* rounded toward zero like (int) and clamped to [0, vMax].
+	*
+	* \param colRow Column part of the radius, see HoughLUT::colLUT
+	* \param rowLUT Row part of the radius incl. rounding offset
+	* \param index [out] Accumulator indices (bin * width + u)
+	* \param width Width of the accumulator (theta axis)
+	* \param v0 Row of r = 0
+	* \param vMax Last row of the accumulator
+	*/
+	static void houghIndexRow(const int64_t* colRow, const int64_t* rowLUT, int* index, int width, int v0, int vMax) {
+		const int64_t roundMask = ((int64_t)1 << HOUGH_FIXED_POINT_BITS) - 1;
+		int u = 0;
+
+#if CV_SIMD128
+		// 4 angles per iteration, 64 bit adds and shifts only
+		const v_int64x2 vRoundMask = v_setall_s64(roundMask);
+		const v_int32x4 vV0 = v_setall_s32(v0);
+		const v_int32x4 vZero = v_setzero_s32();
+		const v_int32x4 vMax4 = v_setall_s32(vMax);
+		const v_int32x4 vWidth = v_setall_s32(width);
+		const v_int32x4 vStep = v_setall_s32(4);
+		v_int32x4 vU(0, 1, 2, 3);
+		for (; u <= width - 4; u += 4) {
+			v_int64x2 t0 = v_load(colRow + u) + v_load(rowLUT + u);
+			v_int64x2 t1 = v_load(colRow + u + 2) + v_load(rowLUT + u + 2);
+			t0 = (t0 + ((t0 >> 63) & vRoundMask)) >> HOUGH_FIXED_POINT_BITS;	// Round toward zero like (int)
+			t1 = (t1 + ((t1 >> 63) & vRoundMask)) >> HOUGH_FIXED_POINT_BITS;
+			v_int32x4 v = v_min(v_max(vV0 + v_pack(t0, t1), vZero), vMax4);
+			v_store(index + u, v * vWidth + vU);
+			vU += vStep;
+		}
+#endif
+
+		for (; u < width; u++) {
+			int64_t t = colRow[u] + rowLUT[u];
+			int64_t v = (t + ((t >> 63) & roundMask)) >> HOUGH_FIXED_POINT_BITS;	// Round toward zero like (int)
+			index[u] = std::min(std::max(v0 + (int)v, 0), vMax) * width + u;
+		}
+	}
+
+	/*! Run a voting function on chunks of the edge list in parallel.
+	*
+	* Every chunk votes into an own CV_32S accumulator, the chunks are merged at the end.
+	*
+	* \param numEdges Number of edge pixels
+	* \param accumulator Destination CV_16U accumulator (votes, saturated)
+	* \param height Height of the accumulator (r axis)
+	* \param width Width of the accumulator (theta axis)
+	* \param vote Voting function vote(begin, end, accData) for the edge pixels [begin, end)
+	*/
+	template <typename Vote>
+	static void accumulateChunks(size_t numEdges, Mat& accumulator, int height, int width, Vote vote) {
+		// Chunks of the edge list, each with an own accumulator: bounded by the threads and by the
+		// accumulator size, a chunk only pays off if its votes outweigh zeroing and merging its accumulator
+		int numChunks = std::min(parallelStripes((int)numEdges, HOUGH_CHUNK_EDGES_PER_ROW * height), HOUGH_MAX_CHUNKS);
+		std::vector<Mat> chunkAcc(numChunks);
+
+		parallelForStripes((int)numEdges, numChunks, [&](int begin, int end, int c) {
+			Mat acc = Mat::zeros(Size(width, height), CV_32S);
+			vote((size_t)begin, (size_t)end, acc.ptr<int>());
+			chunkAcc[c] = acc;
+		});
+
+		// Merge chunks
+		Mat sum = chunkAcc[0];
+		for (int c = 1; c < numChunks; c++)
+			sum += chunkAcc[c];
+		sum.convertTo(accumulator, CV_16U);
+	}
+
+	/*! Accumulate Hough votes for lines (fixed point, multithreaded).
+	*
+	* Same accumulator as houghAccumulateReference(). For an even height the
+	* image corners round to one bin past the last row, these votes are clamped
+	* to the last row (odd heights never reach it). The radius bin
+	* (int)(r / deltaRadius + 0.5) is evaluated in 64 bit fixed point with rounding
+	* toward zero, which matches the double precision reference for every pixel of
+	* a 640x480 image (32 bit fixed point does not, at most 23 fractional bits fit).
+	* The column and row parts of the radius come from LUTs, so the loop over theta
+	* only adds and shifts (SIMD, see houghIndexRow()).
+	* The edge list is split into at most one chunk per thread, each with an own
+	* accumulator, the chunks are merged at the end.
+	*
+	* \param edges Edge pixels (see ip::EdgeList)
+	* \param accumulator Destination CV_16U accumulator (votes, saturated)
+	* \param height Target height of destination image (r axis)
+	* \param width Target width of destination image (theta axis, covering [0, pi])
+	*/
+	void houghAccumulate(const EdgeList& edges, Mat& accumulator, int height, int width) {
+		// Edge image geometry (source)
+		Point imgCenter(edges.cols / 2, edges.rows / 2);
+
+		// Hough image geometry (destination)
+		int v0 = height / 2;			// Draw r = 0 at vertical center
+		const int64_t half = (int64_t)1 << (HOUGH_FIXED_POINT_BITS - 1);
+
+		// Cached LUTs
+		std::shared_ptr<const HoughLUT> lut = getHoughLUT(edges.cols, edges.rows, height, width);
+		const int64_t* sinLUT = lut->sinLUT.data();
+
+		// Even heights: the corners of the image round to one bin past the last row
+		const int vMax = height - 1;
+
+		accumulateChunks(edges.size(), accumulator, height, width, [&](size_t begin, size_t end, int* accData) {
+			std::vector<int64_t> rowLUT(width);
+			std::vector<int> index(width);
+			int rowLUTy = -1;
+
+			for (size_t i = begin; i < end; i++) {
+				// Part of the radius that is constant within the row (incl. rounding offset), list is sorted by rows
+				if (edges.y[i] != rowLUTy) {
+					rowLUTy = edges.y[i];
+					int64_t yc = rowLUTy - imgCenter.y;
+					for (int u = 0; u < width; u++)
+						rowLUT[u] = yc * sinLUT[u] + half;
+				}
+
+				// Accumulator indices for all angles theta
+				houghIndexRow(&lut->colLUT[(size_t)edges.x[i] * width], rowLUT.data(), index.data(), width, v0, vMax);
+
+				// Increment accumulator
+				for (int u = 0; u < width; u++)
+					accData[index[u]]++;
+			}
+		});
+	}
+
+	/*! Accumulate Hough votes for lines of an edge image, see houghAccumulate(const EdgeList&, ...).
 	*
 	* \param edgeImage Source edge image (with edge pixels marked by value 255)
-	* \param houghImage Destination image to hold Hough transform of edge pixels
+	* \param accumulator Destination CV_16U accumulator (votes, saturated)
 	* \param height Target height of destination image (r axis)
 	* \param width Target width of destination image (theta axis, covering [0, pi])
 	*/
-	void houghTransform(const Mat& edgeImage, Mat& houghSpace, int height, int width) {
+	void houghAccumulate(const Mat& edgeImage, Mat& accumulator, int height, int width) {
+		// Check image type
+		if (edgeImage.type() != CV_8U)
+			return;
+
+		EdgeList edges;
+		edgeListFromImage(edgeImage, edges);
+		houghAccumulate(edges, accumulator, height, width);
+	}
+
+	/*! Accumulate Hough votes for lines, constrained by the gradient direction.
+	*
+	* Every edge pixel votes only for the angles within +/- window of its edge
+	* normal (gradient direction) instead of all angles. Angles wrap around at
+	* theta = pi, the radius is evaluated for the wrapped angle.
+	*
+	* \param edges Edge pixels with gradient direction in [0, pi), see ip::sobelFilter()
+	* \param accumulator Destination CV_16U accumulator (votes, saturated)
+	* \param window Half width of the voting window in theta bins
+	* \param height Target height of destination image (r axis)
+	* \param width Target width of destination image (theta axis, covering [0, pi])
+	*/
+	void houghAccumulateOriented(const EdgeList& edges, Mat& accumulator, int window, int height, int width) {
+		// Check direction
+		if (!edges.hasDirection())
+			return;
+
+		// Edge image geometry (source)
+		Point imgCenter(edges.cols / 2, edges.rows / 2);
+
+		// Hough image geometry (destination)
+		int v0 = height / 2;			// Draw r = 0 at vertical center
+		const int64_t half = (int64_t)1 << (HOUGH_FIXED_POINT_BITS - 1);
+		const int64_t roundMask = ((int64_t)1 << HOUGH_FIXED_POINT_BITS) - 1;
+		const float binsPerRadian = (float)(width / M_PI);
+		window = std::min(window, (width - 1) / 2);
+		const int vMax = height - 1;	// Even heights, see houghAccumulate()
+
+		// Cached LUTs
+		std::shared_ptr<const HoughLUT> lut = getHoughLUT(edges.cols, edges.rows, height, width);
+		const int64_t* sinLUT = lut->sinLUT.data();
+
+		accumulateChunks(edges.size(), accumulator, height, width, [&](size_t begin, size_t end, int* accData) {
+			for (size_t i = begin; i < end; i++) {
+				const int64_t* colRow = &lut->colLUT[(size_t)edges.x[i] * width];
+				int64_t yc = edges.y[i] - imgCenter.y;
+				int uNormal = (int)(edges.dir[i] * binsPerRadian + 0.5f);
+
+				// Vote within the window around the edge normal
+				for (int k = -window; k <= window; k++) {
+					int u = uNormal + k;
+					if (u < 0)
+						u += width;
+					else if (u >= width)
+						u -= width;
+
+					int64_t t = colRow[u] + yc * sinLUT[u] + half;
+					int64_t v = (t + ((t >> 63) & roundMask)) >> HOUGH_FIXED_POINT_BITS;	// Round toward zero like (int)
+					accData[std::min(std::max(v0 + (int)v, 0), vMax) * width + u]++;
+				}
+			}
+		});
+	}
+
+	/*! Accumulate Hough votes for lines of an edge image, constrained by the gradient direction.
+	*
+	* \param edgeImage Source edge image (with edge pixels marked by value 255)
+	* \param direction Gradient direction (CV_32F) in [0, pi), see ip::sobelFilter()
+	* \param accumulator Destination CV_16U accumulator (votes, saturated)
+	* \param window Half width of the voting window in theta bins
+	* \param height Target height of destination image (r axis)
+	* \param width Target width of destination image (theta axis, covering [0, pi])
+	*/
+	void houghAccumulateOriented(const Mat& edgeImage, const Mat& direction, Mat& accumulator, int window, int height, int width) {
+		// Check image types
+		if ((edgeImage.type() != CV_8U) || (direction.type() != CV_32F) || (direction.size() != edgeImage.size()))
+			return;
+
+		EdgeList edges;
+		edgeListFromImage(edgeImage, edges, direction);
+		houghAccumulateOriented(edges, accumulator, window, height, width);
+	}
+
+	/*! Calculate Hough transform for lines, constrained by the gradient direction.
+	*
+	* \param edgeImage Source edge image (with edge pixels marked by value 255)
+	* \param direction Gradient direction (CV_32F) in [0, pi), see ip::sobelFilter()
+	* \param houghSpace Destination image to hold Hough transform of edge pixels
+	* \param window Half width of the voting window in theta bins
+	* \param height Target height of destination image (r axis)
+	* \param width Target width of destination image (theta axis, covering [0, pi])
+	*/
+	void houghTransformOriented(const Mat& edgeImage, const Mat& direction, Mat& houghSpace, int window, int height, int width) {
+		// Check image type
+		if (edgeImage.type() != CV_8U)
+			return;
+
+		// Accumulate votes
+		houghAccumulateOriented(edgeImage, direction, houghSpace, window, height, width);
+
+		// Convert to maximized 8-bit grayscale
+		double maxValue;
+		minMaxLoc(houghSpace, NULL, &maxValue);
+		houghSpace.convertTo(houghSpace, CV_8U, (maxValue > 0) ? 255.0 / maxValue : 0.0);
+	}
+
+	/*! Accumulate Hough votes in a (r, theta) window around a predicted line.
+	*
+	* Only edge pixels inside a band around the predicted line vote, and only for
+	* the bins of the window. The bins keep the geometry of the full Hough space
+	* (height x width), window holds the position of the accumulator in it. The
+	* theta range of the window is not wrapped, so window.x may be negative or
+	* exceed width; use normalizeLine() on lines taken from the window.
+	*
+	* \param edges Edge pixels, pixels with a gradient direction (if available) outside
+	*              the theta tolerance do not vote
+	* \param accumulator Destination CV_16U accumulator of the window
+	* \param window [out] Position of the accumulator in the full Hough space (bins)
+	* \param r0 Radius of the predicted line
+	* \param theta0 Angle of the predicted line [0, pi]
+	* \param rTolerance Tolerance of the radius (pixels)
+	* \param thetaTolerance Tolerance of the angle (radians)
+	* \param height Height of the full Hough space (r axis)
+	* \param width Width of the full Hough space (theta axis, covering [0, pi])
+	*/
+	void houghAccumulateWindow(const EdgeList& edges, Mat& accumulator, Rect& window, double r0, double theta0, double rTolerance, double thetaTolerance, int height, int width) {
+		bool useDirection = edges.hasDirection();
+
+		// Edge image geometry (source)
+		Point imgCenter(edges.cols / 2, edges.rows / 2);
+
+		// Hough image geometry (destination)
+		double deltaTheta = M_PI / (double)width;
+		double deltaRadius = sqrt(edges.cols * edges.cols + edges.rows * edges.rows) / height;
+		int v0 = height / 2;			// Draw r = 0 at vertical center
+
+		// Window in bins of the full Hough space
+		int uCenter = (int)(theta0 / deltaTheta + 0.5);
+		int du = (int)ceil(thetaTolerance / deltaTheta);
+		int vCenter = v0 + (int)floor(r0 / deltaRadius + 0.5);
+		int dv = (int)ceil(rTolerance / deltaRadius);
+		window = Rect(uCenter - du, std::max(0, vCenter - dv), 2 * du + 1, 0);
+		window.height = std::min(height, vCenter + dv + 1) - window.y;
+		if (window.height <= 0) {
+			accumulator = Mat::zeros(Size(window.width, 1), CV_16U);
+			return;
+		}
+
+		// LUTs of the window angles (not wrapped)
+		std::vector<double> cosLUT(window.width), sinLUT(window.width);
+		for (int i = 0; i < window.width; i++) {
+			double theta = deltaTheta * (window.x + i);
+			cosLUT[i] = cos(theta) / deltaRadius;
+			sinLUT[i] = sin(theta) / deltaRadius;
+		}
+
+		// Band around the predicted line, it widens with the distance along the line
+		double nx = cos(theta0), ny = sin(theta0);
+		double sinTol = sin(std::min(thetaTolerance, M_PI / 2));
+		double bandWidth = rTolerance + deltaRadius;
+
+		accumulateChunks(edges.size(), accumulator, window.height, window.width, [&](size_t begin, size_t end, int* accData) {
+			for (size_t k = begin; k < end; k++) {
+				int xc = edges.x[k] - imgCenter.x;
+				int yc = edges.y[k] - imgCenter.y;
+
+				// Distance to and position along the predicted line
+				double d = xc * nx + yc * ny - r0;
+				double t = -xc * ny + yc * nx;
+				if (fabs(d) > bandWidth + fabs(t) * sinTol)
+					continue;
+
+				// Normal has to match the window (normals have no sign)
+				if (useDirection) {
+					double dTheta = fabs(edges.dir[k] - theta0);
+					if (std::min(dTheta, M_PI - dTheta) > thetaTolerance + HOUGH_WINDOW_DIR_SLACK)
+						continue;
+				}
+
+				// Vote within the window
+				for (int i = 0; i < window.width; i++) {
+					int v = v0 + (int)floor(xc * cosLUT[i] + yc * sinLUT[i] + 0.5) - window.y;
+					if ((v >= 0) && (v < window.height))
+						accData[v * window.width + i]++;
+				}
+			}
+		});
+	}
+
+	/*! Accumulate Hough votes of an edge image in a window around a predicted line.
+	*
+	* \param edgeImage Source edge image (with edge pixels marked by value 255)
+	* \param accumulator Destination CV_16U accumulator of the window
+	* \param window [out] Position of the accumulator in the full Hough space (bins)
+	* \param r0 Radius of the predicted line
+	* \param theta0 Angle of the predicted line [0, pi]
+	* \param rTolerance Tolerance of the radius (pixels)
+	* \param thetaTolerance Tolerance of the angle (radians)
+	* \param direction Optional gradient direction (CV_32F, see ip::sobelFilter())
+	* \param height Height of the full Hough space (r axis)
+	* \param width Width of the full Hough space (theta axis, covering [0, pi])
+	*/
+	void houghAccumulateWindow(const Mat& edgeImage, Mat& accumulator, Rect& window, double r0, double theta0, double rTolerance, double thetaTolerance, const Mat& direction, int height, int width) {
+		// Check image type
+		if (edgeImage.type() != CV_8U)
+			return;
+
+		EdgeList edges;
+		edgeListFromImage(edgeImage, edges, direction);
+		houghAccumulateWindow(edges, accumulator, window, r0, theta0, rTolerance, thetaTolerance, height, width);
+	}
+
+	/*! Accumulate Hough votes coarse-to-fine (no prior line).
+	*
+	* The full Hough space is accumulated with a reduced number of bins
+	* (height >> levels, width >> levels), the strongest line of this coarse
+	* accumulator is the prior of a window at full resolution.
+	*
+	* \param edges Edge pixels, the gradient direction (if available) gates the window
+	* \param accumulator Destination CV_16U accumulator of the window
+	* \param window [out] Position of the accumulator in the full Hough space (bins), see houghAccumulateWindow()
+	* \param rTolerance Minimum tolerance of the radius around the coarse line (pixels)
+	* \param thetaTolerance Minimum tolerance of the angle around the coarse line (radians)
+	* \param levels Number of halvings of the bins in both axes for the coarse accumulator
+	* \param height Height of the full Hough space (r axis)
+	* \param width Width of the full Hough space (theta axis, covering [0, pi])
+	*/
+	void houghAccumulatePyramid(const EdgeList& edges, Mat& accumulator, Rect& window, double rTolerance, double thetaTolerance, int levels, int height, int width) {
+		// Coarse accumulator
+		Size imgSize(edges.cols, edges.rows);
+		Size coarseSize(std::max(1, width >> levels), (height >> levels) | 1);	// Odd height keeps r = 0 on a bin center
+		Mat coarse;
+		houghAccumulate(edges, coarse, coarseSize.height, coarseSize.width);
+
+		// Strongest coarse line
+		Point maxLocation;
+		minMaxLoc(coarse, NULL, NULL, NULL, &maxLocation);
+		double r, theta;
+		houghSpaceToLine(imgSize, coarseSize, maxLocation.x, maxLocation.y, r, theta);
+
+		// Window at full resolution covers at least one coarse bin on each side
+		double coarseDeltaTheta = M_PI / coarseSize.width;
+		double coarseDeltaRadius = sqrt(edges.cols * edges.cols + edges.rows * edges.rows) / coarseSize.height;
+		houghAccumulateWindow(edges, accumulator, window, r, theta,
+			std::max(rTolerance, coarseDeltaRadius), std::max(thetaTolerance, coarseDeltaTheta), height, width);
+	}
+
+	/*! Accumulate Hough votes coarse-to-fine around several coarse lines (no prior line).
+	*
+	* As houghAccumulatePyramid(const EdgeList&, ...), but every peak of the
+	* coarse accumulator (up to maxWindows, e.g. one per dart) gets a window at
+	* full resolution. The first window belongs to the strongest coarse line.
+	*
+	* \param edges Edge pixels, the gradient direction (if available) gates the windows
+	* \param accumulators [out] Destination CV_16U accumulators of the windows
+	* \param windows [out] Positions of the accumulators in the full Hough space (bins)
+	* \param rTolerance Minimum tolerance of the radius around a coarse line (pixels)
+	* \param thetaTolerance Minimum tolerance of the angle around a coarse line (radians)
+	* \param maxWindows Maximum number of windows
+	* \param peakRadius Suppression radius of the coarse peaks (coarse bins)
+	* \param levels Number of halvings of the bins in both axes for the coarse accumulator
+	* \param height Height of the full Hough space (r axis)
+	* \param width Width of the full Hough space (theta axis, covering [0, pi])
+	* \return Number of windows
+	*/
+	int houghAccumulatePyramid(const EdgeList& edges, std::vector<Mat>& accumulators, std::vector<Rect>& windows, double rTolerance, double thetaTolerance, int maxWindows, int peakRadius, int levels, int height, int width) {
+		accumulators.clear();
+		windows.clear();
+
+		// Coarse accumulator
+		Size imgSize(edges.cols, edges.rows);
+		Size coarseSize(std::max(1, width >> levels), (height >> levels) | 1);	// Odd height keeps r = 0 on a bin center
+		Mat coarse;
+		houghAccumulate(edges, coarse, coarseSize.height, coarseSize.width);
+
+		// Strongest coarse lines, theta is periodic in the full Hough space
+		std::vector<HoughPeak> peaks;
+		int numPeaks = houghPeaks(coarse, peaks, maxWindows, peakRadius, 1, true);
+
+		// Windows at full resolution cover at least one coarse bin on each side
+		double coarseDeltaTheta = M_PI / coarseSize.width;
+		double coarseDeltaRadius = sqrt(edges.cols * edges.cols + edges.rows * edges.rows) / coarseSize.height;
+		accumulators.resize(numPeaks);
+		windows.resize(numPeaks);
+		for (int k = 0; k < numPeaks; k++) {
+			// Bin of the peak (without sub-bin refinement)
+			int u = ((cvRound(peaks[k].u) % coarseSize.width) + coarseSize.width) % coarseSize.width;
+			int v = std::min(std::max(cvRound(peaks[k].v), 0), coarseSize.height - 1);
+			double r, theta;
+			houghSpaceToLine(imgSize, coarseSize, u, v, r, theta);
+			houghAccumulateWindow(edges, accumulators[k], windows[k], r, theta,
+				std::max(rTolerance, coarseDeltaRadius), std::max(thetaTolerance, coarseDeltaTheta), height, width);
+		}
+
+		return numPeaks;
+	}
+
+	/*! Accumulate Hough votes of an edge image coarse-to-fine, see houghAccumulatePyramid(const EdgeList&, ...).
+	*
+	* \param edgeImage Source edge image (with edge pixels marked by value 255)
+	* \param accumulator Destination CV_16U accumulator of the window
+	* \param window [out] Position of the accumulator in the full Hough space (bins)
+	* \param rTolerance Minimum tolerance of the radius around the coarse line (pixels)
+	* \param thetaTolerance Minimum tolerance of the angle around the coarse line (radians)
+	* \param direction Optional gradient direction (CV_32F), see houghAccumulateWindow()
+	* \param levels Number of halvings of the bins in both axes for the coarse accumulator
+	* \param height Height of the full Hough space (r axis)
+	* \param width Width of the full Hough space (theta axis, covering [0, pi])
+	*/
+	void houghAccumulatePyramid(const Mat& edgeImage, Mat& accumulator, Rect& window, double rTolerance, double thetaTolerance, const Mat& direction, int levels, int height, int width) {
+		// Check image type
+		if (edgeImage.type() != CV_8U)
+			return;
+
+		EdgeList edges;
+		edgeListFromImage(edgeImage, edges, direction);
+		houghAccumulatePyramid(edges, accumulator, window, rTolerance, thetaTolerance, levels, height, width);
+	}
+
+	/*! Map a line to the range theta in [0, pi) (e.g. taken from a not wrapped window).
+	*
+	* \param r [in, out] Radius of the line
+	* \param theta [in, out] Angle of the line
+	*/
+	void normalizeLine(double& r, double& theta) {
+		while (theta < 0) {
+			theta += M_PI;
+			r = -r;
+		}
+		while (theta >= M_PI) {
+			theta -= M_PI;
+			r = -r;
+		}
+	}
+
+	/*! Read an accumulator bin, optionally continued beyond the theta borders.
+	*
+	* Continuing theta by pi flips the sign of r, i.e. the row is mirrored at r = 0.
+	*
+	* \param acc CV_16U accumulator
+	* \param u Column (theta)
+	* \param v Row (r)
+	* \param wrapTheta Continue the theta axis periodically (full Hough space)
+	* \return Votes of the bin, -1 outside the accumulator
+	*/
+	static int houghBin(const Mat& acc, int u, int v, bool wrapTheta) {
+		if ((u < 0) || (u >= acc.cols)) {
+			if (!wrapTheta)
+				return -1;
+			u = (u + acc.cols) % acc.cols;
+			v = 2 * (acc.rows / 2) - v;
+		}
+		if ((v < 0) || (v >= acc.rows))
+			return -1;
+		return acc.at<ushort>(v, u);
+	}
+
+	/*! Vertex offset of a parabola through three equidistant samples.
+	*
+	* \return Offset of the maximum from the center sample [-0.5, 0.5]
+	*/
+	static double parabolaOffset(int left, int center, int right) {
+		if ((left < 0) || (right < 0))
+			return 0.0;
+		double denom = (double)left - 2.0 * center + right;
+		if (denom >= 0.0)
+			return 0.0;
+		return std::max(-0.5, std::min(0.5, 0.5 * (left - right) / denom));
+	}
+
+	/*! Find the strongest peaks of a Hough accumulator.
+	*
+	* Works directly on the 16 bit votes in a single pass: a bin is a peak if no
+	* bin within the suppression radius has more votes (plateaus keep their first
+	* bin). The position of each peak is refined to sub-bin resolution by a
+	* parabola through the neighboring bins along theta and r.
+	*
+	* \param accumulator CV_16U accumulator (e.g. from houghAccumulate())
+	* \param peaks [out] Peaks sorted by votes (descending), positions in bins of the accumulator
+	* \param maxPeaks Maximum number of peaks to return
+	* \param radius Suppression radius in bins
+	* \param minVotes Minimum votes of a peak
+	* \param wrapTheta Continue theta periodically (full Hough space, not for windows)
+	* \return Number of peaks found
+	*/
+	int houghPeaks(const Mat& accumulator, std::vector<HoughPeak>& peaks, int maxPeaks, int radius, int minVotes, bool wrapTheta) {
+		peaks.clear();
+		if ((accumulator.type() != CV_16U) || (maxPeaks <= 0))
+			return 0;
+
+		for (int v = 0; v < accumulator.rows; v++) {
+			const ushort* row = accumulator.ptr<ushort>(v);
+
+			for (int u = 0; u < accumulator.cols; u++) {
+				int votes = row[u];
+				if ((votes < minVotes) || (votes == 0))
+					continue;
+
+				// Non-maximum suppression (ties: earlier bin wins)
+				bool isPeak = true;
+				for (int dv = -radius; (dv <= radius) && isPeak; dv++) {
+					for (int du = -radius; du <= radius; du++) {
+						if ((du == 0) && (dv == 0))
+							continue;
+						int n = houghBin(accumulator, u + du, v + dv, wrapTheta);
+						bool before = (dv < 0) || ((dv == 0) && (du < 0));
+						if ((n > votes) || (before && (n == votes))) {
+							isPeak = false;
+							break;
+						}
+					}
+				}
+				if (!isPeak)
+					continue;
+
+				// Sub-bin refinement
+				HoughPeak peak;
+				peak.votes = votes;
+				peak.u = u + parabolaOffset(houghBin(accumulator, u - 1, v, wrapTheta), votes, houghBin(accumulator, u + 1, v, wrapTheta));
+				peak.v = v + parabolaOffset(houghBin(accumulator, u, v - 1, wrapTheta), votes, houghBin(accumulator, u, v + 1, wrapTheta));
+				peaks.push_back(peak);
+			}
+		}
+
+		// Keep strongest peaks
+		std::stable_sort(peaks.begin(), peaks.end(), [](const HoughPeak& a, const HoughPeak& b) { return a.votes > b.votes; });
+		if ((int)peaks.size() > maxPeaks)
+			peaks.resize(maxPeaks);
+
+		return (int)peaks.size();
+	}
+
+	/*! Accumulate Hough votes for lines (reference implementation).
+	*
+	* \param edgeImage Source edge image (with edge pixels marked by value 255)
+	* \param accumulator Destination CV_16U accumulator (votes)
+	* \param height Target height of destination image (r axis)
+	* \param width Target width of destination image (theta axis, covering [0, pi])
+	*/
+	void houghAccumulateReference(const Mat& edgeImage, Mat& accumulator, int height, int width) {
 		// Check image type
 		if (edgeImage.type() != CV_8U)
 			return;
@@ -85,7 +734,7 @@ namespace ip {
 		int v0 = height / 2;			// Draw r = 0 at vertical center
 
 		// Initialize accumulator image
-		houghSpace = Mat::zeros(Size(width, height), CV_16U);
+		accumulator = Mat::zeros(Size(width, height), CV_16U);
 
 		// Pre-calc LUTs for speedup
 		double* cosLUT = new double[width];		// Throws exception on failure
@@ -113,22 +762,39 @@ namespace ip {
 						// Radius (vertical position in Hough image)
 						double r = xc * cosLUT[u] + yc * sinLUT[u];
 						int v = v0 + (int)(r / deltaRadius + 0.5);
+						v = std::min(std::max(v, 0), height - 1);	// Even heights, see houghAccumulate()
 
 						// Increment accumulator
-						houghSpace.at<ushort>(v, u)++;
+						accumulator.at<ushort>(v, u)++;
 					}
 				}
 			}
 		}
 
+		// Free LUT memory
+		delete[] cosLUT;
+		delete[] sinLUT;
+	}
+
+	/*! Calculate Hough transform for lines.
+	*
+	* \param edgeImage Source edge image (with edge pixels marked by value 255)
+	* \param houghImage Destination image to hold Hough transform of edge pixels
+	* \param height Target height of destination image (r axis)
+	* \param width Target width of destination image (theta axis, covering [0, pi])
+	*/
+	void houghTransform(const Mat& edgeImage, Mat& houghSpace, int height, int width) {
+		// Check image type
+		if (edgeImage.type() != CV_8U)
+			return;
+
+		// Accumulate votes
+		houghAccumulate(edgeImage, houghSpace, height, width);
+
 		// Convert to maximized 8-bit grayscale
 		double maxValue;
 		minMaxLoc(houghSpace, NULL, &maxValue);
 		houghSpace.convertTo(houghSpace, CV_8U, 255.0 / maxValue);
-
-		// Free LUT memory
-		delete[] cosLUT;
-		delete[] sinLUT;
 	}
 
 	/*! Calculate parameters of line corresponding to a specific point in the Hough space.
@@ -149,6 +815,24 @@ namespace ip {
 		r = ((double)y - yr0) * deltaRadius;
 	}
 
+	/*! Convert a sub-bin position in Hough space to a line (e.g. a peak from houghPeaks()).
+	*
+	* \param imgSize Size of the edge image
+	* \param houghSize Size of the full Hough space
+	* \param x Column (theta) in bins, may be outside [0, width) for windows
+	* \param y Row (r) in bins
+	* \param r [out] Shortest distance (radius) from the image center to the line
+	* \param theta [out] Angle of shortest distance from image center to the line
+	*/
+	void houghSpaceToLine(Size imgSize, Size houghSize, double x, double y, double& r, double& theta) {
+		double deltaTheta = M_PI / (double)houghSize.width;
+		double deltaRadius = sqrt(imgSize.width * imgSize.width + imgSize.height * imgSize.height) / houghSize.height;
+		int yr0 = houghSize.height / 2;			// Draw r = 0 at vertical center
+
+		theta = x * deltaTheta;
+		r = (y - yr0) * deltaRadius;
+	}
+
 	/*! Draw line on an image.
 	*
 	* The line is specified by the shortest distance (radius and angle) from the image center to the line.
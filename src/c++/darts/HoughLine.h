@@ -56,14 +56,36 @@
 
  /* Include files */
 #include <opencv2/opencv.hpp>
+#include <vector>
+#include "EdgeList.h"
 
 
 namespace ip
 {
+	/* Peak of a Hough accumulator (sub-bin position) */
+	struct HoughPeak {
+		double u;		// Column (theta) in bins
+		double v;		// Row (r) in bins
+		int votes;
+	};
 
 	/* Prototypes */
 	void houghTransform(const cv::Mat& edgeImage, cv::Mat& houghSpace, int height = 361, int width = 360);
+	void houghAccumulate(const cv::Mat& edgeImage, cv::Mat& accumulator, int height = 361, int width = 360);
+	void houghAccumulate(const EdgeList& edges, cv::Mat& accumulator, int height = 361, int width = 360);
+	void houghAccumulateReference(const cv::Mat& edgeImage, cv::Mat& accumulator, int height = 361, int width = 360);
+	void houghAccumulateOriented(const cv::Mat& edgeImage, const cv::Mat& direction, cv::Mat& accumulator, int window, int height = 361, int width = 360);
+	void houghAccumulateOriented(const EdgeList& edges, cv::Mat& accumulator, int window, int height = 361, int width = 360);
+	void houghTransformOriented(const cv::Mat& edgeImage, const cv::Mat& direction, cv::Mat& houghSpace, int window, int height = 361, int width = 360);
+	void houghAccumulateWindow(const cv::Mat& edgeImage, cv::Mat& accumulator, cv::Rect& window, double r0, double theta0, double rTolerance, double thetaTolerance, const cv::Mat& direction = cv::Mat(), int height = 361, int width = 360);
+	void houghAccumulateWindow(const EdgeList& edges, cv::Mat& accumulator, cv::Rect& window, double r0, double theta0, double rTolerance, double thetaTolerance, int height = 361, int width = 360);
+	void houghAccumulatePyramid(const cv::Mat& edgeImage, cv::Mat& accumulator, cv::Rect& window, double rTolerance, double thetaTolerance, const cv::Mat& direction = cv::Mat(), int levels = 2, int height = 361, int width = 360);
+	void houghAccumulatePyramid(const EdgeList& edges, cv::Mat& accumulator, cv::Rect& window, double rTolerance, double thetaTolerance, int levels = 2, int height = 361, int width = 360);
+	int houghAccumulatePyramid(const EdgeList& edges, std::vector<cv::Mat>& accumulators, std::vector<cv::Rect>& windows, double rTolerance, double thetaTolerance, int maxWindows, int peakRadius = 1, int levels = 2, int height = 361, int width = 360);
+	void normalizeLine(double& r, double& theta);
+	int houghPeaks(const cv::Mat& accumulator, std::vector<HoughPeak>& peaks, int maxPeaks, int radius = 3, int minVotes = 1, bool wrapTheta = false);
 	void houghSpaceToLine(cv::Size imgSize, cv::Size houghSize, int x, int y, double& r, double& theta);
+	void houghSpaceToLine(cv::Size imgSize, cv::Size houghSize, double x, double y, double& r, double& theta);
 	void drawLine(cv::Mat& image, double r, double theta);
 	
 	void drawLine_light_add(cv::Mat& image, double r, double theta);
@@ -0,0 +1,92 @@
+/******************************************************************************
+ *
+ * Parallel.cpp
+ *
+ *
+ * Automated Dart Detection and Scoring System
+ *
+ *
+ * This project was developed as part of the Digital Image / Video Processing
+ * module at HAW Hamburg under Prof. Dr. Marc Hensel
+ *
+ *
+ *
+ * Author(s):   	Mika Paul Salewski <mika.paul.salewski@gmail.com>
+ *
+ * Created on :     2025-01-06
+ * Last revision :  None
+ *
+ *
+ *
+ * Copyright (c) 2025, Mika Paul Salewski
+ * Version: 2025.01.06
+ * License: CC BY-NC-SA 4.0,
+ *      see https://creativecommons.org/licenses/by-nc-sa/4.0/deed.en
+ *
+ *
+ * Further information about this source-file:
+ *      --> stripe parallel execution of the hand-written image kernels
+******************************************************************************/
+
+
+ /* Include files */
+#include "Parallel.h"
+#include <algorithm>
+#include <atomic>
+#include <opencv2/opencv.hpp>
+
+/* Namespaces */
+using namespace cv;
+
+/* Default minimum image rows per stripe */
+#define PARALLEL_GRAIN_DEFAULT 16
+
+namespace ip {
+	static std::atomic<int> parallelThreads(0);
+	static std::atomic<int> parallelGrain(PARALLEL_GRAIN_DEFAULT);
+
+	/*! Set the maximum number of stripes (threads) of the image kernels.
+	*
+	* \param threads Maximum number of threads, 0 for the thread count of OpenCV
+	*/
+	void setParallelThreads(int threads) {
+		parallelThreads = std::max(0, threads);
+	}
+
+	/*! Get the maximum number of stripes (threads) of the image kernels.
+	*
+	* \return Maximum number of threads
+	*/
+	int getParallelThreads(void) {
+		int threads = parallelThreads;
+		return (threads > 0) ? threads : std::max(1, getNumThreads());
+	}
+
+	/*! Set the default grain of the row kernels.
+	*
+	* \param grain Minimum image rows per stripe
+	*/
+	void setParallelGrain(int grain) {
+		parallelGrain = std::max(1, grain);
+	}
+
+	/*! Get the default grain of the row kernels.
+	*
+	* \return Minimum image rows per stripe
+	*/
+	int getParallelGrain(void) {
+		return parallelGrain;
+	}
+
+	/*! Number of stripes for a kernel.
+	*
+	* \param count Number of items (e.g. image rows)
+	* \param grain Minimum items per stripe, 0 for the default grain (rows)
+	* \return Number of stripes in [1, threads]
+	*/
+	int parallelStripes(int count, int grain) {
+		if (grain <= 0)
+			grain = parallelGrain;
+		return std::max(1, std::min(getParallelThreads(), count / grain));
+	}
+}
@@ -0,0 +1,113 @@
+/******************************************************************************
+ *
+ * Parallel.h
+ *
+ *
+ * Automated Dart Detection and Scoring System
+ *
+ *
+ * This project was developed as part of the Digital Image / Video Processing
+ * module at HAW Hamburg under Prof. Dr. Marc Hensel
+ *
+ *
+ *
+ * Author(s):   	Mika Paul Salewski <mika.paul.salewski@gmail.com>
+ *
+ * Created on :     2025-01-06
+ * Last revision :  None
+ *
+ *
+ *
+ * Copyright (c) 2025, Mika Paul Salewski
+ * Version: 2025.01.06
+ * License: CC BY-NC-SA 4.0,
+ *      see https://creativecommons.org/licenses/by-nc-sa/4.0/deed.en
+ *
+ *
+ * Further information about this source-file:
+ *      --> stripe parallel execution of the hand-written image kernels on
+ *          top of cv::parallel_for_ (rows of an image or items of a list)
+******************************************************************************/
+
+
+#ifndef IP_PARALLEL_H
+#define IP_PARALLEL_H
+
+ /* Include files */
+#include <opencv2/opencv.hpp>
+#include <cstdint>
+#include <vector>
+
+namespace ip
+{
+	/* Prototypes */
+	void setParallelThreads(int threads);
+	int getParallelThreads(void);
+	void setParallelGrain(int grain);
+	int getParallelGrain(void);
+	int parallelStripes(int count, int grain = 0);
+
+	/*! Run body(begin, end, stripe) on a fixed number of stripes of [0, count) in parallel.
+	*
+	* \param count Number of items (e.g. image rows)
+	* \param stripes Number of stripes, see parallelStripes()
+	* \param body Function body(begin, end, stripe) for the items [begin, end)
+	*/
+	template <typename Body>
+	void parallelForStripes(int count, int stripes, Body body) {
+		if (stripes <= 1) {
+			body(0, count, 0);
+			return;
+		}
+
+		cv::parallel_for_(cv::Range(0, stripes), [&](const cv::Range& range) {
+			for (int s = range.start; s < range.end; s++) {
+				int begin = (int)(((int64_t)s * count) / stripes);
+				int end = (int)(((int64_t)(s + 1) * count) / stripes);
+				body(begin, end, s);
+			}
+		}, stripes);
+	}
+
+	/*! Run body(begin, end, stripe) on stripes of [0, count) in parallel.
+	*
+	* \param count Number of items (e.g. image rows)
+	* \param grain Minimum items per stripe, 0 for the default grain (rows), see setParallelGrain()
+	* \param body Function body(begin, end, stripe) for the items [begin, end)
+	*/
+	template <typename Body>
+	void parallelFor(int count, int grain, Body body) {
+		parallelForStripes(count, parallelStripes(count, grain), body);
+	}
+
+	/*! Gather items from stripes of [0, count) in parallel, the order is the one of a serial loop.
+	*
+	* \param count Number of items (e.g. image rows)
+	* \param grain Minimum items per stripe, 0 for the default grain (rows)
+	* \param out [out] Gathered items
+	* \param gather Function gather(begin, end, local) appending the items of [begin, end) to local
+	*/
+	template <typename T, typename Gather>
+	void parallelGather(int count, int grain, std::vector<T>& out, Gather gather) {
+		int stripes = parallelStripes(count, grain);
+		out.clear();
+		if (stripes <= 1) {
+			gather(0, count, out);
+			return;
+		}
+
+		std::vector<std::vector<T>> parts(stripes);
+		parallelForStripes(count, stripes, [&](int begin, int end, int s) {
+			gather(begin, end, parts[s]);
+		});
+
+		size_t total = 0;
+		for (const auto& part : parts)
+			total += part.size();
+		out.reserve(total);
+		for (const auto& part : parts)
+			out.insert(out.end(), part.begin(), part.end());
+	}
+}
+
+#endif /* IP_PARALLEL_H */
@@ -53,18 +53,408 @@
 
  /* Include files */
 #include "Sobel.h"
+#include "Parallel.h"
+#include <cmath>
+#include <cstdlib>
+#include <algorithm>
+#include <vector>
 #include <opencv2/opencv.hpp>
+#include <opencv2/core/hal/intrin.hpp>
 
 /* Namespaces */
 using namespace cv;
 
 namespace ip {
+	/*! Integer Sobel gradients (raw 3x3 Sobel, i.e. 8 times the gradient of the normalized kernels).
+	*
+	* \param image Source image (CV_8U)
+	* \param gradX [out] Gradient in x (CV_16S)
+	* \param gradY [out] Gradient in y (CV_16S)
+	*/
+	static void sobelGradients(const Mat& image, Mat& gradX, Mat& gradY) {
+		Sobel(image, gradX, CV_16S, 1, 0, 3);
+		Sobel(image, gradY, CV_16S, 0, 1, 3);
+	}
+
+	/*! Magnitude of one pixel, see sobelMagnitudeRows().
+	*
+	* \param gx Raw Sobel gradient in x
+	* \param gy Raw Sobel gradient in y
+	* \param magnitude Magnitude approximation
+	* \return Magnitude in [0, 255]
+	*/
+	static inline int sobelMagnitudePixel(int gx, int gy, SobelMagnitude magnitude) {
+		int ax = std::abs(gx);
+		int ay = std::abs(gy);
+
+		switch (magnitude) {
+		case SOBEL_MAGNITUDE_L1:
+			return std::min((ax + ay) >> 3, 255);
+		case SOBEL_MAGNITUDE_ALPHA_MAX_BETA_MIN:
+			return (30 * std::max(ax, ay) + 15 * std::min(ax, ay)) >> 8;		// (15/16 max + 15/32 min) / 8
+		default:
+			return (int)(std::sqrt((float)(gx * gx + gy * gy)) * 0.125f);		// Truncation like (uchar)
+		}
+	}
+
+	/*! Magnitude (or binary edge image) of one row from raw Sobel gradients.
+	*
+	* The magnitude is scaled to the one of the normalized kernels (raw / 8). The
+	* exact magnitude is evaluated in single precision, which gives the same
+	* truncated 8 bit values as double precision for all raw gradients of 8 bit
+	* images. L1 and alpha-max-beta-min need no square root (max. error +41 %
+	* and -6 % / +5 %).
+	*
+	* \param rowX Raw gradient in x
+	* \param rowY Raw gradient in y
+	* \param rowDst [out] Magnitude or binary edge row
+	* \param cols Number of pixels
+	* \param magnitude Magnitude approximation
+	* \param thresh Edge pixels have a magnitude > thresh (binary output with value 255), < 0 for magnitude output
+	* \return Number of edge pixels (0 for magnitude output)
+	*/
+	static int sobelMagnitudeRow(const short* rowX, const short* rowY, uchar* rowDst, int cols, SobelMagnitude magnitude, int thresh) {
+		bool binary = (thresh >= 0);
+		int count = 0;
+		int x = 0;
+
+#if CV_SIMD128
+		// 16 pixels per iteration
+		const v_uint8x16 vThresh = v_setall_u8((uchar)std::min(thresh, 255));
+		const v_uint8x16 vOne = v_setall_u8(1);
+		const v_float32x4 vScale = v_setall_f32(0.125f);
+		v_uint16x8 vCount = v_setzero_u16();
+		for (; x <= cols - 16; x += 16) {
+			v_int16x8 gx0 = v_load(rowX + x), gx1 = v_load(rowX + x + 8);
+			v_int16x8 gy0 = v_load(rowY + x), gy1 = v_load(rowY + x + 8);
+			v_uint16x8 m0, m1;
+
+			if (magnitude == SOBEL_MAGNITUDE_EXACT) {
+				v_int16x8 gx[2] = { gx0, gx1 }, gy[2] = { gy0, gy1 };
+				v_int16x8 m[2];
+				for (int k = 0; k < 2; k++) {
+					v_int32x4 x0, x1, y0, y1;
+					v_expand(gx[k], x0, x1);
+					v_expand(gy[k], y0, y1);
+					v_int32x4 s0 = x0 * x0 + y0 * y0;
+					v_int32x4 s1 = x1 * x1 + y1 * y1;
+					v_int32x4 r0 = v_trunc(v_sqrt(v_cvt_f32(s0)) * vScale);
+					v_int32x4 r1 = v_trunc(v_sqrt(v_cvt_f32(s1)) * vScale);
+					m[k] = v_pack(r0, r1);
+				}
+				m0 = v_reinterpret_as_u16(m[0]);
+				m1 = v_reinterpret_as_u16(m[1]);
+			}
+			else {
+				v_uint16x8 ax0 = v_abs(gx0), ax1 = v_abs(gx1);
+				v_uint16x8 ay0 = v_abs(gy0), ay1 = v_abs(gy1);
+				if (magnitude == SOBEL_MAGNITUDE_L1) {
+					m0 = (ax0 + ay0) >> 3;
+					m1 = (ax1 + ay1) >> 3;
+				}
+				else {
+					v_uint16x8 max0 = v_max(ax0, ay0), min0 = v_min(ax0, ay0);
+					v_uint16x8 max1 = v_max(ax1, ay1), min1 = v_min(ax1, ay1);
+					m0 = (((max0 << 5) - (max0 << 1)) + ((min0 << 4) - min0)) >> 8;
+					m1 = (((max1 << 5) - (max1 << 1)) + ((min1 << 4) - min1)) >> 8;
+				}
+			}
+
+			v_uint8x16 m8 = v_pack(m0, m1);		// Saturating
+			if (binary) {
+				v_uint8x16 edge = m8 > vThresh;
+				v_store(rowDst + x, edge);
+				v_uint16x8 c0, c1;
+				v_expand(edge & vOne, c0, c1);
+				vCount += c0 + c1;
+			}
+			else {
+				v_store(rowDst + x, m8);
+			}
+		}
+		if (binary) {
+			v_uint32x4 c0, c1;
+			v_expand(vCount, c0, c1);
+			count += (int)v_reduce_sum(c0 + c1);
+		}
+#endif
+
+		// Remaining pixels
+		for (; x < cols; x++) {
+			int m = sobelMagnitudePixel(rowX[x], rowY[x], magnitude);
+			if (binary) {
+				bool edge = (m > thresh);
+				rowDst[x] = edge ? 255 : 0;
+				count += edge ? 1 : 0;
+			}
+			else {
+				rowDst[x] = (uchar)m;
+			}
+		}
+
+		return count;
+	}
+
+	/*! Magnitude (or binary edge image) from raw Sobel gradients, see sobelMagnitudeRow().
+	*
+	* \param gradX Raw gradient in x (CV_16S)
+	* \param gradY Raw gradient in y (CV_16S)
+	* \param dst [out] Magnitude or binary edge image (CV_8U)
+	* \param magnitude Magnitude approximation
+	* \param thresh Edge pixels have a magnitude > thresh (binary output with value 255), < 0 for magnitude output
+	* \return Number of edge pixels (0 for magnitude output)
+	*/
+	static int sobelMagnitudeRows(const Mat& gradX, const Mat& gradY, Mat& dst, SobelMagnitude magnitude, int thresh) {
+		dst.create(gradX.size(), CV_8U);
+		int stripes = parallelStripes(gradX.rows);
+		std::vector<int> stripeCounts(stripes, 0);
+
+		// Row stripes in parallel
+		parallelForStripes(gradX.rows, stripes, [&](int begin, int end, int s) {
+			for (int y = begin; y < end; y++)
+				stripeCounts[s] += sobelMagnitudeRow(gradX.ptr<short>(y), gradY.ptr<short>(y), dst.ptr<uchar>(y), gradX.cols, magnitude, thresh);
+		});
+
+		int count = 0;
+		for (int c : stripeCounts)
+			count += c;
+
+		return count;
+	}
+
+	/*! Sharpen one row, kernel (0, -1, 0; -1, center, -1; 0, -1, 0) with saturation like filter2D().
+	*
+	* \param image Source image (CV_8U)
+	* \param y Row (inside the image)
+	* \param center Center weight of the sharpening kernel
+	* \param out [out] Sharpened row with one reflected pixel on both sides (cols + 2)
+	*/
+	static void sharpenRow(const Mat& image, int y, int center, uchar* out) {
+		int cols = image.cols;
+		const uchar* up = image.ptr<uchar>(borderInterpolate(y - 1, image.rows, BORDER_REFLECT_101));
+		const uchar* row = image.ptr<uchar>(y);
+		const uchar* down = image.ptr<uchar>(borderInterpolate(y + 1, image.rows, BORDER_REFLECT_101));
+
+		// Border pixels
+		for (int x = 0; x < cols; x += std::max(1, cols - 1)) {
+			int left = row[borderInterpolate(x - 1, cols, BORDER_REFLECT_101)];
+			int right = row[borderInterpolate(x + 1, cols, BORDER_REFLECT_101)];
+			out[x + 1] = saturate_cast<uchar>(center * row[x] - up[x] - down[x] - left - right);
+		}
+
+		// Inner pixels (vectorizable)
+		for (int x = 1; x < cols - 1; x++)
+			out[x + 1] = saturate_cast<uchar>(center * row[x] - up[x] - down[x] - row[x - 1] - row[x + 1]);
+
+		// Reflected border of the sharpened image
+		out[0] = out[1 + borderInterpolate(-1, cols, BORDER_REFLECT_101)];
+		out[cols + 1] = out[1 + borderInterpolate(cols, cols, BORDER_REFLECT_101)];
+	}
+
+	/*! Gradient direction of one row, see sobelFilter(const Mat&, Mat&, Mat&).
+	*
+	* \param rowX Raw gradient in x
+	* \param rowY Raw gradient in y
+	* \param rowDir [out] Gradient direction in [0, pi)
+	* \param cols Number of pixels
+	*/
+	static void sobelDirectionRow(const short* rowX, const short* rowY, float* rowDir, int cols) {
+		for (int x = 0; x < cols; x++) {
+			// Normal has no sign, fold [0, 360) deg to [0, 180) deg
+			float angle = fastAtan2((float)rowY[x], (float)rowX[x]);
+			if (angle >= 180.0f)
+				angle -= 180.0f;
+			rowDir[x] = angle * (float)(CV_PI / 180.0);
+		}
+	}
+
+	/*! Sharpening and Sobel in one pass.
+	*
+	* Every stripe keeps the last three sharpened rows in a ring buffer, the
+	* sharpened image is never written. The sharpened values are saturated
+	* to 8 bit like in filter2D(), so the result is the same as sharpening
+	* followed by sobelFilter() (borders reflected in both steps).
+	*
+	* \param image Source image (CV_8U)
+	* \param center Center weight of the sharpening kernel
+	* \param dst [out] Magnitude or binary edge image (CV_8U)
+	* \param direction [out] Optional gradient direction (CV_32F), NULL if not needed
+	* \param magnitude Magnitude approximation
+	* \param thresh Edge pixels have a magnitude > thresh (binary output with value 255), < 0 for magnitude output
+	* \return Number of edge pixels (0 for magnitude output)
+	*/
+	static int sharpenSobelRows(const Mat& image, int center, Mat& dst, Mat* direction, SobelMagnitude magnitude, int thresh) {
+		int rows = image.rows;
+		int cols = image.cols;
+
+		// Output must not overwrite rows which are still needed
+		Mat src = (dst.data == image.data) ? image.clone() : image;
+		dst.create(src.size(), CV_8U);
+		if (direction != NULL)
+			direction->create(src.size(), CV_32F);
+
+		int stripes = parallelStripes(rows);
+		std::vector<int> stripeCounts(stripes, 0);
+
+		parallelForStripes(rows, stripes, [&](int begin, int end, int s) {
+			std::vector<uchar> ring(3 * (cols + 2));
+			std::vector<short> gradX(cols), gradY(cols);
+			int next = begin - 1;		// Next sharpened row (-1 and rows are reflected)
+
+			for (int y = begin; y < end; y++) {
+				// Sharpened rows y - 1, y, y + 1
+				for (; next <= y + 1; next++)
+					sharpenRow(src, borderInterpolate(next, rows, BORDER_REFLECT_101), center, &ring[((next + 1) % 3) * (cols + 2)]);
+				const uchar* a = &ring[(y % 3) * (cols + 2)];
+				const uchar* b = &ring[((y + 1) % 3) * (cols + 2)];
+				const uchar* c = &ring[((y + 2) % 3) * (cols + 2)];
+
+				// Raw Sobel gradients (vectorizable), pixel x is at index x + 1
+				for (int x = 0; x < cols; x++) {
+					gradX[x] = (short)((a[x + 2] - a[x]) + 2 * (b[x + 2] - b[x]) + (c[x + 2] - c[x]));
+					gradY[x] = (short)((c[x] + 2 * c[x + 1] + c[x + 2]) - (a[x] + 2 * a[x + 1] + a[x + 2]));
+				}
+
+				stripeCounts[s] += sobelMagnitudeRow(gradX.data(), gradY.data(), dst.ptr<uchar>(y), cols, magnitude, thresh);
+				if (direction != NULL)
+					sobelDirectionRow(gradX.data(), gradY.data(), direction->ptr<float>(y), cols);
+			}
+		});
+
+		int count = 0;
+		for (int c : stripeCounts)
+			count += c;
+
+		return count;
+	}
+
 	/*! Calculate Sobel edge image(s).
 	*
 	* \param image Source image to calculate Sobel edge images for
 	* \param sobel Absolute Sobel image sqrt(Sobel(x)^2 + Sobel(y)^2) in [0, sqrt(2) * 127]
 	*/
 	void sobelFilter(const Mat& image, Mat& sobel) {
+		sobelFilter(image, sobel, SOBEL_MAGNITUDE_EXACT);
+	}
+
+	/*! Calculate Sobel edge image with a selectable magnitude (integer, SIMD).
+	*
+	* SOBEL_MAGNITUDE_EXACT gives the same image as sobelFilterReference().
+	*
+	* \param image Source image (CV_8U) to calculate Sobel edge images for
+	* \param sobel Absolute Sobel image in [0, sqrt(2) * 127] (exact), see SobelMagnitude
+	* \param magnitude Magnitude approximation
+	*/
+	void sobelFilter(const Mat& image, Mat& sobel, SobelMagnitude magnitude) {
+		// Check image type
+		if (image.type() != CV_8U)
+			return;
+
+		Mat gradX, gradY;
+		sobelGradients(image, gradX, gradY);
+		sobelMagnitudeRows(gradX, gradY, sobel, magnitude, -1);
+	}
+
+	/*! Calculate binary Sobel edge image, thresholding fused into the magnitude kernel.
+	*
+	* Same as threshold(sobel, edgeBin, thresh, 255, THRESH_BINARY) on the output
+	* of sobelFilter(), without writing the magnitude image.
+	*
+	* \param image Source image (CV_8U) to calculate Sobel edge images for
+	* \param edgeBin Binary edge image (edge pixels 255)
+	* \param thresh Edge pixels have a magnitude > thresh
+	* \param magnitude Magnitude approximation
+	* \return Number of edge pixels
+	*/
+	int sobelThreshold(const Mat& image, Mat& edgeBin, int thresh, SobelMagnitude magnitude) {
+		// Check image type
+		if (image.type() != CV_8U)
+			return 0;
+
+		Mat gradX, gradY;
+		sobelGradients(image, gradX, gradY);
+		return sobelMagnitudeRows(gradX, gradY, edgeBin, magnitude, std::max(thresh, 0));
+	}
+
+	/*! Calculate Sobel edge image and gradient direction.
+	*
+	* \param image Source image to calculate Sobel edge images for
+	* \param sobel Absolute Sobel image sqrt(Sobel(x)^2 + Sobel(y)^2) in [0, sqrt(2) * 127]
+	* \param direction Gradient direction (CV_32F) in [0, pi), i.e. the angle of the edge normal
+	*                  in the theta convention of the Hough transform
+	*/
+	void sobelFilter(const Mat& image, Mat& sobel, Mat& direction) {
+		// Check image type
+		if (image.type() != CV_8U)
+			return;
+
+		Mat gradX, gradY;
+		sobelGradients(image, gradX, gradY);
+		sobelMagnitudeRows(gradX, gradY, sobel, SOBEL_MAGNITUDE_EXACT, -1);
+
+		// Gradient direction
+		direction.create(image.size(), CV_32F);
+		parallelFor(image.rows, 0, [&](int begin, int end, int) {
+			for (int y = begin; y < end; y++)
+				sobelDirectionRow(gradX.ptr<short>(y), gradY.ptr<short>(y), direction.ptr<float>(y), image.cols);
+		});
+	}
+
+	/*! Sharpen and calculate Sobel edge image in one pass (same as sharpening, then sobelFilter()).
+	*
+	* \param image Source image (CV_8U)
+	* \param sobel Absolute Sobel image of the sharpened image, see sobelFilter()
+	* \param sharpenCenter Center weight of the sharpening kernel (0, -1, 0; -1, center, -1; 0, -1, 0)
+	* \param magnitude Magnitude approximation
+	*/
+	void sharpenSobelFilter(const Mat& image, Mat& sobel, int sharpenCenter, SobelMagnitude magnitude) {
+		// Check image type
+		if (image.type() != CV_8U)
+			return;
+
+		sharpenSobelRows(image, sharpenCenter, sobel, NULL, magnitude, -1);
+	}
+
+	/*! Sharpen and calculate Sobel edge image and gradient direction in one pass.
+	*
+	* \param image Source image (CV_8U)
+	* \param sobel Absolute Sobel image of the sharpened image, see sobelFilter()
+	* \param direction Gradient direction (CV_32F) in [0, pi), see sobelFilter()
+	* \param sharpenCenter Center weight of the sharpening kernel (0, -1, 0; -1, center, -1; 0, -1, 0)
+	*/
+	void sharpenSobelFilter(const Mat& image, Mat& sobel, Mat& direction, int sharpenCenter) {
+		// Check image type
+		if (image.type() != CV_8U)
+			return;
+
+		sharpenSobelRows(image, sharpenCenter, sobel, &direction, SOBEL_MAGNITUDE_EXACT, -1);
+	}
+
+	/*! Sharpen, calculate Sobel and threshold in one pass (same as sharpening, then sobelThreshold()).
+	*
+	* \param image Source image (CV_8U)
+	* \param edgeBin Binary edge image (edge pixels 255)
+	* \param thresh Edge pixels have a magnitude > thresh
+	* \param sharpenCenter Center weight of the sharpening kernel (0, -1, 0; -1, center, -1; 0, -1, 0)
+	* \param magnitude Magnitude approximation
+	* \return Number of edge pixels
+	*/
+	int sharpenSobelThreshold(const Mat& image, Mat& edgeBin, int thresh, int sharpenCenter, SobelMagnitude magnitude) {
+		// Check image type
+		if (image.type() != CV_8U)
+			return 0;
+
+		return sharpenSobelRows(image, sharpenCenter, edgeBin, NULL, magnitude, std::max(thresh, 0));
+	}
+
+	/*! Calculate Sobel edge image (reference implementation).
+	*
+	* Floating point kernels and a scalar magnitude loop, kept to verify sobelFilter().
+	*
+	* \param image Source image to calculate Sobel edge images for
+	* \param sobel Absolute Sobel image sqrt(Sobel(x)^2 + Sobel(y)^2) in [0, sqrt(2) * 127]
+	*/
+	void sobelFilterReference(const Mat& image, Mat& sobel) {
 		// Filter kernels
 		Mat kernelGradient = (Mat_<double>(1, 3) << -1, 0, 1) / 2.0;
 		Mat kernelBinomial = (Mat_<double>(1, 3) << 1, 2, 1) / 4.0;
@@ -59,7 +59,21 @@
 
 namespace ip
 {
+	/* Magnitude of the gradient */
+	enum SobelMagnitude {
+		SOBEL_MAGNITUDE_EXACT = 0,				// sqrt(gx^2 + gy^2)
+		SOBEL_MAGNITUDE_L1,						// |gx| + |gy|
+		SOBEL_MAGNITUDE_ALPHA_MAX_BETA_MIN		// 15/16 max(|gx|, |gy|) + 15/32 min(|gx|, |gy|)
+	};
+
 	void sobelFilter(const cv::Mat& image, cv::Mat& sobel);
+	void sobelFilter(const cv::Mat& image, cv::Mat& sobel, SobelMagnitude magnitude);
+	void sobelFilter(const cv::Mat& image, cv::Mat& sobel, cv::Mat& direction);
+	int sobelThreshold(const cv::Mat& image, cv::Mat& edgeBin, int thresh, SobelMagnitude magnitude = SOBEL_MAGNITUDE_EXACT);
+	void sharpenSobelFilter(const cv::Mat& image, cv::Mat& sobel, int sharpenCenter, SobelMagnitude magnitude = SOBEL_MAGNITUDE_EXACT);
+	void sharpenSobelFilter(const cv::Mat& image, cv::Mat& sobel, cv::Mat& direction, int sharpenCenter);
+	int sharpenSobelThreshold(const cv::Mat& image, cv::Mat& edgeBin, int thresh, int sharpenCenter, SobelMagnitude magnitude = SOBEL_MAGNITUDE_EXACT);
+	void sobelFilterReference(const cv::Mat& image, cv::Mat& sobel);
 }
 
 #endif /* IP_SOBEL_H */
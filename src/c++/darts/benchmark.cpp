@@ -0,0 +1,1112 @@
+/******************************************************************************
+ *
+ * benchmark.cpp
+ *
+ *
+ * Automated Dart Detection and Scoring System
+ *
+ *
+ * This project was developed as part of the Digital Image / Video Processing
+ * module at HAW Hamburg under Prof. Dr. Marc Hensel
+ *
+ *
+ *
+ * Author(s):   	Mika Paul Salewski <mika.paul.salewski@gmail.com>
+ *
+ * Created on :     2025-01-06
+ * Last revision :  None
+ *
+ *
+ *
+ * Copyright (c) 2025, Mika Paul Salewski
+ * Version: 2025.01.06
+ * License: CC BY-NC-SA 4.0,
+ *      see https://creativecommons.org/licenses/by-nc-sa/4.0/deed.en
+ *
+ *
+ * Further information about this source-file:
+ *      --> self-check and timing of the image processing kernels on the
+ *          static test images; every optimized kernel is compared against
+ *          its reference implementation and the run time of both is printed
+******************************************************************************/
+
+
+
+/* compiler settings */
+#define _CRT_SECURE_NO_WARNINGS     // enable getenv()
+/***************************** includes **************************************/
+#include <iostream>
+#include <cstdlib>
+#include <cmath>
+#include <string>
+#include <vector>
+#include <opencv2/opencv.hpp>
+#include "benchmark.h"
+#include "image_proc.h"
+#include "Sobel.h"
+#include "HoughLine.h"
+#include "EdgeList.h"
+#include "Parallel.h"
+#include "cams.h"
+#include "rig.h"
+#include "calibration.h"
+#include "dart_board.h"
+
+/****************************** namespaces ***********************************/
+using namespace cv;
+using namespace std;
+
+
+
+/*************************** local Defines ***********************************/
+#define BENCHMARK_RUNS 20           // repetitions per kernel and image
+#define BENCHMARK_LINE_TRUTH "images/test_img/line_truth.yml"     // optional ground truth lines of the test pairs
+#define BENCHMARK_NATIVE_SKEW 60    // perspective of the homography for uncalibrated cameras [pixel]
+#define BENCHMARK_NATIVE_R_TOL 3.0  // native line against the warped fit [pixel]
+#define BENCHMARK_NATIVE_THETA_TOL (1.0 * CV_PI / 180)
+#define BENCHMARK_CAL_RUNS 3        // repetitions of the auto calibration (hundreds of ms each)
+#define BENCHMARK_CAL_TOL 2.0       // frame center through the serial and the parallel homography [pixel]
+
+
+/************************** local Structure ***********************************/
+/* test image pairs (last, current) */
+struct benchmark_pair_s {
+    const char* last;
+    const char* cur;
+    int cam;
+};
+
+static const struct benchmark_pair_s benchmark_pairs[] = {
+    { TOP_RAW_IMG_CAL, TOP_1DARTS, TOP_CAM },
+    { TOP_1DARTS, TOP_2DARTS, TOP_CAM },
+    { TOP_2DARTS, TOP_3DARTS, TOP_CAM },
+    { RIGHT_RAW_IMG_CAL, RIGHT_1DARTS, RIGHT_CAM },
+    { RIGHT_1DARTS, RIGHT_2DARTS, RIGHT_CAM },
+    { RIGHT_2DARTS, RIGHT_3DARTS, RIGHT_CAM },
+    { LEFT_RAW_IMG_CAL, LEFT_1DARTS, LEFT_CAM },
+    { LEFT_1DARTS, LEFT_2DARTS, LEFT_CAM },
+    { LEFT_2DARTS, LEFT_3DARTS, LEFT_CAM },
+};
+
+/* calibration frames (board without darts) */
+struct benchmark_cal_s {
+    const char* img;
+    int cam;
+};
+
+static const struct benchmark_cal_s benchmark_cal_frames[] = {
+    { TOP_RAW_IMG_CAL, TOP_CAM },
+    { RIGHT_RAW_IMG_CAL, RIGHT_CAM },
+    { LEFT_RAW_IMG_CAL, LEFT_CAM },
+};
+
+
+/************************** Function Declaration *****************************/
+static void benchmark_edge_bin(const Mat& last, const Mat& cur, Mat& diff_gray, Mat& sharp, Mat& edge_bin, Mat& edge_dir);
+static void benchmark_line_error(double r, double theta, double r_ref, double theta_ref, double* dr, double* dtheta);
+
+
+/************************** Function Definitions *****************************/
+/***
+ *
+ * benchmark_run(void)
+ *
+ * Load the static test images and run the self-checks and timings of all
+ * image processing kernels
+ *
+ *
+ * @param:	None
+ *
+ *
+ * @return: void
+ *
+ *
+ * @note:   Enable with RUN_BENCHMARK in main.cpp. Build in Release mode,
+ *          Debug timings are meaningless.
+ *
+ *
+ * Example usage: None
+ *
+***/
+void benchmark_run(void) {
+
+    /* difference images, sobel inputs, binary edge images and gradient directions of all test pairs */
+    vector<Mat> diffs;
+    vector<Mat> sharps;
+    vector<Mat> edges;
+    vector<Mat> dirs;
+    vector<Mat> lasts;
+    vector<Mat> curs;
+    vector<int> cams;
+    for (const auto& pair : benchmark_pairs) {
+        Mat last = imread(pair.last, IMREAD_COLOR);
+        Mat cur = imread(pair.cur, IMREAD_COLOR);
+        if (last.empty() || cur.empty()) {
+            std::cout << "[ERROR] Could not load test images " << pair.last << ", " << pair.cur << endl;
+            continue;
+        }
+        Mat diff_gray, sharp, edge_bin, edge_dir;
+        benchmark_edge_bin(last, cur, diff_gray, sharp, edge_bin, edge_dir);
+        diffs.push_back(diff_gray);
+        sharps.push_back(sharp);
+        edges.push_back(edge_bin);
+        dirs.push_back(edge_dir);
+        lasts.push_back(last);
+        curs.push_back(cur);
+        cams.push_back(pair.cam);
+    }
+
+    if (edges.empty()) {
+        std::cout << "[ERROR] No test images" << endl;
+        return;
+    }
+
+    std::cout << "Benchmark on " << edges.size() << " test images, " << getNumThreads() << " threads" << endl;
+
+    int errors = 0;
+    errors += benchmark_sobel(sharps);
+    errors += benchmark_sharpen_sobel(diffs);
+    errors += benchmark_hough(edges, dirs);
+    errors += benchmark_edge_list(edges, dirs);
+    benchmark_parallel(sharps, edges, dirs);
+    benchmark_line_methods(lasts, curs, cams);
+    benchmark_ctf(lasts, curs, cams);
+    errors += benchmark_native(lasts, curs, cams);
+    errors += benchmark_auto_cal();
+
+    if (errors == 0) {
+        std::cout << "[OK] All self-checks passed" << endl;
+    }
+    else {
+        std::cout << "[ERROR] " << errors << " self-checks failed" << endl;
+    }
+}
+
+
+/***
+ *
+ * benchmark_hough(const std::vector<cv::Mat>& edges, const std::vector<cv::Mat>& dirs)
+ *
+ * Compare ip::houghAccumulate() against ip::houghAccumulateReference() and
+ * print the run times, ip::houghAccumulateOriented() is timed as well
+ *
+ *
+ * @param:	const std::vector<cv::Mat>& edges --> binary edge images
+ * @param:	const std::vector<cv::Mat>& dirs --> gradient directions of the edge images
+ *
+ *
+ * @return: int number of failed checks
+ *
+ *
+ * @note:   None
+ *
+ *
+ * Example usage: None
+ *
+***/
+int benchmark_hough(const std::vector<cv::Mat>& edges, const std::vector<cv::Mat>& dirs) {
+
+    int errors = 0;
+    double t_ref = 0;
+    double t_fast = 0;
+    double t_orient = 0;
+    double t_pyr = 0;
+    int pyr_match = 0;
+
+    for (size_t i = 0; i < edges.size(); i++) {
+        Mat acc_ref, acc_fast;
+
+        int64 t0 = getTickCount();
+        for (int n = 0; n < BENCHMARK_RUNS; n++) {
+            ip::houghAccumulateReference(edges[i], acc_ref);
+        }
+        int64 t1 = getTickCount();
+        for (int n = 0; n < BENCHMARK_RUNS; n++) {
+            ip::houghAccumulate(edges[i], acc_fast);
+        }
+        int64 t2 = getTickCount();
+        for (int n = 0; n < BENCHMARK_RUNS; n++) {
+            Mat acc_orient;
+            ip::houghAccumulateOriented(edges[i], dirs[i], acc_orient, 16);
+        }
+        int64 t3 = getTickCount();
+        Mat acc_pyr;
+        Rect win;
+        for (int n = 0; n < BENCHMARK_RUNS; n++) {
+            ip::houghAccumulatePyramid(edges[i], acc_pyr, win, 8, 3 * CV_PI / 180);
+        }
+        int64 t4 = getTickCount();
+
+        t_ref += (t1 - t0) / getTickFrequency();
+        t_fast += (t2 - t1) / getTickFrequency();
+        t_orient += (t3 - t2) / getTickFrequency();
+        t_pyr += (t4 - t3) / getTickFrequency();
+
+        /* accumulators have to be identical */
+        Mat diff;
+        compare(acc_ref, acc_fast, diff, CMP_NE);
+        if (countNonZero(diff) != 0) {
+            std::cout << "[ERROR] Hough accumulator differs on test image " << i << endl;
+            errors++;
+        }
+
+        /* coarse-to-fine peak should be the global peak (within one bin) */
+        Point loc_ref, loc_pyr;
+        minMaxLoc(acc_ref, NULL, NULL, NULL, &loc_ref);
+        minMaxLoc(acc_pyr, NULL, NULL, NULL, &loc_pyr);
+        int du = abs(((loc_pyr.x + win.x) % acc_ref.cols + acc_ref.cols) % acc_ref.cols - loc_ref.x);
+        du = min(du, acc_ref.cols - du);
+        if ((du <= 1) && (abs(loc_pyr.y + win.y - loc_ref.y) <= 1)) {
+            pyr_match++;
+        }
+
+        /* first window of several coarse lines (Hough candidates) is the window of the strongest one */
+        ip::EdgeList edge_list;
+        ip::edgeListFromImage(edges[i], edge_list);
+        vector<Mat> acc_wins;
+        vector<Rect> wins;
+        bool first_ok = (ip::houghAccumulatePyramid(edge_list, acc_wins, wins, 8, 3 * CV_PI / 180, 3) > 0) && (wins[0] == win);
+        if (first_ok) {
+            compare(acc_wins[0], acc_pyr, diff, CMP_NE);
+            first_ok = (countNonZero(diff) == 0);
+        }
+        if (!first_ok) {
+            std::cout << "[ERROR] first Hough candidate window differs on test image " << i << endl;
+            errors++;
+        }
+    }
+
+    /***
+     * corner pixels reach the largest radius, with an even height (coarse levels
+     * of the pyramid) they round to one bin past the last row
+    ***/
+    Mat corners = Mat::zeros(Size(640, 480), CV_8U);
+    corners.at<uchar>(0, 0) = 255;
+    corners.at<uchar>(0, 639) = 255;
+    corners.at<uchar>(479, 0) = 255;
+    corners.at<uchar>(479, 639) = 255;
+    const int corner_heights[] = { 361, 180, 90 };
+    for (int height : corner_heights) {
+        Mat acc_ref, acc_fast, diff;
+        ip::houghAccumulateReference(corners, acc_ref, height, 360);
+        ip::houghAccumulate(corners, acc_fast, height, 360);
+        compare(acc_ref, acc_fast, diff, CMP_NE);
+        if ((countNonZero(diff) != 0) || (sum(acc_fast)[0] != 4 * 360)) {
+            std::cout << "[ERROR] Hough accumulator of the corner pixels, height " << height << endl;
+            errors++;
+        }
+    }
+    Mat acc_corners;
+    Rect win_corners;
+    ip::houghAccumulatePyramid(corners, acc_corners, win_corners, 8, 3 * CV_PI / 180);
+
+    double ms_ref = 1000.0 * t_ref / (BENCHMARK_RUNS * edges.size());
+    double ms_fast = 1000.0 * t_fast / (BENCHMARK_RUNS * edges.size());
+    double ms_orient = 1000.0 * t_orient / (BENCHMARK_RUNS * edges.size());
+    std::cout << "Hough accumulator:  reference " << ms_ref << " ms, fast " << ms_fast << " ms, speedup " << ms_ref / ms_fast << endl;
+    std::cout << "Hough oriented (+/-16 bins): " << ms_orient << " ms, speedup " << ms_ref / ms_orient << endl;
+    double ms_pyr = 1000.0 * t_pyr / (BENCHMARK_RUNS * edges.size());
+    std::cout << "Hough coarse-to-fine: " << ms_pyr << " ms, speedup " << ms_ref / ms_pyr << ", peak found " << pyr_match << "/" << edges.size() << endl;
+
+    return errors;
+}
+
+
+/* difference image, sobel input, binary edge image and gradient direction of a test pair, two step version of img_proc_get_line() without calibration */
+static void benchmark_edge_bin(const Mat& last, const Mat& cur, Mat& diff_gray, Mat& sharp, Mat& edge_bin, Mat& edge_dir) {
+
+    Mat last_blur, cur_blur, last_gray, cur_gray, edge;
+
+    GaussianBlur(last, last_blur, Size(3, 3), GAUSSIAN_BLUR_SIGMA, GAUSSIAN_BLUR_SIGMA);
+    GaussianBlur(cur, cur_blur, Size(3, 3), GAUSSIAN_BLUR_SIGMA, GAUSSIAN_BLUR_SIGMA);
+    cvtColor(last_blur, last_gray, COLOR_BGR2GRAY);
+    cvtColor(cur_blur, cur_gray, COLOR_BGR2GRAY);
+    absdiff(last_gray, cur_gray, diff_gray);
+    img_proc_sharpen_img(diff_gray, sharp);
+    ip::sobelFilter(sharp, edge, edge_dir);
+    threshold(edge, edge_bin, BIN_THRESH, 255, THRESH_BINARY);
+}
+
+
+
+/***
+ *
+ * benchmark_edge_list(const std::vector<cv::Mat>& edges, const std::vector<cv::Mat>& dirs)
+ *
+ * Check that the sparse edge list holds exactly the pixels of the binary edge
+ * image and print its fill rate and the Hough run time on the list compared
+ * to the full frame
+ *
+ *
+ * @param:	const std::vector<cv::Mat>& edges --> binary edge images
+ * @param:	const std::vector<cv::Mat>& dirs --> gradient directions of the edge images
+ *
+ *
+ * @return: int number of failed checks
+ *
+ *
+ * @note:   None
+ *
+ *
+ * Example usage: None
+ *
+***/
+int benchmark_edge_list(const std::vector<cv::Mat>& edges, const std::vector<cv::Mat>& dirs) {
+
+    int errors = 0;
+    double fill = 0;
+    double t_image = 0;
+    double t_list = 0;
+
+    for (size_t i = 0; i < edges.size(); i++) {
+        ip::EdgeList list;
+        ip::edgeListFromImage(edges[i], list, dirs[i]);
+        fill += (double)list.size() / edges[i].total();
+
+        /* round trip has to give the same binary image */
+        Mat edge_bin, diff;
+        ip::edgeListToImage(list, edge_bin);
+        compare(edge_bin, edges[i], diff, CMP_NE);
+        if ((countNonZero(diff) != 0) || (list.dir.size() != list.size())) {
+            std::cout << "[ERROR] Edge list differs on test image " << i << endl;
+            errors++;
+        }
+
+        Mat acc;
+        int64 t0 = getTickCount();
+        for (int n = 0; n < BENCHMARK_RUNS; n++) {
+            ip::houghAccumulate(edges[i], acc);
+        }
+        int64 t1 = getTickCount();
+        for (int n = 0; n < BENCHMARK_RUNS; n++) {
+            ip::houghAccumulate(list, acc);
+        }
+        int64 t2 = getTickCount();
+
+        t_image += (t1 - t0) / getTickFrequency();
+        t_list += (t2 - t1) / getTickFrequency();
+    }
+
+    double ms_image = 1000.0 * t_image / (BENCHMARK_RUNS * edges.size());
+    double ms_list = 1000.0 * t_list / (BENCHMARK_RUNS * edges.size());
+    std::cout << "Edge list: " << 100.0 * fill / edges.size() << " % edge pixels, Hough on frame " << ms_image << " ms, on list " << ms_list << " ms" << endl;
+
+    return errors;
+}
+
+
+
+/***
+ *
+ * benchmark_sobel(const std::vector<cv::Mat>& images)
+ *
+ * Compare the integer sobel kernel against ip::sobelFilterReference() and the
+ * fused threshold against threshold() and print the run times of all
+ * magnitude approximations
+ *
+ *
+ * @param:	const std::vector<cv::Mat>& images --> sobel inputs (sharpened difference images)
+ *
+ *
+ * @return: int number of failed checks
+ *
+ *
+ * @note:   None
+ *
+ *
+ * Example usage: None
+ *
+***/
+int benchmark_sobel(const std::vector<cv::Mat>& images) {
+
+    const char* names[] = { "exact", "L1", "alpha-max-beta-min" };
+    int errors = 0;
+    double t_ref = 0;
+    double t_ref_thresh = 0;
+    double t_mag[3] = { 0, 0, 0 };
+    double t_fused = 0;
+
+    for (size_t i = 0; i < images.size(); i++) {
+        Mat sobel_ref, sobel, bin_ref, bin, diff;
+
+        int64 t0 = getTickCount();
+        for (int n = 0; n < BENCHMARK_RUNS; n++) {
+            ip::sobelFilterReference(images[i], sobel_ref);
+        }
+        int64 t1 = getTickCount();
+        for (int n = 0; n < BENCHMARK_RUNS; n++) {
+            ip::sobelFilterReference(images[i], sobel_ref);
+            threshold(sobel_ref, bin_ref, BIN_THRESH, 255, THRESH_BINARY);
+        }
+        int64 t2 = getTickCount();
+        t_ref += (t1 - t0) / getTickFrequency();
+        t_ref_thresh += (t2 - t1) / getTickFrequency();
+
+        for (int m = 0; m < 3; m++) {
+            int64 t3 = getTickCount();
+            for (int n = 0; n < BENCHMARK_RUNS; n++) {
+                ip::sobelFilter(images[i], sobel, (ip::SobelMagnitude)m);
+            }
+            t_mag[m] += (getTickCount() - t3) / getTickFrequency();
+        }
+
+        int count = 0;
+        int64 t4 = getTickCount();
+        for (int n = 0; n < BENCHMARK_RUNS; n++) {
+            count = ip::sobelThreshold(images[i], bin, BIN_THRESH);
+        }
+        t_fused += (getTickCount() - t4) / getTickFrequency();
+
+        /* exact magnitude and fused threshold have to be identical */
+        ip::sobelFilter(images[i], sobel);
+        compare(sobel, sobel_ref, diff, CMP_NE);
+        if (countNonZero(diff) != 0) {
+            std::cout << "[ERROR] Sobel magnitude differs on test image " << i << endl;
+            errors++;
+        }
+        compare(bin, bin_ref, diff, CMP_NE);
+        if ((countNonZero(diff) != 0) || (count != countNonZero(bin_ref))) {
+            std::cout << "[ERROR] Fused Sobel threshold differs on test image " << i << endl;
+            errors++;
+        }
+    }
+
+    double runs = (double)BENCHMARK_RUNS * images.size();
+    std::cout << "Sobel " << images[0].cols << "x" << images[0].rows << ": reference " << 1000.0 * t_ref / runs << " ms";
+    for (int m = 0; m < 3; m++) {
+        std::cout << ", " << names[m] << " " << 1000.0 * t_mag[m] / runs << " ms";
+    }
+    std::cout << endl;
+    std::cout << "Sobel + threshold: reference " << 1000.0 * t_ref_thresh / runs << " ms, fused " << 1000.0 * t_fused / runs
+        << " ms, speedup " << t_ref_thresh / t_fused << endl;
+
+    return errors;
+}
+
+
+
+/***
+ *
+ * benchmark_sharpen_sobel(const std::vector<cv::Mat>& images)
+ *
+ * Compare the one pass ip::sharpenSobelFilter() / ip::sharpenSobelThreshold()
+ * against img_proc_sharpen_img() followed by the sobel kernel and print the
+ * run times
+ *
+ *
+ * @param:	const std::vector<cv::Mat>& images --> difference images (not sharpened)
+ *
+ *
+ * @return: int number of failed checks
+ *
+ *
+ * @note:   None
+ *
+ *
+ * Example usage: None
+ *
+***/
+int benchmark_sharpen_sobel(const std::vector<cv::Mat>& images) {
+
+    int errors = 0;
+    double t_two_step = 0;
+    double t_one_pass = 0;
+    double t_two_step_thresh = 0;
+    double t_one_pass_thresh = 0;
+
+    for (size_t i = 0; i < images.size(); i++) {
+        Mat sharp, sobel_ref, sobel, dir_ref, dir, bin_ref, bin, diff;
+        int count_ref = 0;
+        int count = 0;
+
+        int64 t0 = getTickCount();
+        for (int n = 0; n < BENCHMARK_RUNS; n++) {
+            img_proc_sharpen_img(images[i], sharp);
+            ip::sobelFilter(sharp, sobel_ref, dir_ref);
+        }
+        int64 t1 = getTickCount();
+        for (int n = 0; n < BENCHMARK_RUNS; n++) {
+            ip::sharpenSobelFilter(images[i], sobel, dir, SHARPEN_KERNEL_CENTER);
+        }
+        int64 t2 = getTickCount();
+        for (int n = 0; n < BENCHMARK_RUNS; n++) {
+            img_proc_sharpen_img(images[i], sharp);
+            count_ref = ip::sobelThreshold(sharp, bin_ref, BIN_THRESH);
+        }
+        int64 t3 = getTickCount();
+        for (int n = 0; n < BENCHMARK_RUNS; n++) {
+            count = ip::sharpenSobelThreshold(images[i], bin, BIN_THRESH, SHARPEN_KERNEL_CENTER);
+        }
+        int64 t4 = getTickCount();
+        t_two_step += (t1 - t0) / getTickFrequency();
+        t_one_pass += (t2 - t1) / getTickFrequency();
+        t_two_step_thresh += (t3 - t2) / getTickFrequency();
+        t_one_pass_thresh += (t4 - t3) / getTickFrequency();
+
+        /* one pass has to be identical to the two steps */
+        compare(sobel, sobel_ref, diff, CMP_NE);
+        if (countNonZero(diff) != 0) {
+            std::cout << "[ERROR] Sharpened Sobel magnitude differs on test image " << i << endl;
+            errors++;
+        }
+        compare(dir, dir_ref, diff, CMP_NE);
+        if (countNonZero(diff) != 0) {
+            std::cout << "[ERROR] Sharpened Sobel direction differs on test image " << i << endl;
+            errors++;
+        }
+        compare(bin, bin_ref, diff, CMP_NE);
+        if ((countNonZero(diff) != 0) || (count != count_ref)) {
+            std::cout << "[ERROR] Sharpened Sobel threshold differs on test image " << i << endl;
+            errors++;
+        }
+    }
+
+    double runs = (double)BENCHMARK_RUNS * images.size();
+    std::cout << "Sharpen + Sobel: two steps " << 1000.0 * t_two_step / runs << " ms, one pass " << 1000.0 * t_one_pass / runs
+        << " ms, speedup " << t_two_step / t_one_pass << endl;
+    std::cout << "Sharpen + Sobel + threshold: two steps " << 1000.0 * t_two_step_thresh / runs << " ms, one pass " << 1000.0 * t_one_pass_thresh / runs
+        << " ms, speedup " << t_two_step_thresh / t_one_pass_thresh << endl;
+
+    return errors;
+}
+
+
+
+/***
+ *
+ * benchmark_parallel(const std::vector<cv::Mat>& images, const std::vector<cv::Mat>& edges, const std::vector<cv::Mat>& dirs)
+ *
+ * Speedup curves of the stripe parallel kernels, every kernel is timed with
+ * 1..N threads (see ip::setParallelThreads())
+ *
+ *
+ * @param:	const std::vector<cv::Mat>& images --> sobel inputs (sharpened difference images)
+ * @param:	const std::vector<cv::Mat>& edges --> binary edge images
+ * @param:	const std::vector<cv::Mat>& dirs --> gradient directions of the edge images
+ *
+ *
+ * @return: void
+ *
+ *
+ * @note:   The thread count is reset to the one of OpenCV at the end.
+ *
+ *
+ * Example usage: None
+ *
+***/
+void benchmark_parallel(const std::vector<cv::Mat>& images, const std::vector<cv::Mat>& edges, const std::vector<cv::Mat>& dirs) {
+
+    const int num_kernels = 6;
+    const char* names[num_kernels] = { "sobel", "sobel+dir", "edge list", "hough", "band points", "cross points" };
+    int max_threads = max(1, getNumThreads());
+    vector<double> t_single(num_kernels, 0);
+
+    /* inputs of the kernels, which are not test images themselves */
+    vector<Mat> sobels(images.size());
+    vector<ip::EdgeList> lists(edges.size());
+    for (size_t i = 0; i < images.size(); i++) {
+        ip::sobelFilter(images[i], sobels[i]);
+        ip::edgeListFromImage(edges[i], lists[i], dirs[i]);
+    }
+    Size frame_size = images[0].size();
+    Mat cross_frame = Mat::zeros(frame_size, CV_8UC3);
+    ip::drawLine_light_add(cross_frame, 10, 0.5);
+    ip::drawLine_light_add(cross_frame, -20, 1.5);
+    ip::drawLine_light_add(cross_frame, 30, 2.5);
+    RotatedRect band(Point2f(frame_size.width / 2.0f, frame_size.height / 2.0f), Size2f((float)frame_size.width, 100), 30);
+
+    std::cout << "Parallel kernels [ms (speedup)]:" << endl;
+    std::cout << "threads";
+    for (int k = 0; k < num_kernels; k++) {
+        std::cout << "\t" << names[k];
+    }
+    std::cout << endl;
+
+    for (int threads = 1; threads <= max_threads; threads++) {
+        ip::setParallelThreads(threads);
+        double t[num_kernels] = { 0, 0, 0, 0, 0, 0 };
+
+        for (size_t i = 0; i < images.size(); i++) {
+            Mat out, dir, acc;
+            ip::EdgeList list;
+            vector<Point> points;
+
+            int64 t0 = getTickCount();
+            for (int n = 0; n < BENCHMARK_RUNS; n++) {
+                ip::sobelFilter(images[i], out);
+            }
+            int64 t1 = getTickCount();
+            for (int n = 0; n < BENCHMARK_RUNS; n++) {
+                ip::sobelFilter(images[i], out, dir);
+            }
+            int64 t2 = getTickCount();
+            for (int n = 0; n < BENCHMARK_RUNS; n++) {
+                ip::edgeListThreshold(sobels[i], BIN_THRESH, list);
+            }
+            int64 t3 = getTickCount();
+            for (int n = 0; n < BENCHMARK_RUNS; n++) {
+                ip::houghAccumulate(lists[i], acc);
+            }
+            int64 t4 = getTickCount();
+            for (int n = 0; n < BENCHMARK_RUNS; n++) {
+                img_proc_band_points(lists[i], band, points);
+            }
+            int64 t5 = getTickCount();
+            for (int n = 0; n < BENCHMARK_RUNS; n++) {
+                points.clear();
+                img_proc_get_cross_points(cross_frame, points);
+            }
+            int64 t6 = getTickCount();
+
+            t[0] += (t1 - t0) / getTickFrequency();
+            t[1] += (t2 - t1) / getTickFrequency();
+            t[2] += (t3 - t2) / getTickFrequency();
+            t[3] += (t4 - t3) / getTickFrequency();
+            t[4] += (t5 - t4) / getTickFrequency();
+            t[5] += (t6 - t5) / getTickFrequency();
+        }
+
+        std::cout << threads;
+        for (int k = 0; k < num_kernels; k++) {
+            if (threads == 1) {
+                t_single[k] = t[k];
+            }
+            std::cout << "\t" << 1000.0 * t[k] / (BENCHMARK_RUNS * images.size()) << " (" << t_single[k] / t[k] << ")";
+        }
+        std::cout << endl;
+    }
+
+    ip::setParallelThreads(0);
+}
+
+
+
+/***
+ *
+ * benchmark_line_methods(const std::vector<cv::Mat>& lasts, const std::vector<cv::Mat>& curs, const std::vector<int>& cams)
+ *
+ * Run all line extraction methods (LINE_METHOD_*) on the same frames and
+ * print their latency and accuracy side by side
+ *
+ *
+ * @param:	const std::vector<cv::Mat>& lasts --> last images
+ * @param:	const std::vector<cv::Mat>& curs --> current images
+ * @param:	const std::vector<int>& cams --> camera perspective of each pair
+ *
+ *
+ * @return: void
+ *
+ *
+ * @note:   The accuracy is measured against the lines in BENCHMARK_LINE_TRUTH
+ *          (sequence "lines" of [r, theta] per test pair, uncalibrated image
+ *          coordinates) if the file exists, else against the method selected
+ *          for the camera (img_proc_set_line_method()).
+ *          The test images are not calibrated.
+ *
+ *
+ * Example usage: None
+ *
+***/
+void benchmark_line_methods(const std::vector<cv::Mat>& lasts, const std::vector<cv::Mat>& curs, const std::vector<int>& cams) {
+
+    size_t num = lasts.size();
+
+    /* lines of all methods, the last run of every pair */
+    vector<vector<struct line_s>> lines(LINE_METHOD_COUNT, vector<struct line_s>(num));
+    vector<vector<int>> status(LINE_METHOD_COUNT, vector<int>(num, EXIT_FAILURE));
+    double t_method[LINE_METHOD_COUNT] = { 0 };
+
+    for (int method = 0; method < LINE_METHOD_COUNT; method++) {
+        for (size_t i = 0; i < num; i++) {
+            int64 t0 = getTickCount();
+            for (int n = 0; n < BENCHMARK_RUNS; n++) {
+                status[method][i] = img_proc_run_line_method(lasts[i], curs[i], cams[i], method, &lines[method][i], false);
+            }
+            t_method[method] += (getTickCount() - t0) / getTickFrequency();
+        }
+    }
+
+    /* reference lines, ground truth if available */
+    vector<double> r_ref(num, 0), theta_ref(num, 0);
+    vector<bool> ref_valid(num, false);
+    FileStorage fs(BENCHMARK_LINE_TRUTH, FileStorage::READ);
+    FileNode truth = fs.isOpened() ? fs["lines"] : FileNode();
+    bool use_truth = !truth.empty() && (truth.size() == num);
+    for (size_t i = 0; i < num; i++) {
+        if (use_truth) {
+            r_ref[i] = (double)truth[(int)i][0];
+            theta_ref[i] = (double)truth[(int)i][1];
+            ref_valid[i] = true;
+        }
+        else if (status[img_proc_get_line_method(cams[i])][i] == EXIT_SUCCESS) {
+            r_ref[i] = lines[img_proc_get_line_method(cams[i])][i].r;
+            theta_ref[i] = lines[img_proc_get_line_method(cams[i])][i].theta;
+            ref_valid[i] = true;
+        }
+    }
+
+    std::cout << "Line methods on " << num << " test pairs, accuracy against "
+        << (use_truth ? BENCHMARK_LINE_TRUTH : "the method selected for the camera") << endl;
+    std::cout << "method\tms\tfound\tmean |dr| [pixel]\tmean |dtheta| [deg]" << endl;
+    for (int method = 0; method < LINE_METHOD_COUNT; method++) {
+        int found = 0;
+        int compared = 0;
+        double sum_dr = 0;
+        double sum_dtheta = 0;
+        for (size_t i = 0; i < num; i++) {
+            if (status[method][i] != EXIT_SUCCESS) {
+                continue;
+            }
+            found++;
+            if (!ref_valid[i]) {
+                continue;
+            }
+            double dr, dtheta;
+            benchmark_line_error(lines[method][i].r, lines[method][i].theta, r_ref[i], theta_ref[i], &dr, &dtheta);
+            sum_dr += dr;
+            sum_dtheta += dtheta;
+            compared++;
+        }
+
+        std::cout << img_proc_line_method_name(method) << "\t" << 1000.0 * t_method[method] / (BENCHMARK_RUNS * num)
+            << "\t" << found << "/" << num;
+        if (compared > 0) {
+            std::cout << "\t" << sum_dr / compared << "\t" << sum_dtheta / compared * 180.0 / CV_PI;
+        }
+        else {
+            std::cout << "\t-\t-";
+        }
+        std::cout << endl;
+    }
+}
+
+
+/***
+ *
+ * benchmark_native(const std::vector<cv::Mat>& lasts, const std::vector<cv::Mat>& curs, const std::vector<int>& cams)
+ *
+ * Self-check and timing of the native line space: the line fitted in camera
+ * coordinates and mapped through the homography has to stay within
+ * BENCHMARK_NATIVE_R_TOL / BENCHMARK_NATIVE_THETA_TOL of the fit on the
+ * warped images
+ *
+ *
+ * @param:	const std::vector<cv::Mat>& lasts --> last images
+ * @param:	const std::vector<cv::Mat>& curs --> current images
+ * @param:	const std::vector<int>& cams --> camera perspective of each pair
+ *
+ *
+ * @return: int --> number of failed checks
+ *
+ *
+ * @note:   Cameras without calibration get a homography with a perspective
+ *          of BENCHMARK_NATIVE_SKEW pixel; the homography and the line space
+ *          are restored afterwards.
+ *
+ *
+ * Example usage: None
+ *
+***/
+int benchmark_native(const std::vector<cv::Mat>& lasts, const std::vector<cv::Mat>& curs, const std::vector<int>& cams) {
+
+    int errors = 0;
+    bool native = img_proc_get_native();
+    double t_warp = 0;
+    double t_native = 0;
+    int compared = 0;
+
+    for (size_t i = 0; i < lasts.size(); i++) {
+        struct rig_cam_s* cam = rig_cam(cams[i]);
+        if (cam == nullptr) {
+            continue;
+        }
+        int method = img_proc_get_line_method(cams[i]);
+
+        /* homography of the camera, else a camera looking down at the board */
+        Mat H_cam = cam->H;
+        if (H_cam.empty()) {
+            float w = (float)curs[i].cols;
+            float h = (float)curs[i].rows;
+            vector<Point2f> src = { Point2f(0, 0), Point2f(w, 0), Point2f(w, h), Point2f(0, h) };
+            vector<Point2f> dst = { Point2f(BENCHMARK_NATIVE_SKEW, 0), Point2f(w - BENCHMARK_NATIVE_SKEW, 0), Point2f(w, h), Point2f(0, h) };
+            cam->H = getPerspectiveTransform(src, dst);
+        }
+        cam->map1.release();
+        cam->map2.release();
+
+        /* fit on the warped images and native fit, same method */
+        struct line_s line_warp, line_native;
+        int status_warp = EXIT_FAILURE;
+        int status_native = EXIT_FAILURE;
+
+        img_proc_set_native(false);
+        int64 t0 = getTickCount();
+        for (int n = 0; n < BENCHMARK_RUNS; n++) {
+            status_warp = img_proc_run_line_method(lasts[i], curs[i], cams[i], method, &line_warp, true);
+        }
+        t_warp += (getTickCount() - t0) / getTickFrequency();
+
+        img_proc_set_native(true);
+        t0 = getTickCount();
+        for (int n = 0; n < BENCHMARK_RUNS; n++) {
+            status_native = img_proc_run_line_method(lasts[i], curs[i], cams[i], method, &line_native, true);
+        }
+        t_native += (getTickCount() - t0) / getTickFrequency();
+
+        cam->H = H_cam;
+        cam->map1.release();
+        cam->map2.release();
+
+        if ((status_warp != EXIT_SUCCESS) && (status_native != EXIT_SUCCESS)) {
+            continue;
+        }
+        if (status_warp != status_native) {
+            std::cout << "[ERROR] native line: pair " << i << " found only " << ((status_native == EXIT_SUCCESS) ? "native" : "warped") << endl;
+            errors++;
+            continue;
+        }
+
+        double dr, dtheta;
+        benchmark_line_error(line_native.r, line_native.theta, line_warp.r, line_warp.theta, &dr, &dtheta);
+        compared++;
+        if ((dr > BENCHMARK_NATIVE_R_TOL) || (dtheta > BENCHMARK_NATIVE_THETA_TOL)) {
+            std::cout << "[ERROR] native line: pair " << i << " |dr| " << dr << " pixel, |dtheta| " << dtheta * 180.0 / CV_PI << " deg" << endl;
+            errors++;
+        }
+    }
+
+    img_proc_set_native(native);
+
+    if (compared > 0) {
+        std::cout << "Native lines on " << compared << " test pairs: warped " << 1000.0 * t_warp / (BENCHMARK_RUNS * lasts.size())
+            << " ms, native " << 1000.0 * t_native / (BENCHMARK_RUNS * lasts.size()) << " ms" << endl;
+    }
+
+    return errors;
+}
+
+
+/***
+ *
+ * benchmark_ctf(const std::vector<cv::Mat>& lasts, const std::vector<cv::Mat>& curs, const std::vector<int>& cams)
+ *
+ * Latency and precision of the coarse cluster search of LINE_METHOD_PCA:
+ * every pyrDown level (img_proc_set_ctf_levels()) against the full
+ * resolution path (threshold 190) on the same frames
+ *
+ *
+ * @param:	const std::vector<cv::Mat>& lasts --> last images
+ * @param:	const std::vector<cv::Mat>& curs --> current images
+ * @param:	const std::vector<int>& cams --> camera perspective of each pair
+ *
+ *
+ * @return: void
+ *
+ *
+ * @note:   The refit on the full resolution edges is the same for all
+ *          levels, differences come from the cluster and band selection.
+ *          The test images are not calibrated.
+ *
+ *
+ * Example usage: None
+ *
+***/
+void benchmark_ctf(const std::vector<cv::Mat>& lasts, const std::vector<cv::Mat>& curs, const std::vector<int>& cams) {
+
+    size_t num = lasts.size();
+    int levels = img_proc_get_ctf_levels();
+    int level_max = 0;
+    while (img_proc_set_ctf_levels(level_max + 1) == EXIT_SUCCESS) {
+        level_max++;
+    }
+
+    /* pca lines of every level, the last run of every pair */
+    vector<vector<struct line_s>> lines(level_max + 1, vector<struct line_s>(num));
+    vector<vector<int>> status(level_max + 1, vector<int>(num, EXIT_FAILURE));
+    vector<double> t_level(level_max + 1, 0);
+    for (int level = 0; level <= level_max; level++) {
+        img_proc_set_ctf_levels(level);
+        for (size_t i = 0; i < num; i++) {
+            int64 t0 = getTickCount();
+            for (int n = 0; n < BENCHMARK_RUNS; n++) {
+                status[level][i] = img_proc_run_line_method(lasts[i], curs[i], cams[i], LINE_METHOD_PCA, &lines[level][i], false);
+            }
+            t_level[level] += (getTickCount() - t0) / getTickFrequency();
+        }
+    }
+    img_proc_set_ctf_levels(levels);
+
+    std::cout << "Coarse cluster search on " << num << " test pairs, precision against full resolution" << endl;
+    std::cout << "levels\tms\tfound\tmean |dr| [pixel]\tmean |dtheta| [deg]\tmax |dtheta| [deg]" << endl;
+    for (int level = 0; level <= level_max; level++) {
+        int found = 0;
+        int compared = 0;
+        double sum_dr = 0;
+        double sum_dtheta = 0;
+        double max_dtheta = 0;
+        for (size_t i = 0; i < num; i++) {
+            if (status[level][i] != EXIT_SUCCESS) {
+                continue;
+            }
+            found++;
+            if (status[0][i] != EXIT_SUCCESS) {
+                continue;
+            }
+            double dr, dtheta;
+            benchmark_line_error(lines[level][i].r, lines[level][i].theta, lines[0][i].r, lines[0][i].theta, &dr, &dtheta);
+            sum_dr += dr;
+            sum_dtheta += dtheta;
+            max_dtheta = std::max(max_dtheta, dtheta);
+            compared++;
+        }
+
+        std::cout << level << "\t" << 1000.0 * t_level[level] / (BENCHMARK_RUNS * num) << "\t" << found << "/" << num;
+        if (compared > 0) {
+            std::cout << "\t" << sum_dr / compared << "\t" << sum_dtheta / compared * 180.0 / CV_PI << "\t" << max_dtheta * 180.0 / CV_PI;
+        }
+        else {
+            std::cout << "\t-\t-\t-";
+        }
+        std::cout << endl;
+    }
+}
+
+
+/***
+ *
+ * benchmark_auto_cal(void)
+ *
+ * Latency of the auto calibration: the cameras one after the other (as
+ * before the parallel calibration) against calibration_auto_cal_rig(), both
+ * with matching, pose, verification warp and sectors
+ *
+ *
+ * @param:	None
+ *
+ *
+ * @return: int --> number of failed checks
+ *
+ *
+ * @note:   The homographies of both have to map the frame center within
+ *          BENCHMARK_CAL_TOL (RANSAC). The calibration of the rig is
+ *          restored afterwards, the reference features are loaded before
+ *          the timing.
+ *
+ *
+ * Example usage: None
+ *
+***/
+int benchmark_auto_cal(void) {
+
+    int errors = 0;
+    int num = rig_num_cams();
+
+    /* calibration state of the rig, restored afterwards */
+    vector<Mat> cur_saved(num), H_saved(num);
+    vector<Matx33d> R_saved(num);
+    vector<Vec3d> t_saved(num);
+    vector<bool> pose_saved(num);
+    for (int i = 0; i < num; i++) {
+        struct rig_cam_s* cam = rig_cam(i);
+        cur_saved[i] = cam->cur;
+        H_saved[i] = cam->H;
+        R_saved[i] = cam->R;
+        t_saved[i] = cam->t;
+        pose_saved[i] = cam->pose_valid;
+    }
+
+    /* calibration frames of the cameras */
+    vector<int> ids;
+    for (const auto& frame : benchmark_cal_frames) {
+        struct rig_cam_s* cam = rig_cam(frame.cam);
+        Mat img = imread(frame.img, IMREAD_COLOR);
+        if ((cam == nullptr) || img.empty()) {
+            continue;
+        }
+        cam->cur = img;
+        ids.push_back(frame.cam);
+    }
+    if (ids.empty() || (calibration_ref_load() != EXIT_SUCCESS)) {
+        std::cout << "[WARNING] auto calibration: no calibration frames or reference images" << endl;
+        ids.clear();
+    }
+
+    /* one camera after the other */
+    vector<Mat> H_serial(num);
+    int64 t0 = getTickCount();
+    for (int n = 0; (n < BENCHMARK_CAL_RUNS) && !ids.empty(); n++) {
+        for (int id : ids) {
+            struct rig_cam_s* cam = rig_cam(id);
+            calibration_match(cam->cur, id);
+            if (cam->H.empty()) {
+                continue;
+            }
+            calibration_pose(id);
+            Mat warped;
+            calibration_get_img(cam->cur, warped, id);
+            dart_board_draw_sectors(warped, id, 0, 0);
+            H_serial[id] = cam->H.clone();
+        }
+    }
+    double t_serial = (getTickCount() - t0) / getTickFrequency();
+
+    /* all cameras in parallel */
+    vector<Mat> warped;
+    int calibrated = 0;
+    t0 = getTickCount();
+    for (int n = 0; (n < BENCHMARK_CAL_RUNS) && !ids.empty(); n++) {
+        calibrated = calibration_auto_cal_rig(warped);
+    }
+    double t_parallel = (getTickCount() - t0) / getTickFrequency();
+
+    /* same homographies */
+    for (int id : ids) {
+        struct rig_cam_s* cam = rig_cam(id);
+        if (H_serial[id].empty() || cam->H.empty()) {
+            continue;
+        }
+        vector<Point2f> center(1, Point2f(cam->cur.cols / 2.0f, cam->cur.rows / 2.0f));
+        vector<Point2f> p_serial, p_parallel;
+        perspectiveTransform(center, p_serial, H_serial[id]);
+        perspectiveTransform(center, p_parallel, cam->H);
+        double d = norm(p_serial[0] - p_parallel[0]);
+        if (d > BENCHMARK_CAL_TOL) {
+            std::cout << "[ERROR] auto calibration: " << cam->name << " Cam homographies differ by " << d << " pixel" << endl;
+            errors++;
+        }
+    }
+
+    for (int i = 0; i < num; i++) {
+        struct rig_cam_s* cam = rig_cam(i);
+        cam->cur = cur_saved[i];
+        cam->H = H_saved[i];
+        cam->R = R_saved[i];
+        cam->t = t_saved[i];
+        cam->pose_valid = pose_saved[i];
+        cam->map1.release();
+        cam->map2.release();
+    }
+
+    if (!ids.empty() && (t_serial > 0)) {
+        std::cout << "Auto calibration of " << ids.size() << " cameras (" << calibrated << " calibrated): serial "
+            << 1000.0 * t_serial / BENCHMARK_CAL_RUNS << " ms, parallel " << 1000.0 * t_parallel / BENCHMARK_CAL_RUNS
+            << " ms (" << 100.0 * t_parallel / t_serial << " %)" << endl;
+    }
+
+    return errors;
+}
+
+
+/* distance of two lines in polar coordinates, (r, theta) and (-r, theta +- pi) are the same line */
+static void benchmark_line_error(double r, double theta, double r_ref, double theta_ref, double* dr, double* dtheta) {
+
+    double d = theta - theta_ref;
+    d -= CV_PI * floor(d / CV_PI + 0.5);     // [-pi/2, pi/2)
+
+    /* odd number of half turns flips the sign of r */
+    long half_turns = lround((theta - theta_ref - d) / CV_PI);
+    double r_aligned = (half_turns % 2 == 0) ? r : -r;
+
+    *dr = fabs(r_aligned - r_ref);
+    *dtheta = fabs(d);
+}
@@ -0,0 +1,63 @@
+/******************************************************************************
+ *
+ * benchmark.h
+ *
+ *
+ * Automated Dart Detection and Scoring System
+ *
+ *
+ * This project was developed as part of the Digital Image / Video Processing
+ * module at HAW Hamburg under Prof. Dr. Marc Hensel
+ *
+ *
+ *
+ * Author(s):   	Mika Paul Salewski <mika.paul.salewski@gmail.com>
+ *
+ * Created on :     2025-01-06
+ * Last revision :  None
+ *
+ *
+ *
+ * Copyright (c) 2025, Mika Paul Salewski
+ * Version: 2025.01.06
+ * License: CC BY-NC-SA 4.0,
+ *      see https://creativecommons.org/licenses/by-nc-sa/4.0/deed.en
+ *
+ *
+ * Further information about this source-file:
+ *      --> self-check and timing of the image processing kernels on the
+ *          static test images
+******************************************************************************/
+
+
+#ifndef BENCHMARK_H
+#define BENCHMARK_H
+
+
+#include <opencv2/opencv.hpp>
+#include <vector>
+
+/************************** Function Declaration *****************************/
+
+extern void benchmark_run(void);
+
+extern int benchmark_sobel(const std::vector<cv::Mat>& images);
+
+extern int benchmark_sharpen_sobel(const std::vector<cv::Mat>& images);
+
+extern int benchmark_hough(const std::vector<cv::Mat>& edges, const std::vector<cv::Mat>& dirs);
+
+extern int benchmark_edge_list(const std::vector<cv::Mat>& edges, const std::vector<cv::Mat>& dirs);
+
+extern void benchmark_parallel(const std::vector<cv::Mat>& images, const std::vector<cv::Mat>& edges, const std::vector<cv::Mat>& dirs);
+
+extern void benchmark_line_methods(const std::vector<cv::Mat>& lasts, const std::vector<cv::Mat>& curs, const std::vector<int>& cams);
+
+extern int benchmark_native(const std::vector<cv::Mat>& lasts, const std::vector<cv::Mat>& curs, const std::vector<int>& cams);
+
+extern void benchmark_ctf(const std::vector<cv::Mat>& lasts, const std::vector<cv::Mat>& curs, const std::vector<int>& cams);
+
+extern int benchmark_auto_cal(void);
+
+
+#endif 
@@ -27,6 +27,8 @@
  *
  * Further information about this source-file:
  *      --> warp perspective of 3 external cameras to get a consistent view
+ *      --> optional intrinsics per camera, the undistortion is part of the
+ *          precomputed remap tables of the warp
 ******************************************************************************/
 
 
@@ -39,12 +41,17 @@
 #include <string>
 #include <opencv2/opencv.hpp>
 #include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
 #include "calibration.h"
 #include "image_proc.h"
 #include "Sobel.h"
 #include "dart_board.h"
 #include "globals.h"
 #include "cams.h"
+#include "rig.h"
+#include "Parallel.h"
 
 /****************************** namespaces ***********************************/
 using namespace cv;
@@ -60,6 +67,32 @@ using namespace std;
 #define RIGHT_CAM_CAL_TB  "Right Cam Calibration Trackbars"
 #define LEFT_CAM_CAL_TB  "Left Cam Calibration Trackbars"
 
+/* camera pose */
+#define CAL_POSE_RMS_MAX 3.0        // reprojection error of the landmarks [pixel], worse poses are not used
+
+/* warp */
+#define CAL_MAP_MARGIN 40           // pixels around the double outer ring kept by calibration_get_img()
+#define CAL_RAW_MASK_POINTS 72      // polygon of the board ROI in the raw image (calibration_raw_mask())
+
+/* intrinsics */
+#define CAL_CHESSBOARD_COLS 9       // inner corners of the chessboard
+#define CAL_CHESSBOARD_ROWS 6
+#define CAL_CHESSBOARD_SQUARE 25.0  // [mm]
+#define CAL_CHESSBOARD_VIEWS_MIN 5
+
+/* reference features, cached next to the reference image */
+#define CAL_SIFT_FEATURES 1000     // keypoints on the board, instead of 10000 on the whole frame
+#define CAL_GRID_COLS 4             // cells of the keypoint budget over the board
+#define CAL_GRID_ROWS 4
+#define CAL_MASK_CLOSE 25           // closes the red / green segments to one board region [pixel]
+#define CAL_MASK_AREA_MIN 5000      // smaller red / green regions are no board [pixel^2]
+#define CAL_FLANN_TREES 5           // 5 instead of Standard 4
+#define CAL_FLANN_CHECKS 32
+#define CAL_CACHE_FEATURES ".features.yml.gz"
+#define CAL_CACHE_INDEX ".flann"
+#define CAL_SIFT_TILES 1            // > 1 := SIFT detection of the live frames on horizontal tiles, one task per camera and tile
+#define CAL_SIFT_TILE_OVERLAP 32    // rows shared by neighbouring tiles (descriptor support) [pixel]
+
 
 /************************** local structure **********************************/
 
@@ -72,11 +105,13 @@ struct src_points_s {
     //Point2f center;
 };
 
-struct warps_h_s {
-    Mat H_top;
-    Mat H_right;
-    Mat H_left;
-
+/* reference features of a camera, key of the cache is the hash of the reference image */
+struct cal_ref_s {
+    bool valid = false;
+    std::string img;                // reference image of the features
+    vector<KeyPoint> keypoints;
+    Mat descriptors;
+    cv::flann::Index index;         // KD-tree over the descriptors
 };
 
 static struct cal_s {
@@ -93,8 +128,7 @@ static struct cal_s {
 
     int cal_win;    // window to be calibrated 
 
-
-    struct warps_h_s Homo;
+    struct cal_ref_s refs[RIG_CAMS_MAX];    // per camera of the rig
 
 
 }cal;
@@ -105,6 +139,14 @@ static struct cal_s {
 
 
 /************************** Function Declaration *****************************/
+static void calibration_build_maps(struct rig_cam_s* cam, cv::Size size);
+static int calibration_ref_features(int CamId);
+static std::string calibration_file_hash(const std::string& path);
+static void calibration_features(const cv::Mat& img, const cv::Mat& mask, std::vector<cv::KeyPoint>& keypoints, cv::Mat& descriptors);
+static void calibration_detect_tile(const cv::Mat& img, const cv::Mat& mask, int tile, int num_tiles, std::vector<cv::KeyPoint>& keypoints);
+static void calibration_describe(const cv::Mat& img, const cv::Mat& mask, std::vector<cv::KeyPoint>& keypoints, cv::Mat& descriptors);
+static void calibration_match_features(int CamId, const std::vector<cv::KeyPoint>& keypoints1, const cv::Mat& descriptors1);
+static void calibration_board_mask(cv::Mat& img, int CamId, cv::Mat& mask);
 
 
 
@@ -181,7 +223,8 @@ void calibration_init(void) {
 
     //p->dst_points.push_back(Point2f(420, 340)); // center
 
-
+    /* reference features of the rig from the cache */
+    calibration_ref_load();
 
 
 
@@ -221,48 +264,353 @@ void red_green_extract(cv::Mat& src, cv::Mat& dst) {
 
 
 /***
- * this function matches an input image with an reference image 
- * and stores the Homography H in module structure 
+ * this function loads (or creates) the reference features of all cameras,
+ * so the auto calibration featurizes the live frames only
+***/
+int calibration_ref_load(void) {
+
+    int status = EXIT_SUCCESS;
+    for (int i = 0; i < rig_num_cams(); i++) {
+        status |= calibration_ref_features(i);
+    }
+
+    return status;
+}
+
+
+
+/***
+ *
+ * calibration_ref_features(int CamId)
+ *
+ * Keypoints, descriptors and FLANN index of the reference image of a
+ * camera: from memory, from the cache next to the reference image
+ * (CAL_CACHE_FEATURES, CAL_CACHE_INDEX) or computed and cached
+ *
+ *
+ * @param:	int CamId --> camera of the rig
+ *
+ *
+ * @return: int status --> EXIT_FAILURE without reference image
+ *
+ *
+ * @note:	The cache is keyed by the hash of the reference image file and the
+ *          keypoint budget, a new reference image under the same name is
+ *          featurized again. Only the board of the reference image is used.
+ *
+ *
+ * Example usage: None
+ *
+***/
+static int calibration_ref_features(int CamId) {
+
+    struct rig_cam_s* cam = rig_cam(CamId);
+    if (cam == nullptr) {
+        return EXIT_FAILURE;
+    }
+
+    /* features of this reference image in memory */
+    struct cal_ref_s* ref = &cal.refs[CamId];
+    if (ref->valid && (ref->img == cam->ref_img)) {
+        return EXIT_SUCCESS;
+    }
+    ref->valid = false;
+    ref->img = cam->ref_img;
+
+    std::string hash = calibration_file_hash(cam->ref_img);
+    if (hash.empty()) {
+        std::cout << "[ERROR] " << cam->name << " Cam: no reference image (" << cam->ref_img << ")" << std::endl;
+        return EXIT_FAILURE;
+    }
+    hash += "-" + std::to_string(CAL_SIFT_FEATURES) + "-" + std::to_string(CAL_GRID_COLS) + "x" + std::to_string(CAL_GRID_ROWS);
+    std::string features_path = cam->ref_img + CAL_CACHE_FEATURES;
+    std::string index_path = cam->ref_img + CAL_CACHE_INDEX;
+
+    /* cache on disk */
+    FileStorage fs(features_path, FileStorage::READ);
+    if (fs.isOpened() && ((string)fs["hash"] == hash)) {
+        read(fs["keypoints"], ref->keypoints);
+        fs["descriptors"] >> ref->descriptors;
+        fs.release();
+        if (!ref->descriptors.empty() && ref->index.load(ref->descriptors, index_path)) {
+            ref->valid = true;
+            return EXIT_SUCCESS;
+        }
+    }
+    fs.release();
+
+    /***
+     * featurize the reference image once
+     * calibration is in maximum just as good as your reference images!
+    ***/
+    Mat img = imread(cam->ref_img, IMREAD_ANYCOLOR);
+    if (img.empty()) {
+        std::cout << "[ERROR] " << cam->name << " Cam: cannot read reference image " << cam->ref_img << std::endl;
+        return EXIT_FAILURE;
+    }
+    /* the reference board is known: double outer ring and the numbers */
+    Mat mask = Mat::zeros(img.size(), CV_8UC1);
+    circle(mask, Point(CAL_BOARD_CENTER_X, CAL_BOARD_CENTER_Y), 200 + CAL_MAP_MARGIN, Scalar(255), -1);
+    calibration_features(img, mask, ref->keypoints, ref->descriptors);
+    if (ref->descriptors.empty()) {
+        std::cout << "[ERROR] " << cam->name << " Cam: no features in the reference image" << std::endl;
+        return EXIT_FAILURE;
+    }
+    ref->index.build(ref->descriptors, cv::flann::KDTreeIndexParams(CAL_FLANN_TREES));
+    ref->valid = true;
+
+    /* cache, a read only directory only costs the featurization next start */
+    FileStorage out(features_path, FileStorage::WRITE);
+    if (out.isOpened()) {
+        out << "hash" << hash;
+        write(out, "keypoints", ref->keypoints);
+        out << "descriptors" << ref->descriptors;
+        out.release();
+        ref->index.save(index_path);
+    }
+    else {
+        std::cout << "[WARNING] cannot write feature cache " << features_path << std::endl;
+    }
+
+    return EXIT_SUCCESS;
+}
+
+/***
+ *
+ * calibration_features(const cv::Mat& img, const cv::Mat& mask, std::vector<cv::KeyPoint>& keypoints, cv::Mat& descriptors)
+ *
+ * SIFT keypoints and descriptors of the board: detection inside the mask,
+ * a budget of CAL_SIFT_FEATURES keypoints spread over a grid of
+ * CAL_GRID_COLS x CAL_GRID_ROWS cells on the board and descriptors of the
+ * kept keypoints only
+ *
+ *
+ * @param:	const cv::Mat& img --> frame or reference image
+ * @param:	const cv::Mat& mask --> board region (CV_8UC1), empty := whole frame
+ * @param:	std::vector<cv::KeyPoint>& keypoints --> return keypoints
+ * @param:	cv::Mat& descriptors --> return descriptors
+ *
+ *
+ * @return: void
+ *
+ *
+ * @note:	The strongest keypoints of every cell are kept, so the homography
+ *          is not fitted on a few textured spots only. The detection runs
+ *          on the whole image here, calibration_auto_cal_rig() detects the
+ *          tiles of all cameras in one parallel loop
+ *          (calibration_detect_tile()) and calls calibration_describe().
+ *
+ *
+ * Example usage: None
+ *
 ***/
-void calibration_match(cv::Mat img, cv::Mat ref, int CamId) {
+static void calibration_features(const cv::Mat& img, const cv::Mat& mask, std::vector<cv::KeyPoint>& keypoints, cv::Mat& descriptors) {
 
+    calibration_detect_tile(img, mask, 0, 1, keypoints);
+    calibration_describe(img, mask, keypoints, descriptors);
+}
+
+
+
+/***
+ * this function detects the SIFT keypoints of one of num_tiles horizontal
+ * tiles of an image; the tile overlaps its neighbours by CAL_SIFT_TILE_OVERLAP
+ * rows for the descriptor support and keeps the keypoints of its own rows
+***/
+static void calibration_detect_tile(const cv::Mat& img, const cv::Mat& mask, int tile, int num_tiles, std::vector<cv::KeyPoint>& keypoints) {
 
-    /* feature detector */
-    Ptr<SIFT> detector = cv::SIFT::create(10000);
     //Ptr<ORB> detector = cv::ORB::create(25000);  // ORB statt SIFT
+    Ptr<SIFT> detector = cv::SIFT::create();
 
-    vector<KeyPoint> keypoints1, keypoints2;
-    Mat descriptors1, descriptors2;
+    keypoints.clear();
+    if (num_tiles <= 1) {
+        detector->detect(img, keypoints, mask);
+        return;
+    }
+
+    /* tile with overlap, keypoints of the own rows only */
+    int begin = img.rows * tile / num_tiles;
+    int end = img.rows * (tile + 1) / num_tiles;
+    int top = std::max(0, begin - CAL_SIFT_TILE_OVERLAP);
+    int bottom = std::min(img.rows, end + CAL_SIFT_TILE_OVERLAP);
+    Rect roi(0, top, img.cols, bottom - top);
+
+    vector<KeyPoint> kps;
+    detector->detect(img(roi), kps, mask.empty() ? Mat() : mask(roi));
+    for (auto& kp : kps) {
+        kp.pt.y += top;
+        if ((kp.pt.y >= begin) && (kp.pt.y < end)) {
+            keypoints.push_back(kp);
+        }
+    }
+}
+
+
+
+/***
+ * this function keeps the strongest keypoints of every grid cell of the
+ * board (budget CAL_SIFT_FEATURES) and computes their descriptors
+***/
+static void calibration_describe(const cv::Mat& img, const cv::Mat& mask, std::vector<cv::KeyPoint>& keypoints, cv::Mat& descriptors) {
+
+    /* keypoint budget per cell of the board region */
+    Rect board = mask.empty() ? Rect(0, 0, img.cols, img.rows) : boundingRect(mask);
+    if (board.area() > 0) {
+        vector<vector<KeyPoint>> cells(CAL_GRID_COLS * CAL_GRID_ROWS);
+        for (const auto& kp : keypoints) {
+            int cx = std::min(CAL_GRID_COLS - 1, std::max(0, (int)((kp.pt.x - board.x) * CAL_GRID_COLS / board.width)));
+            int cy = std::min(CAL_GRID_ROWS - 1, std::max(0, (int)((kp.pt.y - board.y) * CAL_GRID_ROWS / board.height)));
+            cells[cy * CAL_GRID_COLS + cx].push_back(kp);
+        }
+        keypoints.clear();
+        for (auto& cell : cells) {
+            KeyPointsFilter::retainBest(cell, CAL_SIFT_FEATURES / (CAL_GRID_COLS * CAL_GRID_ROWS));
+            keypoints.insert(keypoints.end(), cell.begin(), cell.end());
+        }
+    }
+
+    /* descriptors of the kept keypoints */
+    descriptors.release();
+    if (!keypoints.empty()) {
+        Ptr<SIFT> detector = cv::SIFT::create();
+        detector->compute(img, keypoints, descriptors);
+    }
+}
+
+
+
+/***
+ * this function masks the board in a live frame: the red and green ring
+ * segments (red_green_extract()) closed to one region, else the board of
+ * the last calibration, else the whole frame (empty mask)
+***/
+static void calibration_board_mask(cv::Mat& img, int CamId, cv::Mat& mask) {
+
+    mask.release();
+
+    /* red and green segments of the double and triple rings */
+    Mat rg, rg_gray, rg_bin;
+    red_green_extract(img, rg);
+    cvtColor(rg, rg_gray, COLOR_BGR2GRAY);
+    threshold(rg_gray, rg_bin, 0, 255, THRESH_BINARY);
+    morphologyEx(rg_bin, rg_bin, MORPH_CLOSE, getStructuringElement(MORPH_ELLIPSE, Size(CAL_MASK_CLOSE, CAL_MASK_CLOSE)));
+
+    vector<vector<Point>> contours;
+    findContours(rg_bin, contours, RETR_EXTERNAL, CHAIN_APPROX_SIMPLE);
+    int best = -1;
+    double best_area = CAL_MASK_AREA_MIN;
+    for (int i = 0; i < (int)contours.size(); i++) {
+        double area = contourArea(contours[i]);
+        if (area > best_area) {
+            best_area = area;
+            best = i;
+        }
+    }
+    if (best >= 0) {
+        /* board region with the numbers around the double ring */
+        vector<Point> hull;
+        convexHull(contours[best], hull);
+        mask = Mat::zeros(img.size(), CV_8UC1);
+        fillConvexPoly(mask, hull, Scalar(255));
+        dilate(mask, mask, getStructuringElement(MORPH_ELLIPSE, Size(2 * CAL_MAP_MARGIN + 1, 2 * CAL_MAP_MARGIN + 1)));
+        return;
+    }
+
+    /* board of the last calibration */
+    if (calibration_raw_mask(CamId, img.size(), mask) != EXIT_SUCCESS) {
+        mask.release();
+    }
+}
+
+
+
+/* FNV-1a hash of a file as hex string, empty if the file cannot be read */
+static std::string calibration_file_hash(const std::string& path) {
+
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        return "";
+    }
+
+    uint64_t hash = 14695981039346656037ULL;
+    char buf[4096];
+    while (file.read(buf, sizeof(buf)) || (file.gcount() > 0)) {
+        for (std::streamsize i = 0; i < file.gcount(); i++) {
+            hash ^= (unsigned char)buf[i];
+            hash *= 1099511628211ULL;
+        }
+    }
+
+    char str[17];
+    snprintf(str, sizeof(str), "%016llx", (unsigned long long)hash);
+    return str;
+}
+
+
+
+/***
+ * this function matches an input image with the reference features of the
+ * camera (calibration_ref_features()) and stores the Homography H in the
+ * camera of the rig
+***/
+void calibration_match(cv::Mat img, int CamId) {
+
+    /* no live features without reference features */
+    if (calibration_ref_features(CamId) != EXIT_SUCCESS) {
+        return;
+    }
 
     /* feature extraction */
-    detector->detectAndCompute(img, Mat(), keypoints1, descriptors1);
-    detector->detectAndCompute(ref, Mat(), keypoints2, descriptors2);
+    vector<KeyPoint> keypoints1;
+    Mat descriptors1;
+    Mat board_mask;
+    calibration_board_mask(img, CamId, board_mask);
+    calibration_features(img, board_mask, keypoints1, descriptors1);
+    calibration_match_features(CamId, keypoints1, descriptors1);
+}
 
-    /* matcher with FLANN(Fast Library for Approximate Nearest Neighbors) */
-    FlannBasedMatcher matcher(cv::makePtr<cv::flann::KDTreeIndexParams>(5)); // 5 instead of Standard 4
-    //BFMatcher matcher(NORM_HAMMING);  // use NORM_HAMMING for ORB descriptors
 
-    /* onyl keep valid matches */
-    vector<DMatch> refined_matches;
-    vector<vector<DMatch>> knn_matches;
-    matcher.knnMatch(descriptors1, descriptors2, knn_matches, 2);
 
-    for (size_t i = 0; i < knn_matches.size(); i++) {
-        if (knn_matches[i][0].distance < 0.7 * knn_matches[i][1].distance) {
-            refined_matches.push_back(knn_matches[i][0]);
+/***
+ * this function matches the features of a live frame with the reference
+ * features of the camera and stores the Homography H in the camera of the rig
+***/
+static void calibration_match_features(int CamId, const std::vector<cv::KeyPoint>& keypoints1, const cv::Mat& descriptors1) {
+
+    /* reference keypoints, descriptors and FLANN index, only the live frame is featurized */
+    if (calibration_ref_features(CamId) != EXIT_SUCCESS) {
+        return;
+    }
+    struct cal_ref_s* ref = &cal.refs[CamId];
+
+    if (descriptors1.empty()) {
+        cerr << "no features in the frame!" << endl;
+        return;
+    }
+
+    /* FLANN(Fast Library for Approximate Nearest Neighbors) on the prebuilt KD-tree of the reference */
+    Mat indices, dists;
+    ref->index.knnSearch(descriptors1, indices, dists, 2, cv::flann::SearchParams(CAL_FLANN_CHECKS));
+
+    /* onyl keep valid matches, squared distances: 0.7^2 */
+    vector<Point2f> srcPoints, dstPoints;
+    for (int i = 0; i < indices.rows; i++) {
+        if (dists.at<float>(i, 0) < 0.49f * dists.at<float>(i, 1)) {
+            srcPoints.push_back(keypoints1[i].pt);
+            dstPoints.push_back(ref->keypoints[indices.at<int>(i, 0)].pt);
         }
     }
-    
+
     /* check if there enough matches; no actual error handling bc program wont work at all */
-    if (refined_matches.size() < 4) {
+    if (srcPoints.size() < 4) {
         cerr << "not enough matches!" << endl;
+        return;
     }
 
-    /* collect pairs for homography */
-    vector<Point2f> srcPoints, dstPoints;
-    for (size_t i = 0; i < refined_matches.size(); i++) {
-        srcPoints.push_back(keypoints1[refined_matches[i].queryIdx].pt);
-        dstPoints.push_back(keypoints2[refined_matches[i].trainIdx].pt);
+    /* lens distortion, the homography is on undistorted pixels */
+    struct rig_cam_s* cam = rig_cam(CamId);
+    if ((cam != nullptr) && cam->intrinsics && !srcPoints.empty()) {
+        undistortPoints(srcPoints, srcPoints, cam->K, cam->dist, noArray(), cam->K);
     }
 
     /* homography */
@@ -273,65 +621,247 @@ void calibration_match(cv::Mat img, cv::Mat ref, int CamId) {
         cerr << "homography could not be computed!" << endl;
     }
 
-    /* store H for warping */
-    switch (CamId) {
-    case TOP_CAM:
-        cal.Homo.H_top = H;
-        break;
-    case RIGHT_CAM:
-        cal.Homo.H_right = H;
-        break;
-    case LEFT_CAM:
-        cal.Homo.H_left = H;
-        break;
+    /* store H for warping, the remap tables are rebuilt on the next warp */
+    if (cam != nullptr) {
+        cam->H = H;
+        cam->map1.release();
+        cam->map2.release();
+    }
 
-    default: break;
+
+}
+
+
+
+/***
+ *
+ * calibration_pose(int CamId)
+ *
+ * Compute the pose of a camera on the board: intrinsics from the field of
+ * view and solvePnP on the board landmarks (twenty, six, three, eleven, the
+ * wires on the triple and double rings and the bull), which are found in the
+ * raw image through the inverse homography of the camera.
+ *
+ *
+ * @param:	int CamId --> camera of the rig, calibrated by calibration_match()
+ *
+ *
+ * @return: int status --> EXIT_FAILURE without homography or for a pose
+ *          which does not explain the landmarks
+ *
+ *
+ * @note:	Board coordinates are [mm] around the bull, x to the right and
+ *          y down as on the reference board, z = 0 is the board surface.
+ *          With calibrated intrinsics the landmarks are undistorted pixels
+ *          (see calibration_match()), so no distortion enters solvePnP.
+ *
+ *
+ * Example usage: None
+ *
+***/
+int calibration_pose(int CamId) {
+
+    struct rig_cam_s* cam = rig_cam(CamId);
+    if ((cam == nullptr) || cam->H.empty() || cam->cur.empty()) {
+        std::cout << "[ERROR] camera " << CamId << ": no homography for the pose" << std::endl;
+        return EXIT_FAILURE;
+    }
+    cam->pose_valid = false;
+
+    /* intrinsics without calibration: field of view, principal point in the image center */
+    if (!cam->intrinsics) {
+        double f = 0.5 * cam->cur.cols / tan(0.5 * cam->hfov * CV_PI / 180.0);
+        cam->K = Matx33d(f, 0, 0.5 * cam->cur.cols,
+                         0, f, 0.5 * cam->cur.rows,
+                         0, 0, 1);
+    }
+
+    /* landmarks on the reference board */
+    Point2f center(CAL_BOARD_CENTER_X, CAL_BOARD_CENTER_Y);
+    vector<Point2f> board_points;
+    board_points.push_back(center);                     // bull
+    board_points.push_back(Point2f(320, 40));           // 20
+    board_points.push_back(Point2f(520, 240));          // 6
+    board_points.push_back(Point2f(320, 440));          // 3
+    board_points.push_back(Point2f(120, 240));          // 11
+    const float radii[] = { 117, 129, 187, 200 };       // triple and double rings
+    for (int k = 0; k < 20; k++) {
+        double angle = (9 + 18 * k) * CV_PI / 180.0;    // wires between the 20 sectors
+        for (float radius : radii) {
+            board_points.push_back(center + Point2f((float)(radius * cos(angle)), (float)(-radius * sin(angle))));
+        }
     }
 
+    /* landmarks in the raw image, only inside the frame */
+    vector<Point2f> raw_points;
+    perspectiveTransform(board_points, raw_points, cam->H.inv());
+
+    vector<Point3f> object_points;
+    vector<Point2f> image_points;
+    Rect frame(0, 0, cam->cur.cols, cam->cur.rows);
+    for (size_t i = 0; i < raw_points.size(); i++) {
+        if (frame.contains(raw_points[i])) {
+            Point2f b = (board_points[i] - center) * CAL_MM_PER_PIXEL;
+            object_points.push_back(Point3f(b.x, b.y, 0));
+            image_points.push_back(raw_points[i]);
+        }
+    }
+    if (object_points.size() < 4) {
+        std::cout << "[ERROR] " << cam->name << " Cam: board not in the frame, no pose" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    /* planar pose */
+    Vec3d rvec;
+    if (!solvePnP(object_points, image_points, cam->K, Mat(), rvec, cam->t, false, SOLVEPNP_IPPE)) {
+        std::cout << "[ERROR] " << cam->name << " Cam: no pose" << std::endl;
+        return EXIT_FAILURE;
+    }
+    Rodrigues(rvec, cam->R);
+
+    /* a rigid camera has to explain the homography */
+    vector<Point2f> projected;
+    projectPoints(object_points, rvec, cam->t, cam->K, Mat(), projected);
+    double sum2 = 0;
+    for (size_t i = 0; i < projected.size(); i++) {
+        Point2f d = projected[i] - image_points[i];
+        sum2 += d.dot(d);
+    }
+    double rms = sqrt(sum2 / projected.size());
+
+    /* camera center in board coordinates: -R^T * t */
+    Vec3d c = cam->R.t() * cam->t * -1.0;
+    std::cout << "[INFO] " << cam->name << " Cam pose: center " << c << " mm, landmark rms " << rms << " pixel" << std::endl;
+    if (rms > CAL_POSE_RMS_MAX) {
+        std::cout << "[WARNING] " << cam->name << " Cam: pose does not fit the homography, check hfov of the camera" << std::endl;
+        return EXIT_FAILURE;
+    }
 
+    cam->pose_valid = true;
+    return EXIT_SUCCESS;
 }
 
 
 
-void calibration_auto_cal(cv::Mat& top, cv::Mat& right, cv::Mat& left) {
+/***
+ * this function calibrates every camera of the rig on its current frame
+ * against the reference image of the camera (calibration_auto_cal_rig()),
+ * the windows are shown afterwards by the caller thread
+***/
+void calibration_auto_cal(void) {
+
+    vector<Mat> warped;
+    calibration_auto_cal_rig(warped);
+
+    /* show calibration with sectors, highgui only from this thread */
+    for (int i = 0; i < (int)warped.size(); i++) {
+        if (!warped[i].empty()) {
+            imshow(rig_cam(i)->name + " Auto Warp", warped[i]);
+        }
+    }
 
+}
 
-    /* Debug */
-    //Mat img = imread(TOP_RAW_IMG_CAL, IMREAD_ANYCOLOR);
-    //Mat img = imread(RIGHT_RAW_IMG_CAL, IMREAD_ANYCOLOR);
-    // Mat img = imread(LEFT_RAW_IMG_CAL, IMREAD_ANYCOLOR);
 
 
+/***
+ *
+ * calibration_auto_cal_rig(std::vector<cv::Mat>& warped)
+ *
+ * Homography, pose and verification warp of every camera of the rig on its
+ * current frame, the cameras are independent and run in parallel
+ *
+ *
+ * @param:	std::vector<cv::Mat>& warped --> return warped frame with sectors per camera, empty := not calibrated
+ *
+ *
+ * @return: int --> number of calibrated cameras
+ *
+ *
+ * @note:	OpenCV runs a nested parallel_for_ serially, so the work is one
+ *          flat parallel loop per stage: board masks per camera, SIFT
+ *          detection per camera and tile (CAL_SIFT_TILES), then descriptors,
+ *          matching, pose and warp per camera. The reference features are
+ *          loaded before, cameras may share a reference image and its cache
+ *          file. No highgui calls, see calibration_auto_cal().
+ *
+ *
+ * Example usage: None
+ *
+***/
+int calibration_auto_cal_rig(std::vector<cv::Mat>& warped) {
+
+    int num = rig_num_cams();
+    warped.assign(num, Mat());
+
     /***
-     * load reference images 
-     * calibration is in maximum just as good as your reference images! 
+     * reference features are cached (calibration_ref_features())
+     * calibration is in maximum just as good as your reference images!
     ***/
-    Mat top_ref = imread(TOP_REF, IMREAD_ANYCOLOR); 
-    //Mat top_ref = imread("images/ref/General_Ref.jpg", IMREAD_ANYCOLOR); // does not work atm
-    Mat right_ref = imread(RIGHT_REF, IMREAD_ANYCOLOR); 
-    Mat left_ref = imread(LEFT_REF, IMREAD_ANYCOLOR); 
-   
-    /* matching */
-    calibration_match(top, top_ref, TOP_CAM);
-    calibration_match(right, right_ref, RIGHT_CAM);
-    calibration_match(left, left_ref, LEFT_CAM);
-
-    /* warp images with new Homography matrix */
-    Mat w_top, w_right, w_left;
-    warpPerspective(top, w_top, cal.Homo.H_top, top_ref.size(), INTER_CUBIC, BORDER_REFLECT);
-    warpPerspective(right, w_right, cal.Homo.H_right, right_ref.size(), INTER_CUBIC, BORDER_REFLECT);
-    warpPerspective(left, w_left, cal.Homo.H_left, left_ref.size(), INTER_CUBIC, BORDER_REFLECT);
-
-    /* draw sectors to verify your calibration */
-    dart_board_draw_sectors(w_top, TOP_CAM, 0, 0);
-    dart_board_draw_sectors(w_right, RIGHT_CAM, 0, 0);
-    dart_board_draw_sectors(w_left, LEFT_CAM, 0, 0);
-
-    /* show calibration with sectors */
-    imshow("Top Auto Warp", w_top);
-    imshow("Right Auto Warp", w_right);
-    imshow("Left Auto Warp", w_left);
+    calibration_ref_load();
+
+    /* board masks of the live frames */
+    vector<Mat> masks(num);
+    ip::parallelForStripes(num, num, [&](int begin, int end, int s) {
+        for (int i = begin; i < end; i++) {
+            struct rig_cam_s* cam = rig_cam(i);
+            if (!cam->cur.empty()) {
+                calibration_board_mask(cam->cur, cam->id, masks[i]);
+            }
+        }
+    });
+
+    /* SIFT detection, one task per camera and tile */
+    int tasks = num * CAL_SIFT_TILES;
+    vector<vector<KeyPoint>> tile_keypoints(tasks);
+    ip::parallelForStripes(tasks, tasks, [&](int begin, int end, int s) {
+        for (int k = begin; k < end; k++) {
+            struct rig_cam_s* cam = rig_cam(k / CAL_SIFT_TILES);
+            if (!cam->cur.empty()) {
+                calibration_detect_tile(cam->cur, masks[k / CAL_SIFT_TILES], k % CAL_SIFT_TILES, CAL_SIFT_TILES, tile_keypoints[k]);
+            }
+        }
+    });
+
+    /* descriptors, matching, pose and verification warp per camera */
+    ip::parallelForStripes(num, num, [&](int begin, int end, int s) {
+        for (int i = begin; i < end; i++) {
+            struct rig_cam_s* cam = rig_cam(i);
+            if (cam->cur.empty()) {
+                std::cout << "[ERROR] " << cam->name << " Cam: no frame for the calibration" << std::endl;
+                continue;
+            }
+
+            /* matching */
+            vector<KeyPoint> keypoints;
+            for (int t = 0; t < CAL_SIFT_TILES; t++) {
+                const vector<KeyPoint>& kps = tile_keypoints[i * CAL_SIFT_TILES + t];
+                keypoints.insert(keypoints.end(), kps.begin(), kps.end());
+            }
+            Mat descriptors;
+            calibration_describe(cam->cur, masks[i], keypoints, descriptors);
+            calibration_match_features(cam->id, keypoints, descriptors);
+            if (cam->H.empty()) {
+                continue;
+            }
+
+            /* pose on the board for the metric cross point */
+            calibration_pose(cam->id);
+
+            /* warp image with new Homography matrix (and the undistortion of the camera) */
+            calibration_get_img(cam->cur, warped[i], cam->id);
+
+            /* draw sectors to verify your calibration */
+            dart_board_draw_sectors(warped[i], cam->id, 0, 0);
+        }
+    });
+
+    int calibrated = 0;
+    for (const auto& w : warped) {
+        calibrated += !w.empty();
+    }
 
+    return calibrated;
 }
 
 
@@ -946,31 +1476,276 @@ void calibration_get_img(cv::Mat& src, cv::Mat& dst, int ThreadId) {
 
 #endif 
 
-    if (ThreadId == TOP_CAM) {
-        /*tranform top*/
-        //Mat transform_matrix_top = getPerspectiveTransform(src_points_top, dst_points);
-        //Mat H = findHomography(src_points_top, dst_points, RANSAC);
-        //warpPerspective(src, dst, H, src.size());       
-        warpPerspective(src, dst, cal.Homo.H_top, src.size());
-    }
-    else if (ThreadId == LEFT_CAM) {
-        /*transform left*/
-        //Mat transform_matrix_left = getPerspectiveTransform(src_points_left, dst_points);
-        //Mat H = findHomography(src_points_left, dst_points, RANSAC);
-        //warpPerspective(src, dst, H, src.size());
-        warpPerspective(src, dst, cal.Homo.H_left, src.size());
-    }
-    else if (ThreadId == RIGHT_CAM) {
-        /*transform right*/
-        //Mat transform_matrix_right = getPerspectiveTransform(src_points_right, dst_points);
-        //Mat H = findHomography(src_points_right, dst_points, RANSAC);
-        //warpPerspective(src, dst, H, src.size());
-        warpPerspective(src, dst, cal.Homo.H_right, src.size());
+    /* transform with the homography of the camera */
+    struct rig_cam_s* cam = rig_cam(ThreadId);
+    if ((cam != nullptr) && !cam->H.empty()) {
+        //Mat H = findHomography(src_points, dst_points, RANSAC);
+        //warpPerspective(src, dst, cam->H, src.size());
+
+        /* precomputed tables instead of the projective division per pixel */
+        if (cam->map1.empty() || (cam->map_size != src.size())) {
+            calibration_build_maps(cam, src.size());
+        }
+
+        /***
+         * only the board is warped, the rest stays black as with warpPerspective();
+         * remap straight into the board ROI of dst, callers passing the same Mat
+         * as src and dst go through the scratch buffer of the camera
+        ***/
+        if (src.data != dst.data) {
+            dst.create(src.size(), src.type());
+            Mat dst_board = dst(cam->map_roi);
+            remap(src, dst_board, cam->map1, cam->map2, INTER_LINEAR, BORDER_CONSTANT);
+        }
+        else {
+            remap(src, cam->warp_board, cam->map1, cam->map2, INTER_LINEAR, BORDER_CONSTANT);
+            Mat dst_board = dst(cam->map_roi);
+            cam->warp_board.copyTo(dst_board);
+        }
+
+        /* black outside the board ROI */
+        const Rect& roi = cam->map_roi;
+        dst(Rect(0, 0, dst.cols, roi.y)).setTo(Scalar(0, 0, 0));
+        dst(Rect(0, roi.y + roi.height, dst.cols, dst.rows - roi.y - roi.height)).setTo(Scalar(0, 0, 0));
+        dst(Rect(0, roi.y, roi.x, roi.height)).setTo(Scalar(0, 0, 0));
+        dst(Rect(roi.x + roi.width, roi.y, dst.cols - roi.x - roi.width, roi.height)).setTo(Scalar(0, 0, 0));
     }
     else {
-        printf("error: unknown theradid");
+        printf("error: unknown theradid or camera not calibrated");
+    }
+
+}
+
+
+
+/***
+ * this function returns the board ROI of calibration_get_img() in the raw
+ * image of a camera (255 := board), the native mode restricts its edges to
+ * it; the mask is built with the remap tables and shared, do not modify it
+***/
+int calibration_raw_mask(int CamId, cv::Size size, cv::Mat& mask) {
+
+    struct rig_cam_s* cam = rig_cam(CamId);
+    if ((cam == nullptr) || cam->H.empty()) {
+        return EXIT_FAILURE;
+    }
+
+    if (cam->map1.empty() || (cam->map_size != size)) {
+        calibration_build_maps(cam, size);
+    }
+    mask = cam->raw_mask;
+
+    return EXIT_SUCCESS;
+}
+
+
+
+/***
+ * this function precomputes the warp of a camera: for every pixel of the
+ * board ROI the raw image position H^-1 * p, converted to the fixed point
+ * tables of remap() (CV_16SC2 + interpolation table) and the board ROI in
+ * the raw image
+***/
+static void calibration_build_maps(struct rig_cam_s* cam, cv::Size size) {
+
+    /* double outer ring and the numbers around it */
+    int radius = cvRound(200 + CAL_MAP_MARGIN);
+    Rect board(CAL_BOARD_CENTER_X - radius, CAL_BOARD_CENTER_Y - radius, 2 * radius, 2 * radius);
+    cam->map_roi = board & Rect(0, 0, size.width, size.height);
+    cam->map_size = size;
+
+    Mat H_inv_mat = cam->H.inv();
+    Matx33d H_inv = H_inv_mat;
+    Mat map_x(cam->map_roi.size(), CV_32FC1);
+    Mat map_y(cam->map_roi.size(), CV_32FC1);
+    for (int y = 0; y < cam->map_roi.height; y++) {
+        float* mx = map_x.ptr<float>(y);
+        float* my = map_y.ptr<float>(y);
+        double v = y + cam->map_roi.y;
+        for (int x = 0; x < cam->map_roi.width; x++) {
+            double u = x + cam->map_roi.x;
+            double w = H_inv(2, 0) * u + H_inv(2, 1) * v + H_inv(2, 2);
+            w = (w != 0) ? 1.0 / w : 0;
+            mx[x] = (float)((H_inv(0, 0) * u + H_inv(0, 1) * v + H_inv(0, 2)) * w);
+            my[x] = (float)((H_inv(1, 0) * u + H_inv(1, 1) * v + H_inv(1, 2)) * w);
+        }
+    }
+
+    /* lens distortion: undistorted pixel --> normalized camera coordinates --> raw pixel */
+    if (cam->intrinsics && !cam->dist.empty()) {
+        Matx33d K_inv = cam->K.inv();
+        vector<Point3f> rays(cam->map_roi.width);
+        vector<Point2f> raw;
+        for (int y = 0; y < cam->map_roi.height; y++) {
+            float* mx = map_x.ptr<float>(y);
+            float* my = map_y.ptr<float>(y);
+            for (int x = 0; x < cam->map_roi.width; x++) {
+                Vec3d ray = K_inv * Vec3d(mx[x], my[x], 1.0);
+                rays[x] = Point3f((float)ray[0], (float)ray[1], 1.0f);
+            }
+            projectPoints(rays, Vec3d(0, 0, 0), Vec3d(0, 0, 0), cam->K, cam->dist, raw);
+            for (int x = 0; x < cam->map_roi.width; x++) {
+                mx[x] = raw[x].x;
+                my[x] = raw[x].y;
+            }
+        }
+    }
+
+    convertMaps(map_x, map_y, cam->map1, cam->map2, CV_16SC2);
+
+    /* ring of the board ROI in the raw image, same mapping as the tables */
+    vector<Point2f> ring, raw;
+    for (int k = 0; k < CAL_RAW_MASK_POINTS; k++) {
+        double angle = k * 2 * CV_PI / CAL_RAW_MASK_POINTS;
+        ring.push_back(Point2f((float)(CAL_BOARD_CENTER_X + radius * cos(angle)), (float)(CAL_BOARD_CENTER_Y + radius * sin(angle))));
+    }
+    perspectiveTransform(ring, raw, H_inv_mat);
+    if (cam->intrinsics && !cam->dist.empty()) {
+        Matx33d K_inv = cam->K.inv();
+        vector<Point3f> rays;
+        for (const auto& p : raw) {
+            Vec3d ray = K_inv * Vec3d(p.x, p.y, 1.0);
+            rays.push_back(Point3f((float)ray[0], (float)ray[1], 1.0f));
+        }
+        projectPoints(rays, Vec3d(0, 0, 0), Vec3d(0, 0, 0), cam->K, cam->dist, raw);
+    }
+    vector<vector<Point>> poly(1);
+    for (const auto& p : raw) {
+        poly[0].push_back(Point(cvRound(p.x), cvRound(p.y)));
     }
+    cam->raw_mask = Mat::zeros(size, CV_8UC1);
+    fillPoly(cam->raw_mask, poly, Scalar(255));
+}
+
+
+
+/***
+ *
+ * calibration_intrinsics(int CamId, const std::vector<cv::Mat>& views)
+ *
+ * Calibrate the camera matrix and the lens distortion of a camera from
+ * views of a chessboard (CAL_CHESSBOARD_COLS x CAL_CHESSBOARD_ROWS inner
+ * corners, CAL_CHESSBOARD_SQUARE mm)
+ *
+ *
+ * @param:	int CamId --> camera of the rig
+ * @param:	const std::vector<cv::Mat>& views --> frames of the camera, the chessboard in different positions
+ *
+ *
+ * @return: int status --> EXIT_FAILURE with less than CAL_CHESSBOARD_VIEWS_MIN usable views
+ *
+ *
+ * @note:	The homography of the camera is dropped, run the auto calibration
+ *          again; from then on the undistortion is part of the remap tables
+ *          of calibration_get_img(), the cost per frame does not change.
+ *
+ *
+ * Example usage: None
+ *
+***/
+int calibration_intrinsics(int CamId, const std::vector<cv::Mat>& views) {
+
+    struct rig_cam_s* cam = rig_cam(CamId);
+    if ((cam == nullptr) || views.empty()) {
+        std::cout << "[ERROR] camera " << CamId << ": no views for the intrinsics" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    /* chessboard corners on the board plane */
+    Size pattern(CAL_CHESSBOARD_COLS, CAL_CHESSBOARD_ROWS);
+    vector<Point3f> board;
+    for (int y = 0; y < pattern.height; y++) {
+        for (int x = 0; x < pattern.width; x++) {
+            board.push_back(Point3f((float)(x * CAL_CHESSBOARD_SQUARE), (float)(y * CAL_CHESSBOARD_SQUARE), 0));
+        }
+    }
+
+    vector<vector<Point3f>> object_points;
+    vector<vector<Point2f>> image_points;
+    for (const auto& view : views) {
+        Mat gray;
+        cvtColor(view, gray, COLOR_BGR2GRAY);
+        vector<Point2f> corners;
+        if (!findChessboardCorners(gray, pattern, corners, CALIB_CB_ADAPTIVE_THRESH | CALIB_CB_NORMALIZE_IMAGE)) {
+            continue;
+        }
+        cornerSubPix(gray, corners, Size(11, 11), Size(-1, -1), TermCriteria(TermCriteria::EPS | TermCriteria::COUNT, 30, 0.01));
+        object_points.push_back(board);
+        image_points.push_back(corners);
+    }
+    if (object_points.size() < CAL_CHESSBOARD_VIEWS_MIN) {
+        std::cout << "[ERROR] " << cam->name << " Cam: chessboard found in " << object_points.size() << " views, "
+            << CAL_CHESSBOARD_VIEWS_MIN << " needed" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    /* webcam lenses: radial k1, k2 and tangential distortion */
+    Mat K, dist;
+    vector<Mat> rvecs, tvecs;
+    double rms = calibrateCamera(object_points, image_points, views[0].size(), K, dist, rvecs, tvecs, CALIB_FIX_K3);
+    std::cout << "[INFO] " << cam->name << " Cam intrinsics: " << object_points.size() << " views, rms " << rms << " pixel" << std::endl;
+
+    cam->K = Matx33d(K);
+    cam->dist = dist;
+    cam->intrinsics = true;
+
+    /* homography of the distorted pixels is void */
+    cam->H.release();
+    cam->map1.release();
+    cam->map2.release();
+    cam->pose_valid = false;
+
+    return EXIT_SUCCESS;
+}
+
+/* store the intrinsics of a camera for the "intrinsics" entry of RIG_CONFIG */
+int calibration_intrinsics_save(int CamId, const std::string& path) {
+
+    struct rig_cam_s* cam = rig_cam(CamId);
+    if ((cam == nullptr) || !cam->intrinsics) {
+        std::cout << "[ERROR] camera " << CamId << ": no intrinsics to save" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    FileStorage fs(path, FileStorage::WRITE);
+    if (!fs.isOpened()) {
+        std::cout << "[ERROR] cannot write " << path << std::endl;
+        return EXIT_FAILURE;
+    }
+    fs << "camera_matrix" << Mat(cam->K);
+    fs << "distortion_coefficients" << cam->dist;
+
+    return EXIT_SUCCESS;
+}
+
+/* load the intrinsics of a camera (camera_matrix, distortion_coefficients) */
+int calibration_intrinsics_load(int CamId, const std::string& path) {
+
+    struct rig_cam_s* cam = rig_cam(CamId);
+    FileStorage fs(path, FileStorage::READ);
+    if ((cam == nullptr) || !fs.isOpened()) {
+        std::cout << "[ERROR] cannot read intrinsics " << path << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    Mat K, dist;
+    fs["camera_matrix"] >> K;
+    fs["distortion_coefficients"] >> dist;
+    if ((K.rows != 3) || (K.cols != 3)) {
+        std::cout << "[ERROR] " << path << ": no camera_matrix" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    K.convertTo(K, CV_64F);
+    cam->K = Matx33d(K);
+    cam->dist = dist;
+    cam->intrinsics = true;
+    cam->H.release();
+    cam->map1.release();
+    cam->map2.release();
+    cam->pose_valid = false;
 
+    return EXIT_SUCCESS;
 }
 
 
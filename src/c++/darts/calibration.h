@@ -35,14 +35,30 @@
 
 
 #include <opencv2/opencv.hpp>
+#include <string>
+#include <vector>
+
+
+/*************************** global Defines **********************************/
+/* reference board (warped image): double outer ring (170 mm) at 200 pixel around the center */
+#define CAL_BOARD_CENTER_X 320
+#define CAL_BOARD_CENTER_Y 240
+#define CAL_MM_PER_PIXEL (170.0 / 200.0)
+
 
 /************************** Function Declaration *****************************/
 
 extern void calibration_init(void);
 
 
-extern void calibration_match(cv::Mat img, cv::Mat ref, int CamId);
-extern void calibration_auto_cal(cv::Mat& top, cv::Mat& right, cv::Mat& left);
+extern int calibration_ref_load(void);
+extern void calibration_match(cv::Mat img, int CamId);
+extern int calibration_pose(int CamId);
+extern int calibration_intrinsics(int CamId, const std::vector<cv::Mat>& views);
+extern int calibration_intrinsics_save(int CamId, const std::string& path);
+extern int calibration_intrinsics_load(int CamId, const std::string& path);
+extern void calibration_auto_cal(void);
+extern int calibration_auto_cal_rig(std::vector<cv::Mat>& warped);
 extern void calibration_ref_create(void);
 
 extern void calibration_cal_src_points(cv::Mat& top, cv::Mat& right, cv::Mat& left);
@@ -52,6 +68,7 @@ extern void calibration_src_points_update(void);
 extern void calibration_get_img(void);
 
 extern void calibration_get_img(cv::Mat& src, cv::Mat& dst, int ThreadId);
+extern int calibration_raw_mask(int CamId, cv::Size size, cv::Mat& mask);
 
 
 extern void on_trackbar_twenty_x(int val, void* arg);
@@ -46,6 +46,7 @@
 #include "dart_board.h"
 #include "globals.h"
 #include "cams.h"
+#include "rig.h"
 
 /****************************** namespaces ***********************************/
 using namespace cv;
@@ -65,6 +66,16 @@ using namespace std;
 #define RAW_CAL_IMG_WIDTH 640       
 #define RAW_CAL_IMG_HEIGHT 480
 
+/* intrinsics calibration, see cams_calibrate_intrinsics() */
+#define INTRINSICS_VIEW_MS 2000     // time to move the chessboard between two views
+#define INTRINSICS_CLEAR_MS 5000    // time to remove the chessboard before the auto calibration
+#define INTRINSICS_FILE "_intrinsics.yml"  // file of a camera: name + INTRINSICS_FILE
+
+/* simulation */
+#define SIM_CAMS 3                  // cameras with simulation images
+#define SIM_LAST_DARTS 2            // darts in the last frames [0..3]
+#define SIM_CUR_DARTS 3             // darts in the current frames [0..3]
+
 
 
 
@@ -74,12 +85,11 @@ using namespace std;
 ***/
 /* flags */
 struct flags_s {
-    int diff_flag_top = 0;
-    int diff_flag_right = 0;
-    int diff_flag_left = 0;
     int diff_flag_raw = 0;
     int pause = 0;
     int auto_cal = 0;
+    int intrinsics_views = 0;       // chessboard views to capture, 0 := no intrinsics calibration
+    int intrinsics_cam = -1;        // camera of the rig, -1 := all cameras
 };
 
 
@@ -95,13 +105,10 @@ struct darts_s {
     int count_throws = 0;
 
     /* dart position */
-    struct tripple_line_s t_line;
+    struct cross_point_s cross;
     cv::Point cross_point;
 
-    /* results */
-    struct result_s r_top;
-    struct result_s r_right;
-    struct result_s r_left;
+    /* result of the fused cross point */
     struct result_s r_final;
 
 };
@@ -109,9 +116,19 @@ struct darts_s {
 static struct darts_s darts;
 
 /************************* local Variables ***********************************/
+/* simulation images of the default rig (TOP_CAM, RIGHT_CAM, LEFT_CAM): raw board, 1, 2 and 3 darts */
+static const char* sim_imgs[SIM_CAMS][4] = {
+    { TOP_RAW_IMG_CAL, TOP_1DARTS, TOP_2DARTS, TOP_3DARTS },
+    { RIGHT_RAW_IMG_CAL, RIGHT_1DARTS, RIGHT_2DARTS, RIGHT_3DARTS },
+    { LEFT_RAW_IMG_CAL, LEFT_1DARTS, LEFT_2DARTS, LEFT_3DARTS },
+};
 
 
 /************************** Function Declaration *****************************/
+static int cams_diff_check(void);
+static void cams_clear_diff_flags(void);
+static void cams_detect_dart(struct darts_s* xp);
+static void cams_calibrate_intrinsics(int CamId, int num_views);
 
 
 /******************************* CAM THREADS **********************************/
@@ -119,9 +136,9 @@ static struct darts_s darts;
  * 
  * camsThread(void* arg) 
  *
- * This Thread opens up the cameras and calls image processing as well as 
- * the Darts-Score computation. Also counts the throws and checks if Darts are
- * removed from Dartboard after 3 throws.
+ * This Thread opens up the cameras of the rig and calls image processing as
+ * well as the Darts-Score computation. Also counts the throws and checks if
+ * Darts are removed from Dartboard after 3 throws.
  * 
  *
  * 
@@ -132,7 +149,7 @@ static struct darts_s darts;
  * @return: void
  *
  * 
- * @note:	None
+ * @note:	The first camera of the rig watches the board for removed darts.
  * 
  * 
  * Example usage: None 
@@ -149,85 +166,45 @@ void camsThread(void* arg) {
     /* init image cal values */
     calibration_init();     // actually uneccessary atm
 
-    /* cur = curent frames; last = last frames */
-    Mat cur_frame_top, cur_frame_right, cur_frame_left;
-    Mat last_frame_top, last_frame_right, last_frame_left;
-    /* raw empty init board (just top view) */
+    /* raw empty init board (just first camera) */
     Mat raw_empty_init_frame;
-    /* calm cams down in beginning, check diff with these frames */
-    Mat f_top, f_right, f_left;
+    struct rig_cam_s* board_cam = rig_cam(0);
 
-    /* open top camera */
-    VideoCapture top_cam(TOP_CAM, CAP_ANY);
-    if (!top_cam.isOpened()) {
-        std::cout << "[ERROR] cannot open TOP Camera" << endl;
-        return;
-    }
-    /* open right camera */
-    VideoCapture right_cam(RIGHT_CAM, CAP_ANY);
-    if (!right_cam.isOpened()) {
-        std::cout << "[ERROR] cannot open RIGHT Camera" << endl;
-        return;
-    }
-    /* open left camera */
-    VideoCapture left_cam(LEFT_CAM, CAP_ANY);
-    if (!left_cam.isOpened()) {
-        std::cout << "[ERROR] cannot open LEFT Camera" << endl;
+    /* open cameras, the camera windows are named by the rig */
+    if ((board_cam == nullptr) || (rig_open() != EXIT_SUCCESS)) {
         return;
     }
 
-    /* create camera windows */
-    ostringstream CamName1;
-    CamName1 << "Top Cam [press Esc to quit]";
-    string top_cam_win = CamName1.str();
-    ostringstream CamName2;
-    CamName2 << "Right Cam [press Esc to quit]";
-    string right_cam_win = CamName2.str();
-    ostringstream CamName3;
-    CamName3 << "Left Cam [press Esc to quit]";
-    string left_cam_win = CamName3.str();
-
     /* short delay */
     this_thread::sleep_for(chrono::milliseconds(2000));
 
 #if CALIBRATION
     /* calibration */
     /* init last frames */
-    top_cam >> last_frame_top;
-    right_cam >> last_frame_right;
-    left_cam >> last_frame_left;
-    if (last_frame_top.empty() || last_frame_right.empty() || last_frame_left.empty()) {
-        std::cout << "Error: empty init frame 1\n" << last_frame_top.empty() << last_frame_right.empty() << last_frame_left.empty() << endl;
+    if (rig_grab() != EXIT_SUCCESS) {
+        std::cout << "Error: empty init frame 1" << endl;
         return;
     }
     /* show frames */
-    imshow(top_cam_win, last_frame_top);
-    imshow(right_cam_win, last_frame_right);
-    imshow(left_cam_win, last_frame_left);
+    rig_show();
+    rig_update_last();
     /**/
     std::cout << "throw a dart in the board --> then press 'c' to calibrate thresholds" << endl;
     while ((waitKey(10) != 'c') && running) {
-        top_cam >> cur_frame_top;
-        right_cam >> cur_frame_right;
-        left_cam >> cur_frame_left;
+        rig_grab();
         /* show frames */
-        imshow(top_cam_win, cur_frame_top);
-        imshow(right_cam_win, cur_frame_right);
-        imshow(left_cam_win, cur_frame_left);
+        rig_show();
         this_thread::sleep_for(chrono::milliseconds(100));
     }
-    img_proc_calibration(last_frame_top, last_frame_right, last_frame_left, cur_frame_top, cur_frame_right, cur_frame_left);
+    img_proc_calibration();
     std::cout << "calibration done" << endl;
 #endif
 
     this_thread::sleep_for(chrono::milliseconds(500));
 
     /* init last frames */
-    top_cam >> last_frame_top;
-    right_cam >> last_frame_right;
-    left_cam >> last_frame_left;
-    if (last_frame_top.empty() || last_frame_right.empty() || last_frame_left.empty()) {
-        std::cout << "Error: empty init frame 1\n" << last_frame_top.empty() << last_frame_right.empty() << last_frame_left.empty() << endl;
+    if (rig_grab() != EXIT_SUCCESS) {
+        std::cout << "Error: empty init frame 1" << endl;
         return;
     }
 
@@ -235,22 +212,18 @@ void camsThread(void* arg) {
 
 
     /* init last frames */
-    top_cam >> last_frame_top;
-    right_cam >> last_frame_right;
-    left_cam >> last_frame_left;
-    if (last_frame_top.empty() || last_frame_right.empty() || last_frame_left.empty()) {
-        std::cout << "Error: empty init frame 2\n" << last_frame_top.empty() << last_frame_right.empty() << last_frame_left.empty() << endl;
+    if (rig_grab() != EXIT_SUCCESS) {
+        std::cout << "Error: empty init frame 2" << endl;
         return;
     }
+    rig_update_last();
     /* init frame */
-    raw_empty_init_frame = last_frame_top.clone();
+    raw_empty_init_frame = board_cam->last.clone();
 
 
     /* calibration */
-    top_cam >> cur_frame_top;
-    right_cam >> cur_frame_right;
-    left_cam >> cur_frame_left;
-    calibration_auto_cal(cur_frame_top, cur_frame_right, cur_frame_left);
+    rig_grab();
+    calibration_auto_cal();
 
 
     /* loop */
@@ -261,43 +234,33 @@ void camsThread(void* arg) {
             break;
         }
 
-        /* get current frames from cams */
-        top_cam >> cur_frame_top;
-        right_cam >> cur_frame_right;
-        left_cam >> cur_frame_left;
-
-        /* check if frames are not empty */
-        if (!cur_frame_top.empty() && !cur_frame_right.empty() && !cur_frame_left.empty()) {
+        /* get current frames from cams and check if frames are not empty */
+        if (rig_grab() == EXIT_SUCCESS) {
 
             /* show frames */
-            imshow(top_cam_win, cur_frame_top);
-            imshow(right_cam_win, cur_frame_right);
-            imshow(left_cam_win, cur_frame_left);
+            rig_show();
 
             
             /* event handling */
             if (xp->flags.auto_cal) {
                 /* calibration */
-                top_cam >> cur_frame_top;
-                right_cam >> cur_frame_right;
-                left_cam >> cur_frame_left;
-                calibration_auto_cal(cur_frame_top, cur_frame_right, cur_frame_left);
+                rig_grab();
+                calibration_auto_cal();
                 /* clear flag */
                 xp->flags.auto_cal = 0;
             }
+            if (xp->flags.intrinsics_views > 0) {
+                /* chessboard views, intrinsics and new auto calibration */
+                cams_calibrate_intrinsics(xp->flags.intrinsics_cam, xp->flags.intrinsics_views);
+                /* clear flag */
+                xp->flags.intrinsics_views = 0;
+            }
 
 
-            /* check f there are any differences */
-            xp->flags.diff_flag_top = img_proc_diff_check(last_frame_top, cur_frame_top, TOP_CAM);
-            xp->flags.diff_flag_right = img_proc_diff_check(last_frame_right, cur_frame_right, RIGHT_CAM);
-            xp->flags.diff_flag_left = img_proc_diff_check(last_frame_left, cur_frame_left, LEFT_CAM);
-
-            /* check detected difference && expecting throws (count_throws < 3) */
-            if ((xp->flags.diff_flag_top || xp->flags.diff_flag_right || xp->flags.diff_flag_left) && (xp->count_throws < 3) && !xp->flags.pause) {
+            /* check if there are any differences && expecting throws (count_throws < 3) */
+            if (cams_diff_check() && (xp->count_throws < 3) && !xp->flags.pause) {
                 /* clear flags */
-                xp->flags.diff_flag_top = 0;
-                xp->flags.diff_flag_top = 0;
-                xp->flags.diff_flag_top = 0;
+                cams_clear_diff_flags();
 
                 /* count throws */
                 xp->count_throws++;
@@ -306,32 +269,10 @@ void camsThread(void* arg) {
                 this_thread::sleep_for(chrono::milliseconds(300));
 
                 /* get even newer frames, with darts which are definetly in the board */
-                top_cam >> cur_frame_top;
-                right_cam >> cur_frame_right;
-                left_cam >> cur_frame_left;
-
-                /* get lne polar coordinates */
-                img_proc_get_line(last_frame_top, cur_frame_top, TOP_CAM, &xp->t_line.line_top, SHOW_SHORT_ANALYSIS , "Top"); //SHOW_SHORT_ANALYSIS
-                img_proc_get_line(last_frame_right, cur_frame_right, RIGHT_CAM, &xp->t_line.line_right, SHOW_SHORT_ANALYSIS, "Right");
-                img_proc_get_line(last_frame_left, cur_frame_left, LEFT_CAM, &xp->t_line.line_left, SHOW_SHORT_ANALYSIS, "Left");
+                rig_grab();
 
-                /* calculate cross point */
-                //img_proc_cross_point(Size(RAW_CAL_IMG_WIDTH, RAW_CAL_IMG_HEIGHT), &xp->t_line, xp->cross_point);
-                img_proc_cross_point_math(Size(RAW_CAL_IMG_WIDTH, RAW_CAL_IMG_HEIGHT), &xp->t_line, xp->cross_point);
-
-                /* create an optical artificial darts board to draw detection cross point */
-                cams_draw_art_board_detect(xp->cross_point);
-
-                /* check result on every raw board */
-                dart_board_determineSector(xp->cross_point, TOP_CAM, &xp->r_top);
-                dart_board_determineSector(xp->cross_point, RIGHT_CAM, &xp->r_right);
-                dart_board_determineSector(xp->cross_point, LEFT_CAM, &xp->r_left);
-
-                /* democratic result */
-                dart_board_decide_sector(&xp->r_top, &xp->r_right, &xp->r_left, &xp->r_final);
-
-                std::cout << "Dart is (String): " << xp->r_final.str << std::endl;
-                std::cout << "Dart is (int Val): " << xp->r_final.val << std::endl;
+                /* lines, cross point and score */
+                cams_detect_dart(xp);
 
                 /* thread safe */
                 t_s->mutex.lock();
@@ -363,16 +304,16 @@ void camsThread(void* arg) {
                 /* thread safe */
                 t_s->mutex.unlock();
 
-                top_cam >> cur_frame_top;
+                board_cam->cap >> board_cam->cur;
                 
                 /* wait till darts board is back to raw and empty */
-                xp->flags.diff_flag_raw = img_proc_diff_check(raw_empty_init_frame, cur_frame_top, TOP_CAM);
+                xp->flags.diff_flag_raw = img_proc_diff_check(raw_empty_init_frame, board_cam->cur, board_cam->id);
 
                 while (xp->flags.diff_flag_raw && (running == 1) && !(cv::waitKey(10) == 27)) {
 
                     /* get current frames from cams */
-                    top_cam >> cur_frame_top;
-                    xp->flags.diff_flag_raw = img_proc_diff_check(raw_empty_init_frame, cur_frame_top, TOP_CAM);
+                    board_cam->cap >> board_cam->cur;
+                    xp->flags.diff_flag_raw = img_proc_diff_check(raw_empty_init_frame, board_cam->cur, board_cam->id);
                     if (xp->flags.diff_flag_raw == IMG_NO_DIFFERENCE) {
                         break;
                     }
@@ -383,26 +324,23 @@ void camsThread(void* arg) {
 
 
                 /* init frame */
-                raw_empty_init_frame = cur_frame_top.clone();
+                raw_empty_init_frame = board_cam->cur.clone();
 
                 /* removing throws */
                 xp->count_throws = 0;
+                img_proc_footprint_clear();
 
                 /* wait for player left board */
                 std::cout << "removing darts ..." << endl;
                 this_thread::sleep_for(chrono::milliseconds(2000));
                 std::cout << "ready ..." << endl;
 
-                top_cam >> cur_frame_top;
-                right_cam >> cur_frame_right;
-                left_cam >> cur_frame_left;
+                rig_grab();
 
             }
 
             /* update last frame */
-            last_frame_top = cur_frame_top.clone();
-            last_frame_right = cur_frame_right.clone();
-            last_frame_left = cur_frame_left.clone();
+            rig_update_last();
 
         }
         else {
@@ -419,9 +357,7 @@ void camsThread(void* arg) {
     std::cout << "Cams Thread Finished\n";
 
     /* free resoruces */
-    top_cam.release();
-    right_cam.release();
-    left_cam.release();
+    rig_release();
 
 }
 
@@ -450,7 +386,8 @@ void camsThread(void* arg) {
  * @return: void
  *
  *
- * @note:	None
+ * @note:	Only cameras of the default rig have simulation images 
+ *          (sim_imgs[]); select the darts with SIM_LAST_DARTS / SIM_CUR_DARTS.
  *
  *
  * Example usage: None
@@ -467,77 +404,47 @@ void SIMULATION_OF_camsThread(void*arg) {
     /* init image cal values */
     calibration_init();
 
-    Mat cur_frame_top, cur_frame_right, cur_frame_left;
-    Mat last_frame_top, last_frame_right, last_frame_left;
-
-    /* raw empty init board (just top view) */
+    /* raw empty init board (just first camera) */
     Mat raw_empty_init_frame;
-#if 0
-    /* open top camera */
-    VideoCapture top_cam(TOP_CAM);
-    if (!top_cam.isOpened()) {
-        std::cout << "[ERROR] cannot open TOP Camera" << endl;
-        return;
-    }
-    /* open right camera */
-    VideoCapture right_cam(RIGHT_CAM);
-    if (!right_cam.isOpened()) {
-        std::cout << "[ERROR] cannot open RIGHT Camera" << endl;
-        return;
-    }
-    /* open left camera */
-    VideoCapture left_cam(LEFT_CAM);
-    if (!left_cam.isOpened()) {
-        std::cout << "[ERROR] cannot open LEFT Camera" << endl;
-        return;
+    struct rig_cam_s* board_cam = rig_cam(0);
+
+    /* every camera needs simulation images */
+    for (int i = 0; i < rig_num_cams(); i++) {
+        if (rig_cam(i)->id >= SIM_CAMS) {
+            std::cout << "[ERROR] " << rig_cam(i)->name << " Cam: no simulation images" << endl;
+            return;
+        }
     }
-#endif 
-    /* create camera windows */
-    ostringstream CamName1;
-    CamName1 << "Top Cam [press Esc to quit]";
-    string top_cam_win = CamName1.str();
-    ostringstream CamName2;
-    CamName2 << "Right Cam [press Esc to quit]";
-    string right_cam_win = CamName2.str();
-    ostringstream CamName3;
-    CamName3 << "Left Cam [press Esc to quit]";
-    string left_cam_win = CamName3.str();
 
     /* short delay */
     this_thread::sleep_for(chrono::milliseconds(500));
 
 #if CALIBRATION
     /* calibration sim */
-    last_frame_top = imread(TOP_2DARTS, IMREAD_ANYCOLOR);
-    last_frame_right = imread(RIGHT_2DARTS, IMREAD_ANYCOLOR);
-    last_frame_left = imread(LEFT_2DARTS, IMREAD_ANYCOLOR);
+    for (int i = 0; i < rig_num_cams(); i++) {
+        rig_cam(i)->cur = imread(sim_imgs[i][2], IMREAD_ANYCOLOR);
+    }
     /* show frames */
-    imshow(top_cam_win, last_frame_top);
-    imshow(right_cam_win, last_frame_right);
-    imshow(left_cam_win, last_frame_left);
+    rig_show();
+    rig_update_last();
     /**/
     std::cout << "throw a dart in the board --> then press 'c' to calibrate thresholds" << endl;
     while ((waitKey(10) != 'c') && running) {
-        cur_frame_top = imread(TOP_3DARTS, IMREAD_ANYCOLOR);
-        cur_frame_right = imread(RIGHT_3DARTS, IMREAD_ANYCOLOR);
-        cur_frame_left = imread(LEFT_3DARTS, IMREAD_ANYCOLOR);
+        for (int i = 0; i < rig_num_cams(); i++) {
+            rig_cam(i)->cur = imread(sim_imgs[i][3], IMREAD_ANYCOLOR);
+        }
         /* show frames */
-        imshow(top_cam_win, cur_frame_top);
-        imshow(right_cam_win, cur_frame_right);
-        imshow(left_cam_win, cur_frame_left);
+        rig_show();
         this_thread::sleep_for(chrono::milliseconds(100));
     }
-    //cur_frame_top = imread(TOP_3DARTS, IMREAD_ANYCOLOR);
-    //cur_frame_right = imread(RIGHT_3DARTS, IMREAD_ANYCOLOR);
-    //cur_frame_left = imread(LEFT_3DARTS, IMREAD_ANYCOLOR);
-    img_proc_calibration(last_frame_top,last_frame_right,last_frame_left,cur_frame_top,cur_frame_right,cur_frame_left);
+    img_proc_calibration();
 #endif
 
-    Mat top_raw = imread(TOP_RAW_IMG_CAL, IMREAD_ANYCOLOR);
-    Mat right_raw = imread(RIGHT_RAW_IMG_CAL, IMREAD_ANYCOLOR);
-    Mat left_raw = imread(LEFT_RAW_IMG_CAL, IMREAD_ANYCOLOR);
-
-    calibration_auto_cal(top_raw, right_raw, left_raw);
+    /* auto calibration on the raw board */
+    for (int i = 0; i < rig_num_cams(); i++) {
+        rig_cam(i)->cur = imread(sim_imgs[i][0], IMREAD_ANYCOLOR);
+    }
+    calibration_auto_cal();
     /*
     Mat test = Mat::zeros(top_raw.rows, top_raw.cols, CV_8UC3);
     dart_board_color_sectors(test);
@@ -547,42 +454,18 @@ void SIMULATION_OF_camsThread(void*arg) {
     */
 
     /* init last frames */
-    //top_cam >> last_frame_top;
-    //right_cam >> last_frame_right;
-    //left_cam >> last_frame_left;
-   
-    /*
-    Mat img = imread(TOP_RAW_IMG_CAL, IMREAD_ANYCOLOR);
-    dart_board_draw_sectors(img, TOP_CAM);
-    img = imread(RIGHT_RAW_IMG_CAL, IMREAD_ANYCOLOR);
-    dart_board_draw_sectors(img, RIGHT_CAM);
-    img = imread(LEFT_RAW_IMG_CAL, IMREAD_ANYCOLOR);
-    dart_board_draw_sectors(img, LEFT_CAM);
-    */
-
-#if 0
-    last_frame_top = imread(TOP_RAW_IMG_CAL, IMREAD_ANYCOLOR);
-    last_frame_right = imread(RIGHT_RAW_IMG_CAL, IMREAD_ANYCOLOR);
-    last_frame_left = imread(LEFT_RAW_IMG_CAL, IMREAD_ANYCOLOR);
-#endif
-#if 0
-    last_frame_top = imread(TOP_1DARTS, IMREAD_ANYCOLOR);
-    last_frame_right = imread(RIGHT_1DARTS, IMREAD_ANYCOLOR);
-    last_frame_left = imread(LEFT_1DARTS, IMREAD_ANYCOLOR);
-#endif
-#if 1
-    last_frame_top = imread(TOP_2DARTS, IMREAD_ANYCOLOR);
-    last_frame_right = imread(RIGHT_2DARTS, IMREAD_ANYCOLOR);
-    last_frame_left = imread(LEFT_2DARTS, IMREAD_ANYCOLOR);
-#endif
-    if (last_frame_top.empty() || last_frame_right.empty() || last_frame_left.empty()) {
-        std::cout << "Error: empty init frame\n" << endl;
-        return;
+    for (int i = 0; i < rig_num_cams(); i++) {
+        struct rig_cam_s* cam = rig_cam(i);
+        cam->last = imread(sim_imgs[i][SIM_LAST_DARTS], IMREAD_ANYCOLOR);
+        if (cam->last.empty()) {
+            std::cout << "Error: empty init frame\n" << endl;
+            return;
+        }
     }
 
 
     /* init frame */
-    raw_empty_init_frame = last_frame_top.clone();
+    raw_empty_init_frame = board_cam->last.clone();
 
 
     /* loop */
@@ -598,29 +481,16 @@ void SIMULATION_OF_camsThread(void*arg) {
         }
 
         /* get current frames from cams */
-        //top_cam >> cur_frame_top;
-        //right_cam >> cur_frame_right;
-        //left_cam >> cur_frame_left;
-#if 0
-        cur_frame_top = imread(TOP_1DARTS, IMREAD_ANYCOLOR);
-        cur_frame_right = imread(RIGHT_1DARTS, IMREAD_ANYCOLOR);
-        cur_frame_left = imread(LEFT_1DARTS, IMREAD_ANYCOLOR);
-#endif
-#if 0
-        cur_frame_top = imread(TOP_2DARTS, IMREAD_ANYCOLOR);
-        cur_frame_right = imread(RIGHT_2DARTS, IMREAD_ANYCOLOR);
-        cur_frame_left = imread(LEFT_2DARTS, IMREAD_ANYCOLOR);
-#endif
-#if 1
-        cur_frame_top = imread(TOP_3DARTS, IMREAD_ANYCOLOR);
-        cur_frame_right = imread(RIGHT_3DARTS, IMREAD_ANYCOLOR);
-        cur_frame_left = imread(LEFT_3DARTS, IMREAD_ANYCOLOR);
-#endif
+        bool frames_ok = true;
+        for (int i = 0; i < rig_num_cams(); i++) {
+            rig_cam(i)->cur = imread(sim_imgs[i][SIM_CUR_DARTS], IMREAD_ANYCOLOR);
+            frames_ok &= !rig_cam(i)->cur.empty();
+        }
         /* corr eval */
         /*
         Mat corr_cur, corr_last;
-        calibration_get_img(cur_frame_top, corr_cur, TOP_CAM);
-        calibration_get_img(last_frame_top, corr_last, TOP_CAM);
+        calibration_get_img(board_cam->cur, corr_cur, TOP_CAM);
+        calibration_get_img(board_cam->last, corr_last, TOP_CAM);
         circle(corr_cur, Point(200, 200), 30, Scalar(255, 255, 255), -1);
         circle(corr_last, Point(200+10, 200+10), 30, Scalar(255, 255, 255), -1);
         computeAndShowCorrelation(corr_cur, corr_last);
@@ -628,61 +498,21 @@ void SIMULATION_OF_camsThread(void*arg) {
 
 
         /* check if frames are not empty */
-        if (!cur_frame_top.empty() && !cur_frame_right.empty() && !cur_frame_left.empty()) {
+        if (frames_ok) {
 
             /* show frames */
-            imshow(top_cam_win, cur_frame_top);
-            imshow(right_cam_win, cur_frame_right);
-            imshow(left_cam_win, cur_frame_left);
-            //calibration_get_img();
-            Mat top_raw = imread(TOP_RAW_IMG_CAL, IMREAD_ANYCOLOR);
-            Mat right_raw = imread(RIGHT_RAW_IMG_CAL, IMREAD_ANYCOLOR);
-            Mat left_raw = imread(LEFT_RAW_IMG_CAL, IMREAD_ANYCOLOR);
-            //calibration_cal_src_points(top_raw, right_raw, left_raw);
-
-            /* check f there are any differences */
-            xp->flags.diff_flag_top = img_proc_diff_check(last_frame_top, cur_frame_top, TOP_CAM);
-            xp->flags.diff_flag_right = img_proc_diff_check(last_frame_right, cur_frame_right, RIGHT_CAM);
-            xp->flags.diff_flag_left = img_proc_diff_check(last_frame_left, cur_frame_left, LEFT_CAM);
-
-            /* check detected difference */
-            if ((xp->flags.diff_flag_top || xp->flags.diff_flag_right || xp->flags.diff_flag_left) && !xp->flags.pause){
+            rig_show();
+
+            /* check if there are any differences */
+            if (cams_diff_check() && !xp->flags.pause){
                 /* clear flags */
-                xp->flags.diff_flag_top = 0;
-                xp->flags.diff_flag_top = 0;
-                xp->flags.diff_flag_top = 0;
+                cams_clear_diff_flags();
 
                 /* short delay to be sure dart is in board and was not on the fly */
                 this_thread::sleep_for(chrono::milliseconds(20));
 
-                /* get even newer frames, with darts which are definetly in the board */
-                //top_cam >> cur_frame_top;
-                //right_cam >> cur_frame_right;
-                //left_cam >> cur_frame_left;
-
-                /* get lne polar coordinates */
-                img_proc_get_line(last_frame_top, cur_frame_top, TOP_CAM, &xp->t_line.line_top, SHOW_SHORT_ANALYSIS, "Top");
-                img_proc_get_line(last_frame_right, cur_frame_right, RIGHT_CAM, &xp->t_line.line_right, SHOW_SHORT_ANALYSIS, "Right");
-                img_proc_get_line(last_frame_left, cur_frame_left, LEFT_CAM, &xp->t_line.line_left, SHOW_SHORT_ANALYSIS, "Left");
-
-                /* calculate cross point */
-                //img_proc_cross_point(Size(RAW_CAL_IMG_WIDTH, RAW_CAL_IMG_HEIGHT), &xp->t_line, xp->cross_point);
-                img_proc_cross_point_math(Size(RAW_CAL_IMG_WIDTH, RAW_CAL_IMG_HEIGHT), &xp->t_line, xp->cross_point);
-
-                /* create an optical artificial darts board to draw detection cross point */
-                cams_draw_art_board_detect(xp->cross_point);
-                
-
-                /* check result on every raw board */
-                dart_board_determineSector(xp->cross_point, TOP_CAM, &xp->r_top);
-                dart_board_determineSector(xp->cross_point, RIGHT_CAM, &xp->r_right);
-                dart_board_determineSector(xp->cross_point, LEFT_CAM, &xp->r_left);
-
-                /* democratic result */
-                dart_board_decide_sector(&xp->r_top, &xp->r_right, &xp->r_left, &xp->r_final);
-
-                std::cout << "Dart is (String): " << xp->r_final.str << std::endl;
-                std::cout << "Dart is (int Val): " << xp->r_final.val << std::endl;
+                /* lines, cross point and score */
+                cams_detect_dart(xp);
 
                 /* thread safe */
                 t_s->mutex.lock();
@@ -710,12 +540,11 @@ void SIMULATION_OF_camsThread(void*arg) {
                 t_s->mutex.unlock();
 
                 /* wait till darts board is back to raw and empty */
-                xp->flags.diff_flag_raw = img_proc_diff_check(raw_empty_init_frame, cur_frame_top, TOP_CAM);
+                xp->flags.diff_flag_raw = img_proc_diff_check(raw_empty_init_frame, board_cam->cur, board_cam->id);
 
                 while (xp->flags.diff_flag_raw && (running == 1) && !(cv::waitKey(10) == 27) && running) {
                     /* get current frames from cams */
-                    //top_cam >> cur_frame_top;
-                    xp->flags.diff_flag_raw = img_proc_diff_check(raw_empty_init_frame, cur_frame_top, TOP_CAM);
+                    xp->flags.diff_flag_raw = img_proc_diff_check(raw_empty_init_frame, board_cam->cur, board_cam->id);
                     if (xp->flags.diff_flag_raw == IMG_NO_DIFFERENCE) {
                         break;
                     }
@@ -724,14 +553,13 @@ void SIMULATION_OF_camsThread(void*arg) {
 
                 /* removing throws */
                 xp->count_throws = 0;
+                img_proc_footprint_clear();
 
 
             }
 
             /* update last frame */
-            last_frame_top = cur_frame_top.clone();
-            last_frame_right = cur_frame_right.clone();
-            last_frame_left = cur_frame_left.clone();
+            rig_update_last();
 
         }
         else {
@@ -750,16 +578,177 @@ void SIMULATION_OF_camsThread(void*arg) {
         this_thread::sleep_for(chrono::milliseconds(250));
     }
 
-    /* free resoruces */
-    //top_cam.release();
-    //right_cam.release();
-    //left_cam.release();
-
 }
 
 
 /************************** Function Definitions *****************************/
 
+/* check every camera of the rig for a difference to its last frame */
+static int cams_diff_check(void) {
+
+    int diff = 0;
+    for (int i = 0; i < rig_num_cams(); i++) {
+        struct rig_cam_s* cam = rig_cam(i);
+        cam->diff_flag = img_proc_diff_check(cam->last, cam->cur, cam->id);
+        diff |= cam->diff_flag;
+    }
+
+    return diff;
+}
+
+/* clear the difference flags of the rig */
+static void cams_clear_diff_flags(void) {
+
+    for (int i = 0; i < rig_num_cams(); i++) {
+        rig_cam(i)->diff_flag = 0;
+    }
+}
+
+
+
+/***
+ *
+ * cams_detect_dart(struct darts_s* xp)
+ *
+ * Line of every camera of the rig, cross point of the lines and the final
+ * score of the dart
+ *
+ *
+ * @param:	struct darts_s* xp --> cross point and final result
+ *
+ *
+ * @return: void
+ *
+ *
+ * @note:	Uses the last and current frames of the rig.
+ *
+ *
+ * Example usage: None
+ *
+***/
+static void cams_detect_dart(struct darts_s* xp) {
+
+    int num = rig_num_cams();
+    struct line_s* lines[RIG_CAMS_MAX];
+
+    /* get line polar coordinates */
+    for (int i = 0; i < num; i++) {
+        struct rig_cam_s* cam = rig_cam(i);
+        cam->line_status = img_proc_get_line(cam->last, cam->cur, cam->id, &cam->line, img_proc_get_show(), cam->name);
+        lines[i] = &cam->line;
+    }
+
+    /* calculate cross point */
+    //img_proc_cross_point(Size(RAW_CAL_IMG_WIDTH, RAW_CAL_IMG_HEIGHT), lines, num, xp->cross_point);
+    img_proc_cross_point_math(Size(RAW_CAL_IMG_WIDTH, RAW_CAL_IMG_HEIGHT), lines, num, &xp->cross, img_proc_get_show());
+    xp->cross_point = Point(cvRound(xp->cross.p.x), cvRound(xp->cross.p.y));
+
+    /* footprints of the selected lines (rejected cameras: line through the cross point), the next dart of the visit does not see this one */
+    for (int i = 0; i < num; i++) {
+        img_proc_footprint_store(&rig_cam(i)->line, rig_cam(i)->id, Size(RAW_CAL_IMG_WIDTH, RAW_CAL_IMG_HEIGHT), &xp->cross);
+    }
+
+    /* line quality of the selected lines, low confidence only without show level */
+    for (int i = 0; i < num; i++) {
+        img_proc_print_line_conf(rig_cam(i)->line_status, &rig_cam(i)->line, rig_cam(i)->name);
+    }
+    if (xp->cross.num_lines > 0) {
+        std::cout << "Cross Point: " << xp->cross.p << " lines: " << xp->cross.num_lines << " rms: " << xp->cross.rms
+            << " sigma: " << xp->cross.ellipse.size.width / 2 << " x " << xp->cross.ellipse.size.height / 2 << std::endl;
+        std::cout << "Residuals:";
+        for (int i = 0; i < (int)xp->cross.residuals.size(); i++) {
+            std::cout << " " << rig_cam(i)->name << " " << xp->cross.residuals[i];
+        }
+        std::cout << std::endl;
+        if (xp->cross.metric) {
+            std::cout << "Cross Point (board): " << xp->cross.p_mm << " mm, rms: " << xp->cross.rms_mm << " mm" << std::endl;
+        }
+    }
+
+    /* outlier cameras, trace mis-scores here */
+    for (const auto& reject : xp->cross.rejected) {
+        std::cout << "[WARNING] " << rig_cam(reject.line)->name << " Cam rejected by the fusion: " << reject.reason << std::endl;
+    }
+
+    /* create an optical artificial darts board to draw detection cross point */
+    cams_draw_art_board_detect(xp->cross_point);
+
+    /***
+     * score the fused cross point once: every camera refers to the same board,
+     * a vote on this point would be unanimous; outlier cameras are rejected
+     * by the fusion (img_proc_intersect_lines())
+    ***/
+    dart_board_determineSector(xp->cross_point, rig_cam(0)->id, &xp->r_final);
+
+    std::cout << "Dart is (String): " << xp->r_final.str << std::endl;
+    std::cout << "Dart is (int Val): " << xp->r_final.val << std::endl;
+}
+
+
+/***
+ *
+ * cams_calibrate_intrinsics(int CamId, int num_views)
+ *
+ * Capture views of a chessboard held in front of the cameras, calibrate
+ * their intrinsics (calibration_intrinsics()) and store them in
+ * name + INTRINSICS_FILE for the "intrinsics" entry of RIG_CONFIG
+ *
+ *
+ * @param:	int CamId --> camera of the rig, -1 := all cameras
+ * @param:	int num_views --> views to capture, INTRINSICS_VIEW_MS apart
+ *
+ *
+ * @return: void
+ *
+ *
+ * @note:	The intrinsics drop the homographies, so the auto calibration
+ *          runs again INTRINSICS_CLEAR_MS after the last view; the
+ *          chessboard has to be removed by then.
+ *
+ *
+ * Example usage: None
+ *
+***/
+static void cams_calibrate_intrinsics(int CamId, int num_views) {
+
+    int num = rig_num_cams();
+    vector<vector<Mat>> views(num);
+
+    /* capture the views, every camera sees the chessboard at the same time */
+    for (int v = 0; v < num_views; v++) {
+        std::cout << "[INFO] chessboard view " << v + 1 << " of " << num_views << ", move the chessboard ..." << endl;
+        this_thread::sleep_for(chrono::milliseconds(INTRINSICS_VIEW_MS));
+        if (rig_grab() != EXIT_SUCCESS) {
+            std::cout << "[ERROR] empty frame, intrinsics calibration stopped" << endl;
+            return;
+        }
+        rig_show();
+        for (int i = 0; i < num; i++) {
+            if ((CamId < 0) || (CamId == i)) {
+                views[i].push_back(rig_cam(i)->cur.clone());
+            }
+        }
+    }
+
+    /* calibrate and store */
+    for (int i = 0; i < num; i++) {
+        if (views[i].empty() || (calibration_intrinsics(i, views[i]) != EXIT_SUCCESS)) {
+            continue;
+        }
+        string path = rig_cam(i)->name + INTRINSICS_FILE;
+        if (calibration_intrinsics_save(i, path) == EXIT_SUCCESS) {
+            std::cout << "[INFO] " << rig_cam(i)->name << " Cam intrinsics stored, add intrinsics: \"" << path << "\" to " << RIG_CONFIG << endl;
+        }
+    }
+
+    /* homographies on the undistorted pixels */
+    std::cout << "[INFO] remove the chessboard, auto calibration in " << INTRINSICS_CLEAR_MS / 1000 << " s ..." << endl;
+    this_thread::sleep_for(chrono::milliseconds(INTRINSICS_CLEAR_MS));
+    rig_grab();
+    calibration_auto_cal();
+}
+
+
 /* not thread safe atm */
 /* external bust */
 void cams_external_bust(void) {
@@ -781,6 +770,14 @@ void cams_set_auto_cal() {
 
 }
 
+/* capture num_views chessboard views and calibrate the intrinsics of a camera (-1 := all cameras) in the cams thread */
+void cams_set_intrinsics(int CamId, int num_views) {
+
+    darts.flags.intrinsics_cam = CamId;
+    darts.flags.intrinsics_views = num_views;
+
+}
+
 
 /* create an optical artificial darts board to draw detection cross point */
 void cams_draw_art_board_detect(cv::Point c_point) {
@@ -40,7 +40,7 @@
 /*************************** global Defines **********************************/
 
 
-/* camera identities */
+/* camera identities of the default rig (rig_init()), ids of any other rig come from RIG_CONFIG */
 #define TOP_CAM     0
 #define LEFT_CAM    2
 #define RIGHT_CAM   1//0
@@ -98,6 +98,7 @@ void SIMULATION_OF_camsThread(void *arg);
 extern void cams_external_bust(void);
 extern void cams_pause_detection(int mode);
 extern void cams_set_auto_cal(void);
+extern void cams_set_intrinsics(int CamId, int num_views);
 
 extern void cams_draw_art_board_detect(cv::Point c_point);
 #endif 
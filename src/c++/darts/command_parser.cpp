@@ -81,6 +81,7 @@
 #include "HoughLine.h"
 #include "dart_board.h"
 #include "cams.h"
+#include "rig.h"
 #include "globals.h"
 #include "command_parser.h"
 #include <cstring>
@@ -652,7 +653,10 @@ void command_parser_cmd_init(void){
     if (!parser.registerCommand("set", "sss", set_params,
         "set parameters \
         \n\tset parameters for the ScoreBoard:\n\t\t-> set score $NAME$ $SCORE$\n\t\t-> set leg $NAME$ $NUM$ not defined atm \
-        \n\tset parameters for image processing:\n\t\t-> set diff_min $intValue$ (set minimum difference value)\n\t\t-> set bin_thresh $intValue$ (set threshold value for binarisation)"
+        \n\tset parameters for image processing:\n\t\t-> set diff_min $intValue$ (set minimum difference value)\n\t\t-> set bin_thresh $intValue$ (set threshold value for binarisation) \
+        \n\t\t-> set line_method $CAM$ $METHOD$ (CAM: camera of the rig e.g. top, or all; METHOD: pca, hough, contour) \
+        \n\t\t-> set native $on|off$ (fit the lines in camera coordinates, no image warp) \
+        \n\t\t-> set show $LEVEL$ (images of the game loop; off, short, all, line, edge, edge_bin, sharp)"
         )) {
         std::cerr << "err: could not register command!" << std::endl;
         return;
@@ -674,6 +678,15 @@ void command_parser_cmd_init(void){
         return;
     }
 
+    /* intrinsics calibration */
+    if (!parser.registerCommand("intrinsics", "su", intrinsics,
+        "calibrate lens distortion with a chessboard by typing:\tintrinsics $CAM$ $VIEWS$ (CAM: camera of the rig e.g. top, or all) \
+        \n\tmove the chessboard between the views, remove it afterwards for the auto calibration"
+    )) {
+        std::cerr << "err: could not register command!" << std::endl;
+        return;
+    }
+
     /* busted cmd */
     if (!parser.registerCommand("busted", " ", busted,
         "TBD!"
@@ -820,6 +833,78 @@ void set_params(CommandParser::Argument* args, size_t argCount, char* response)
         img_proc_set_diff_min_thresh(diff_min);
         return;
     }
+    else if (strcmp(param, "line_method") == 0) {
+        if (!(argCount == 3)) {
+            snprintf(response, MAX_RESPONSE_SIZE, "err: not enough or two many args for param %s, argCount: %d", param, (int)argCount);
+            return;
+        }
+        char* cam = args[1].asString;
+        int method = img_proc_line_method_from_name(args[2].asString);
+        if (method < 0) {
+            snprintf(response, MAX_RESPONSE_SIZE, "err: unknown line method %s (pca, hough, contour)", args[2].asString);
+            return;
+        }
+
+        /* call function */
+        int status = EXIT_SUCCESS;
+        if (strcmp(cam, "all") == 0) {
+            for (int i = 0; i < rig_num_cams(); i++) {
+                status |= img_proc_set_line_method(i, method);
+            }
+        }
+        else if (rig_find_cam(cam) >= 0) {
+            status = img_proc_set_line_method(rig_find_cam(cam), method);
+        }
+        else {
+            snprintf(response, MAX_RESPONSE_SIZE, "err: unknown cam %s (camera of the rig or all)", cam);
+            return;
+        }
+        if (status != EXIT_SUCCESS) {
+            snprintf(response, MAX_RESPONSE_SIZE, "err: could not set line method");
+            return;
+        }
+
+        /* set response */
+        snprintf(response, MAX_RESPONSE_SIZE, "set %s %s %s", param, cam, img_proc_line_method_name(method));
+        return;
+    }
+    else if (strcmp(param, "native") == 0) {
+        if (!(argCount == 2)) {
+            snprintf(response, MAX_RESPONSE_SIZE, "err: not enough or two many args for param %s, argCount: %d", param, (int)argCount);
+            return;
+        }
+        char* mode = args[1].asString;
+        if ((strcmp(mode, "on") != 0) && (strcmp(mode, "off") != 0)) {
+            snprintf(response, MAX_RESPONSE_SIZE, "err: %s is not on or off", mode);
+            return;
+        }
+
+        /* call function */
+        img_proc_set_native(strcmp(mode, "on") == 0);
+
+        /* set response */
+        snprintf(response, MAX_RESPONSE_SIZE, "set %s %s", param, mode);
+        return;
+    }
+    else if (strcmp(param, "show") == 0) {
+        if (!(argCount == 2)) {
+            snprintf(response, MAX_RESPONSE_SIZE, "err: not enough or two many args for param %s, argCount: %d", param, (int)argCount);
+            return;
+        }
+        char* level = args[1].asString;
+        int show_imgs = SHOW_NO_IMAGES;
+        if (img_proc_show_from_name(level, &show_imgs) != EXIT_SUCCESS) {
+            snprintf(response, MAX_RESPONSE_SIZE, "err: unknown show level %s (off, short, all, line, edge, edge_bin, sharp)", level);
+            return;
+        }
+
+        /* call function */
+        img_proc_set_show(show_imgs);
+
+        /* set response */
+        snprintf(response, MAX_RESPONSE_SIZE, "set %s %s", param, level);
+        return;
+    }
     
     
     /* never reached on correct on command */
@@ -870,6 +955,37 @@ void auto_cal(CommandParser::Argument* args, size_t argCount, char* response) {
 }
 
 
+void intrinsics(CommandParser::Argument* args, size_t argCount, char* response) {
+
+    if (argCount != 2) {
+        snprintf(response, MAX_RESPONSE_SIZE, "err: not enough or two many args, argCount: %d", (int)argCount);
+        return;
+    }
+
+    /* camera */
+    char* cam = args[0].asString;
+    int CamId = -1;
+    if (strcmp(cam, "all") != 0) {
+        CamId = rig_find_cam(cam);
+        if (CamId < 0) {
+            snprintf(response, MAX_RESPONSE_SIZE, "err: unknown cam %s (camera of the rig or all)", cam);
+            return;
+        }
+    }
+
+    if (args[1].asUInt == 0) {
+        snprintf(response, MAX_RESPONSE_SIZE, "err: no views");
+        return;
+    }
+
+    /* call func */
+    cams_set_intrinsics(CamId, (int)args[1].asUInt);
+
+    snprintf(response, MAX_RESPONSE_SIZE, "started intrinsics calibration of %s with %u views", cam, (unsigned)args[1].asUInt);
+
+}
+
+
 void busted(CommandParser::Argument* args, size_t argCount, char* response) {
 
     /* call func */
@@ -86,7 +86,7 @@ constexpr size_t MAX_COMMAND_ARGS = 8;
 constexpr size_t MAX_COMMAND_NAME_LENGTH = 16;
 constexpr size_t MAX_COMMAND_ARG_SIZE = 32;
 constexpr size_t MAX_RESPONSE_SIZE = 200;
-constexpr size_t MAX_HELP_LENGTH = 400;
+constexpr size_t MAX_HELP_LENGTH = 512;
 
 
 /************************** local Structure ***********************************/
@@ -154,6 +154,7 @@ extern void set_params(CommandParser::Argument* args, size_t argCount, char* res
 
 extern void pause(CommandParser::Argument* args, size_t argCount, char* response);
 extern void auto_cal(CommandParser::Argument* args, size_t argCount, char* response);
+extern void intrinsics(CommandParser::Argument* args, size_t argCount, char* response);
 extern void busted(CommandParser::Argument* args, size_t argCount, char* response);
 
 
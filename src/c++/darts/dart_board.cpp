@@ -55,6 +55,7 @@
 #include "dart_board.h"
 #include "globals.h"
 #include "cams.h"
+#include "rig.h"
 #include <mutex>
 
 
@@ -383,26 +384,14 @@ void dart_board_determineSector(const cv::Point& pixel, int ThreadId, struct res
     d->mtx.lock();
 
 
-    struct Dartboard_Sector_s board;
-    
-    switch (ThreadId) {
-
-        case TOP_CAM:
-            board = *d->db;
-            break;
-
-        case RIGHT_CAM:
-            board = *d->db;
-            break;
-
-        case LEFT_CAM:
-            board = *d->db;
-            break;
-
-        default:    r->str = "error";
-                    r->val = 0;
-                    break;
+    /* every camera of the rig refers to the same calibrated board */
+    if (rig_cam(ThreadId) == nullptr) {
+        r->str = "error";
+        r->val = 0;
+        d->mtx.unlock();
+        return;
     }
+    struct Dartboard_Sector_s board = *d->db;
 
     /* distance to center */
     float dx = pixel.x - board.center.x;
@@ -523,121 +512,22 @@ void dart_board_getSectorValue(int sector, float distance, struct Dartboard_Sect
 
 
 
-/***
- *
- * dart_board_decide_sector(struct result_s* sec_board_top, struct result_s* sec_board_right, struct result_s* sec_board_left, struct result_s* r)
- *
- * Do the final sector decision based on multiple raw board sector results
- * NOT SUPPORTED at the moment 
- *
- *
- * @param:	struct result_s* sec_board_top      --> Top Board
- * @param:  struct result_s* sec_board_right    --> Right Board 
- * @param:  struct result_s* sec_board_left     --> Left Board
- * @param:  struct result_s* r                  --> final result 
- *
- *
- * @return: void
- *
- *
- * @note:	None
- *
- *
- * Example usage: None
- *
-***/
-void dart_board_decide_sector(struct result_s* sec_board_top, struct result_s* sec_board_right, struct result_s* sec_board_left, struct result_s* r) {
-
-    /* thread safe */
-    d->mtx.lock();
-#if 1 
-
-    /* all three are equal */
-    if ((sec_board_top->str == sec_board_right->str)&& (sec_board_top->str == sec_board_left->str)) {
-        *r = *sec_board_top;
-    }
-    /* top and right are equal */
-    else if (sec_board_top->str == sec_board_right->str) {
-        *r = *sec_board_top;
-    }
-    /* top and left are equal */
-    else if (sec_board_top->str == sec_board_left->str) {
-        *r = *sec_board_top;
-    }
-    /* left and right are equal */
-    else if (sec_board_left->str == sec_board_right->str) {
-        *r = *sec_board_left;
-    }
-    /* none of them are equal */
-    else {
-        printf("Warning: Three Different Sectors detected; return Top Detection as Default\n");
-        *r = *sec_board_top;
-    }
-
-    /* old, at the moment usage is not supported due to new result structure */
-#else 
-
-    /* all three are equal */
-    if ( (!strcmp(sec_board_top.c_str(), sec_board_right.c_str())) && (!strcmp(sec_board_top.c_str(), sec_board_left.c_str()))) {
-        return sec_board_top;
-    }
-    /* top and right are equal */
-    else if ((!strcmp(sec_board_top.c_str(), sec_board_right.c_str()))) {
-        return sec_board_top;
-    }
-    /* top and left are equal */
-    else if ((!strcmp(sec_board_top.c_str(), sec_board_left.c_str()))) {
-        return sec_board_top;
-    }
-    /* left and right are equal */
-    else if ((!strcmp(sec_board_left.c_str(), sec_board_right.c_str()))) {
-        return sec_board_left;
-    }
-    /* none of them are equal */
-    else {
-        printf("Warning: Three Different Sectors detected; return Top Detection as Default\n");
-        return sec_board_top;
-    }
-
-#endif 
-
-    d->mtx.unlock();
-
-}
-
 /* draw darts sectors */
 void dart_board_draw_sectors(cv::Mat& image, int ThreadId, int image_show, int cal, int show_num) {
 
-    string CamNameId = "TOP";
-    struct Dartboard_Sector_s board;
+    /* every camera of the rig refers to the same calibrated board */
+    struct rig_cam_s* cam = rig_cam(ThreadId);
+    if (cam == nullptr) {
+        return;
+    }
+    string CamNameId = cam->name;
+    struct Dartboard_Sector_s board = *d->db;
     Mat cur = image.clone();
     /* calibrate images */
     if (cal) {
         calibration_get_img(cur, cur, ThreadId);
     }
 
-    switch (ThreadId) {
-
-        case TOP_CAM:
-            CamNameId = "TOP";
-            board = *d->db;
-            break;
-
-        case RIGHT_CAM:
-            CamNameId = "RIGHT";
-            board = *d->db;
-            break;
-
-        case LEFT_CAM:
-            CamNameId = "LEFT";
-            board = *d->db;
-            break;
-
-        default:    
-            return;
-            break;
-    }
-
     /* center dart board */
     Point center = board.center;
     int radius = board.Db_r.radiusDoubleOuter;  // uerer Radius des Dartboards
@@ -66,7 +66,6 @@ extern void dart_board_init(void);
 
 extern void dart_board_determineSector(const cv::Point& pixel, int ThreadId, struct result_s*r);
 extern void dart_board_getSectorValue(int sector, float distance, struct Dartboard_Sector_s& board, struct result_s* r);
-extern void dart_board_decide_sector(struct result_s* sec_board_top, struct result_s* sec_board_right, struct result_s* sec_board_left, struct result_s* r);
 extern void dart_board_draw_sectors(cv::Mat& image, int ThreadId, int image_show = 1, int cal = 1, int show_num = 1);
 extern void dart_board_color_sectors(cv::Mat& dst);
 
@@ -38,6 +38,10 @@
 #include <iostream>
 #include <cstdlib>
 #include <string>
+#include <algorithm>
+#include <cfloat>
+#include <cstring>
+#include <sstream>
 #include <opencv2/opencv.hpp>
 #include <opencv2/flann.hpp>
 #include "image_proc.h"
@@ -45,9 +49,11 @@
 #include "calibration.h"
 #include "Sobel.h"
 #include "HoughLine.h"
+#include "Parallel.h"
 #include "cams.h"
 #include "dart_board.h"
 #include "globals.h"
+#include "rig.h"
 
 /****************************** namespaces ***********************************/
 using namespace cv;
@@ -56,7 +62,6 @@ using namespace std;
 
 
 /*************************** local Defines ***********************************/
-#define SMOOTHING_KERNEL_SIZE 1
 #define CROSS_POINT_INTENSITY_MIN 18
 
 #define DIFF_IMG "01 Wait DIFF"
@@ -69,16 +74,67 @@ using namespace std;
 #define RAW_CAL_IMG_WIDTH 640       
 #define RAW_CAL_IMG_HEIGHT 480
 
-/* decide beetwen cluster analysis [1] and classic obeject detection [0] */
-#define DO_PCA  1
+/* classic object detection: Hough only in a window around the predicted line (fitted rect or coarse Hough) */
+#define HOUGH_PRIOR_R_MARGIN 10                 // pixels added to half the short side of the fitted rect
+#define HOUGH_PRIOR_THETA_TOL (5 * CV_PI / 180)
+#define HOUGH_PYR_LEVELS 2
+#define HOUGH_PYR_R_TOL 8
+#define HOUGH_PYR_THETA_TOL (3 * CV_PI / 180)
+#define HOUGH_WIDTH 360
+#define HOUGH_HEIGHT 361
+#define HOUGH_PEAKS 2                           // barrel edges, averaged to the dart axis
+#define HOUGH_CAND_PEAKS (HOUGH_PEAKS * LINE_CANDIDATES_MAX)    // peaks per window for the candidate pairs
+#define HOUGH_PYR_PEAK_RADIUS 1                 // non-maximum suppression of the coarse lines (coarse bins), a window per dart
+#define HOUGH_PEAK_RADIUS 3                     // non-maximum suppression radius (bins)
+#define HOUGH_FOOTPRINT_WIDTH 14                // footprint strip across the line, as the PCA band (CTF_BAND_WIDTH - 16) [pixel]
+#define HOUGH_FOOTPRINT_TRIM 0.02               // ratio of the strip edges cut at both ends (noise along the line)
+#define HOUGH_FOOTPRINT_MIN 10                  // fewer edges in the strip leave no footprint
+
+/* minimum edge pixels per thread when gathering the band points from the edge list */
+#define BAND_POINTS_GRAIN 1024
+
+/* coarse-to-fine cluster analysis */
+#define CTF_PYR_LEVELS 1            // pyrDown steps for the coarse cluster search (1 := 320x240), see img_proc_set_ctf_levels()
+#define CTF_PYR_LEVELS_MAX 1
+#define CTF_CLUSTER_THRESH 120      // cluster threshold on the pyrDown'ed image
+#define CTF_CLUSTER_THRESH_FULL 190 // cluster threshold on full resolution (CTF_PYR_LEVELS 0)
+#define CTF_BAND_WIDTH 30           // width of the full resolution band around the coarse axis
+
+/* robust line fit (IRLS with Tukey biweight) */
+#define IRLS_MAX_ITER 10
+#define IRLS_TUKEY_C 4.685          // tuning constant in units of the residual sigma
+#define IRLS_SIGMA_MIN 0.5          // lower bound of the residual sigma [pixel], edge pixels are quantized
+
+/* tip localization along the main axis */
+#define TIP_BIN_SIZE 2              // bin size of the axial edge density profile [pixel]
+#define TIP_MAX_GAP 6               // number of sparse bins that end the barrel
+#define TIP_DENSITY_RATIO 0.2       // sparse bin := count below this ratio of the median bin count
+
+/* candidate lines (top-k) */
+#define CAND_SAME_THETA 0.09        // candidates closer than ~5 deg and CAND_SAME_R are the same dart [rad]
+#define CAND_SAME_R 10              // [pixel]
+#define CAND_RANK_PENALTY 2.0       // cost of a lower ranked candidate in the joint selection [pixel]
+#define CAND_TIP_WEIGHT 0.25        // cost of the mean tip distance to the intersection, a missing tip counts XP_TIP_DIST_MAX
+
+/* line confidence printed in production (img_proc_print_line_conf()) */
+#define LINE_CONF_RMS_WARN 3.0              // residual rms of the line fit [pixel]
+#define LINE_CONF_THETA_SIGMA_WARN 0.02     // angular uncertainty [rad], ~1 deg
+
+/* least squares intersection of the camera lines */
+#define XP_SIGMA_MIN 1.0            // lower bound of the line uncertainty [pixel], weight 1 / (XP_SIGMA_MIN^2 + rms^2)
+#define XP_DET_MIN 1e-6             // normal matrix of (almost) parallel lines is singular
+#define XP_TIP_DIST_MAX 120.0       // intersection of less than 3 lines further away from the tips is dropped [pixel]
+#define XP_REJECT_DIST 12.0         // line further away from the intersection is an outlier camera [pixel]
+#define XP_TRIANGULATE 1            // metric cross point from the camera poses, see img_proc_triangulate()
+
+/* line space */
+#define NATIVE_LINES_DEFAULT false  // true := fit in camera coordinates and map the line, no image warp per frame
+#define NATIVE_UNDISTORT_SPAN 40    // points of the line undistorted on both sides of the tip [pixel]
+
+/* game loop */
+#define SHOW_IMGS_DEFAULT SHOW_NO_IMAGES    // show level of the game loop, see img_proc_set_show()
 
 /************************** local Structure ***********************************/
-struct roi_last_s {
-    RotatedRect top;
-    RotatedRect right;
-    RotatedRect left;
-};
-
 static struct img_proc_s {
     int bin_thresh = 31;                // parameter BIN_THRESH 
     int diff_min_thresh = 1.5e+5;       // parameter DIFF_MIN_THRESH
@@ -86,9 +142,52 @@ static struct img_proc_s {
     float aspect_ratio_min = 0.01;
     float area_min = 350;
     float short_edge_max = 22;
-    struct roi_last_s roi_last;
+    vector<RotatedRect> footprints[RIG_CAMS_MAX];   // darts already detected in the current visit, per camera (ThreadId)
+    bool native = NATIVE_LINES_DEFAULT;             // see img_proc_set_native()
+    int show_imgs = SHOW_IMGS_DEFAULT;              // see img_proc_set_show()
+    int ctf_levels = CTF_PYR_LEVELS;                // see img_proc_set_ctf_levels()
 }img_proc;
 
+/***
+ * instrumentation policies of img_proc_get_line_impl(): the production policy
+ * compiles all debug images away, the debug policy captures every stage
+ * into struct img_proc_debug_s
+***/
+struct img_proc_prod_policy_s {
+    static const bool capture = false;
+};
+
+struct img_proc_debug_policy_s {
+    static const bool capture = true;
+};
+
+/* line predicted by the barrel contour, window of the Hough transform */
+struct hough_prior_s {
+    bool valid = false;
+    double r = 0;
+    double theta = 0;
+    double r_tol = 0;
+};
+
+/* pair of Hough peaks (barrel edges) averaged to the axis of a dart */
+struct hough_pair_s {
+    double r = 0;
+    double theta = 0;
+    int votes = 0;
+};
+
+/* main axis of the dart cluster in one roi (full resolution) */
+struct cluster_line_s {
+    Rect roi;                       // roi of the first pca
+    Point2f centroid_roi;           // first pca
+    Vec2f axis_roi;
+    RotatedRect band;               // band of the robust fit
+    Point2f centroid;               // final main axis
+    Vec2f axis;
+    vector<Point> band_points;      // edge pixels inside the band
+    struct line_conf_s conf;
+};
+
 
 
 
@@ -97,42 +196,117 @@ static struct img_proc_s {
 
 
 /************************** Function Declaration *****************************/
+static vector<RotatedRect>* img_proc_get_footprints(int ThreadId);
+static int img_proc_bin_thresh(int ThreadId);
+static int img_proc_diff_min_thresh(int ThreadId);
+static int img_proc_cluster_line(const cv::Mat& cluster_img, const ip::EdgeList& edges, cv::Rect roi, struct cluster_line_s* cl);
+static void img_proc_show(const std::string& name, const cv::Mat& img);
+static void img_proc_polar_to_board(const cv::Matx33d& H_inv_t, cv::Point2d c, double& r, double& theta);
+static void img_proc_polar_undistort(const cv::Matx33d& K, const cv::Mat& dist, cv::Point2d c, cv::Point2f anchor, double& r, double& theta);
+static cv::Point2f img_proc_point_to_board(const cv::Matx33d& H, cv::Point2f p);
+static bool img_proc_lines_lsq(int num, const double* r, const double* theta, const double* w, cv::Point2d& p, cv::Matx22d& normal_inv);
+static double img_proc_line_var(const struct line_conf_s* conf);
+static int img_proc_find_outlier(const struct line_s* const* lines, int n, const int* ids, const double* r, const double* theta, const double* w, cv::Size frameSize, struct line_reject_s* reject);
+template <class Policy> static int img_proc_line_pca(struct line_edges_s* in, struct line_s* line, struct img_proc_debug_s* debug);
+template <class Policy> static int img_proc_line_hough(struct line_edges_s* in, struct line_s* line, struct img_proc_debug_s* debug);
+template <class Policy> static int img_proc_line_contour(struct line_edges_s* in, struct line_s* line, struct img_proc_debug_s* debug);
+template <class Policy> static int img_proc_hough_fit(const ip::EdgeList& edges, const ip::EdgeList& support, const struct hough_prior_s* prior, cv::Mat& edge_bin_cont, const cv::Mat& cur, struct line_s* line, struct img_proc_debug_s* debug);
+static bool img_proc_line_strip(const ip::EdgeList& edges, double r, double theta, cv::RotatedRect& strip, std::vector<cv::Point>& points);
+static void img_proc_line_pair_mean(double r0, double theta0, double r1, double theta1, double& r, double& theta);
+
+
+
+/************************** Line Extractors **********************************/
+/* LINE_METHOD_PCA */
+class PcaLineExtractor : public LineExtractor {
+public:
+    const char* name() const override { return "pca"; }
+    bool needsDirection() const override { return false; }
+    int extract(struct line_edges_s* in, struct line_s* line) const override {
+        return img_proc_line_pca<img_proc_prod_policy_s>(in, line, NULL);
+    }
+    int extractDebug(struct line_edges_s* in, struct line_s* line, struct img_proc_debug_s* debug) const override {
+        return img_proc_line_pca<img_proc_debug_policy_s>(in, line, debug);
+    }
+};
+
+/* LINE_METHOD_HOUGH */
+class HoughLineExtractor : public LineExtractor {
+public:
+    const char* name() const override { return "hough"; }
+    bool needsDirection() const override { return true; }
+    int extract(struct line_edges_s* in, struct line_s* line) const override {
+        return img_proc_line_hough<img_proc_prod_policy_s>(in, line, NULL);
+    }
+    int extractDebug(struct line_edges_s* in, struct line_s* line, struct img_proc_debug_s* debug) const override {
+        return img_proc_line_hough<img_proc_debug_policy_s>(in, line, debug);
+    }
+};
+
+/* LINE_METHOD_CONTOUR */
+class ContourLineExtractor : public LineExtractor {
+public:
+    const char* name() const override { return "contour"; }
+    bool needsDirection() const override { return true; }
+    int extract(struct line_edges_s* in, struct line_s* line) const override {
+        return img_proc_line_contour<img_proc_prod_policy_s>(in, line, NULL);
+    }
+    int extractDebug(struct line_edges_s* in, struct line_s* line, struct img_proc_debug_s* debug) const override {
+        return img_proc_line_contour<img_proc_debug_policy_s>(in, line, debug);
+    }
+};
+
+static const PcaLineExtractor pca_line_extractor;
+static const HoughLineExtractor hough_line_extractor;
+static const ContourLineExtractor contour_line_extractor;
+
+/* indexed by LINE_METHOD_* */
+static const LineExtractor* const line_extractors[LINE_METHOD_COUNT] = {
+    &pca_line_extractor,
+    &hough_line_extractor,
+    &contour_line_extractor,
+};
 
 
 
 /************************** Function Definitions *****************************/
 /***
  *
- * img_proc_get_line(cv::Mat& lastImg, cv::Mat& currentImg, int ThreadId, struct line_s* line, int show_imgs, std::string CamNameId)
+ * img_proc_get_line_impl<Policy>(const cv::Mat& lastImg, const cv::Mat& currentImg, int ThreadId, int method, bool calibrate, struct line_s* line, struct img_proc_debug_s* debug)
  *
- * Image Processing Main Function
- * --> processes current and last image and returns main line through the tip
- * of the dart
+ * Line extraction of img_proc_get_line(), written once for the production
+ * and the debug version: edge list of the difference image and line fit with
+ * the LineExtractor of the method
  *
  *
- * @param:	cv::Mat& lastImg --> last Image 
- * @param:	cv::Mat& currentImg --> current Image
+ * @param:	const cv::Mat& lastImg --> last Image 
+ * @param:	const cv::Mat& currentImg --> current Image
  * @param:  int ThreadId --> defines camera perspective
+ * @param:  int method --> line extraction method (LINE_METHOD_*)
+ * @param:  bool calibrate --> line on the reference board (warp the images or map the native line)
  * @param:  struct line_s* line --> return single line in Polar Coordinates
- * @param:  int show_imgs --> defines Image to be displayed
- * @param   std::string CamNameId --> Name displayed Windows
+ * @param:  struct img_proc_debug_s* debug --> intermediate images, only used if Policy::capture
  *
  *
  * @return: int status 
  *
  *
- * @note:   This function is the kernel compoment of the Darts detection 
- *          System. This function works based on difference images and
- *          Image processing steps to isolated the Dart and detect the barrel
- *          position and draw a line through the barrel and the tip of the 
- *          Dart. After this function a intersection function is called 
- *          to get the intersection of the three camera perspectives
+ * @note:   Policy is img_proc_prod_policy_s or img_proc_debug_policy_s.
+ *          Policy::capture is a compile time constant, so the production
+ *          version contains no debug image construction at all (debug may
+ *          be NULL there).
+ *          In native mode (img_proc_set_native()) the images are not warped,
+ *          the line is fitted in camera coordinates and mapped to the board
+ *          by img_proc_line_to_board(); the edges are restricted to the
+ *          board (calibration_raw_mask()), debug images and footprints stay
+ *          in camera coordinates.
  *
  *
  * Example usage: None
  *
 ***/
-int img_proc_get_line(cv::Mat& lastImg, cv::Mat& currentImg, int ThreadId, struct line_s* line, int show_imgs, std::string CamNameId) {
+template <class Policy>
+static int img_proc_get_line_impl(const cv::Mat& lastImg, const cv::Mat& currentImg, int ThreadId, int method, bool calibrate, struct line_s* line, struct img_proc_debug_s* debug) {
 
 
     /* declare images */
@@ -151,36 +325,49 @@ int img_proc_get_line(cv::Mat& lastImg, cv::Mat& currentImg, int ThreadId, struc
     //Mat diff_sharp;
     //Mat diff_sharp_gray;
 
-    //Mat sharp_after_diff;
-    Mat sharp_after_diff_gray;
-
     Mat edge;
-    Mat edge_bin;
 
-    Mat houghSpace;
-    Mat cur_line;
 
+    /* no line, tip and confidence until a line has been fitted */
+    line->valid = false;
+    line->tip_valid = false;
+    line->num_candidates = 0;
+    line->selected = 0;
+    line->conf = line_conf_s();
+    line->candidates[0] = line_cand_s();
 
-    /* clone images */
-    cur = currentImg.clone();
-    if (cur.empty()) {
+    /* check images, the blur below writes new images so the inputs are not cloned */
+    if (currentImg.empty()) {
         std::cout << "[ERROR] Current Image is empty" << endl;
         return EXIT_FAILURE;
     }
 
-    last = lastImg.clone();
-    if (last.empty()) {
+    if (lastImg.empty()) {
         std::cout << "[ERROR] Last Image is empty" << endl;
         return EXIT_FAILURE;
     }
 
-    /* noise reduction */
-    cv::GaussianBlur(cur, cur, Size(3, 3), GAUSSIAN_BLUR_SIGMA, GAUSSIAN_BLUR_SIGMA);
-    cv::GaussianBlur(last, last, Size(3, 3), GAUSSIAN_BLUR_SIGMA, GAUSSIAN_BLUR_SIGMA);
+    if ((method < 0) || (method >= LINE_METHOD_COUNT)) {
+        std::cout << "[ERROR] Unknown line method " << method << endl;
+        return EXIT_FAILURE;
+    }
+    const LineExtractor* extractor = line_extractors[method];
 
-    /* calibrate images */
-    calibration_get_img(cur, cur, ThreadId);
-    calibration_get_img(last, last, ThreadId);
+    /* noise reduction */
+    cv::GaussianBlur(currentImg, cur, Size(3, 3), GAUSSIAN_BLUR_SIGMA, GAUSSIAN_BLUR_SIGMA);
+    cv::GaussianBlur(lastImg, last, Size(3, 3), GAUSSIAN_BLUR_SIGMA, GAUSSIAN_BLUR_SIGMA);
+
+    /* calibrate images, in native mode only the final line is mapped to the board */
+    bool native = calibrate && img_proc.native;
+    struct rig_cam_s* cam = rig_cam(ThreadId);
+    if (native && ((cam == nullptr) || cam->H.empty())) {
+        std::cout << "[ERROR] camera " << ThreadId << " not calibrated" << endl;
+        return EXIT_FAILURE;
+    }
+    if (calibrate && !native) {
+        calibration_get_img(cur, cur, ThreadId);
+        calibration_get_img(last, last, ThreadId);
+    }
 
     /* gray conversion */
     cvtColor(cur, cur_gray, COLOR_BGR2GRAY);
@@ -201,47 +388,136 @@ int img_proc_get_line(cv::Mat& lastImg, cv::Mat& currentImg, int ThreadId, struc
     //absdiff(last_sharp_gray, cur_sharp_gray, diff_sharp_gray);
 
 
-    /* sharpen images after difference */
+    /* sharpen images after difference, only for debug (the edge image below sharpens in the sobel kernel) */
     //img_proc_sharpen_img(diff, sharp_after_diff);
-    img_proc_sharpen_img(diff_gray, sharp_after_diff_gray);
+    if (Policy::capture) {
+        debug->cur = cur;
+        debug->cur_gray = cur_gray;
+        debug->diff_gray = diff_gray;
+        img_proc_sharpen_img(diff_gray, debug->sharp_after_diff_gray);
+    }
 
-    /* edge image */
+    /***
+     * edge image of the sharpened difference, one pass without the sharpened image;
+     * threshold straight to a sparse edge list, darts cover only a few percent of the image
+    ***/
     //int thresh_top = 55;
-    ip::sobelFilter(sharp_after_diff_gray, edge);
     //threshold(edge, edge_bin, BIN_THRESH, 255, THRESH_BINARY);    // fixed macro
-    cv::threshold(edge, edge_bin, img_proc.bin_thresh, 255, THRESH_BINARY);      // set by trackbar
+    struct line_edges_s in;
+    in.ThreadId = ThreadId;
+    in.cur = cur;
+    if (extractor->needsDirection()) {
+        /* gradient direction is needed for the oriented Hough transform */
+        Mat edge_dir;
+        ip::sharpenSobelFilter(diff_gray, edge, edge_dir, SHARPEN_KERNEL_CENTER);
+        ip::edgeListThreshold(edge, img_proc_bin_thresh(ThreadId), in.edges, edge_dir);      // set by trackbar or rig
+    }
+    else {
+        ip::sharpenSobelFilter(diff_gray, edge, SHARPEN_KERNEL_CENTER);
+        ip::edgeListThreshold(edge, img_proc_bin_thresh(ThreadId), in.edges);      // set by trackbar or rig
+    }
+
+    /* native mode: only the edges on the board, as on the warped images */
+    if (native) {
+        Mat raw_mask;
+        calibration_raw_mask(ThreadId, edge.size(), raw_mask);
+        ip::edgeListKeepMask(in.edges, raw_mask);
+    }
+
+    /* suppress darts of the current visit that have already been detected */
+    cluster_erase(in.edges, ThreadId);
+
+    /* binary image for the image based stages (coarse cluster, contours) */
+    ip::edgeListToImage(in.edges, in.edge_bin);
+    if (Policy::capture) {
+        debug->edge = edge;
+        debug->edge_bin = in.edge_bin.clone();
+    }
+
+    /* fit the line with the method of this camera */
+    int status = Policy::capture ? extractor->extractDebug(&in, line, debug) : extractor->extract(&in, line);
+    if (status != EXIT_SUCCESS) {
+        return status;
+    }
+
+    line->valid = true;
+
+    /* the main line is always the first candidate */
+    if (line->num_candidates == 0) {
+        line->candidates[0].r = line->r;
+        line->candidates[0].theta = line->theta;
+        line->candidates[0].tip = line->tip;
+        line->candidates[0].tip_valid = line->tip_valid;
+        line->candidates[0].conf = line->conf;
+        line->num_candidates = 1;
+    }
+
+    /* camera coordinates --> reference board */
+    if (native) {
+        img_proc_line_to_board(cam->H, cur.size(), line, cam->K, cam->intrinsics ? cam->dist : Mat());
+    }
+
+
+    return EXIT_SUCCESS;
+
+}
 
 
 
-/********************** under construction ***********************************/
+/***
+ *
+ * img_proc_line_pca<Policy>(struct line_edges_s* in, struct line_s* line, struct img_proc_debug_s* debug)
+ *
+ * LINE_METHOD_PCA: coarse-to-fine PCA of the dart cluster, robust refit on
+ * the full resolution edge pixels and tip search
+ *
+ *
+ * @param:	struct line_edges_s* in --> edges of the camera
+ * @param:  struct line_s* line --> return main line and candidates
+ * @param:  struct img_proc_debug_s* debug --> intermediate images, only used if Policy::capture
+ *
+ *
+ * @return: int status 
+ *
+ *
+ * @note:   Every candidate carries the footprint of its dart, the footprint
+ *          of the selected candidate is stored by img_proc_footprint_store().
+ *
+ *
+ * Example usage: None
+ *
+***/
+template <class Policy>
+static int img_proc_line_pca(struct line_edges_s* in, struct line_s* line, struct img_proc_debug_s* debug) {
 
+    const Mat& cur = in->cur;
+    Mat& edge_bin = in->edge_bin;
+    const ip::EdgeList& edges = in->edges;
 
-#if DO_PCA
 
     /***
-     * recursive cluster analysis
-     * 1. find main roi (Dart) in Image and find main axis through cluster 
+     * recursive cluster analysis (coarse-to-fine)
+     * 1. find main roi (Dart) in the pyrDown'ed Image and find main axis through cluster 
      * 2. define a new roi tight around the main axis and find a new main axis in this roi
+     * 3. refine the main axis on the full resolution edge pixels inside a narrow band
+     *    around the coarse axis
     ***/
 
-    /*** 
-     * create this image for imshow(), whats in earlier versions has been just the edge_bin image
-     * the name edge_bin_cont is "historical" result for compatibility, dont worry about it :)
-    ***/
-    Mat edge_bin_cont = edge_bin.clone();
-
-   
-    Mat cluster_img = edge_bin.clone();
-    /* heavy noise reduction, dont care if dart gets blurry */
-    GaussianBlur(cluster_img, cluster_img, Size(29, 29), GAUSSIAN_BLUR_SIGMA, GAUSSIAN_BLUR_SIGMA);
-    threshold(cluster_img, cluster_img, 190, 255, THRESH_BINARY);
-    /* close open contours --> the goal is to get an even more symmetric cluster */
-    morphologyEx(cluster_img, cluster_img, MORPH_CLOSE, Mat::ones(5, 5, CV_8U));
-    //erode(cluster_img, cluster_img, Mat::ones(3, 3, CV_8U));  // Erosion
-    /* heavy noise reduction, dont care if dart gets blurry */
-    //GaussianBlur(cluster_img, cluster_img, Size(17, 17), GAUSSIAN_BLUR_SIGMA, GAUSSIAN_BLUR_SIGMA);
-    //threshold(cluster_img, cluster_img, 160, 255, THRESH_BINARY);
-    //dilate(cluster_img, cluster_img, Mat::ones(3, 3, CV_8U));  // Dilation
+    /* coarse edge image, the cluster is blurred heavily anyway so full resolution is not needed */
+    int ctf_levels = img_proc.ctf_levels;
+    Mat edge_coarse = edge_bin;
+    for (int i = 0; i < ctf_levels; i++) {
+        pyrDown(edge_coarse, edge_coarse);
+    }
+
+    Mat cluster_img = edge_coarse.clone();
+    /* heavy noise reduction, dont care if dart gets blurry (29x29 on full resolution) */
+    int cluster_ksize = (29 >> ctf_levels) | 1;
+    GaussianBlur(cluster_img, cluster_img, Size(cluster_ksize, cluster_ksize), GAUSSIAN_BLUR_SIGMA, GAUSSIAN_BLUR_SIGMA);
+    threshold(cluster_img, cluster_img, (ctf_levels > 0) ? CTF_CLUSTER_THRESH : CTF_CLUSTER_THRESH_FULL, 255, THRESH_BINARY);
+    /* close open contours --> the goal is to get an even more symmetric cluster (5x5 on full resolution) */
+    int close_ksize = (5 >> ctf_levels) | 1;
+    morphologyEx(cluster_img, cluster_img, MORPH_CLOSE, Mat::ones(close_ksize, close_ksize, CV_8U));
     
     /* define roi size in the first run */
     int imgWidth = cluster_img.cols;
@@ -259,182 +535,163 @@ int img_proc_get_line(cv::Mat& lastImg, cv::Mat& currentImg, int ThreadId, struc
         }
     }
 
-    /* get the roi with the most withe pixels --> find dart */
-    Rect bestRoi;
-    int maxWhitePixels = 0;
-
+    /* rank the rois by their white pixels --> find darts */
+    vector<pair<int, Rect>> ranked_rois;
     for (const auto& roi : rois) {
-        Mat roiImage = cluster_img(roi);
-        int whitePixels = countNonZero(roiImage);
-
-        if (whitePixels > maxWhitePixels) {
-            maxWhitePixels = whitePixels;
-            bestRoi = roi;
+        int whitePixels = countNonZero(cluster_img(roi));
+        if (whitePixels > 0) {
+            ranked_rois.push_back(make_pair(whitePixels, roi));
         }
     }
 
-    if (maxWhitePixels == 0) {
+    if (ranked_rois.empty()) {
         cout << "err: black screen" << endl;
         return -1;
     }
+    std::stable_sort(ranked_rois.begin(), ranked_rois.end(), [](const pair<int, Rect>& a, const pair<int, Rect>& b) { return a.first > b.first; });
 
-    /* extract pxiels from best roi */
-    vector<Point> points_roi;
-    for (int y = bestRoi.y; y < bestRoi.y + bestRoi.height; y++) {
-        for (int x = bestRoi.x; x < bestRoi.x + bestRoi.width; x++) {
-            if (cluster_img.at<uchar>(y, x) == 255) {
-                points_roi.push_back(Point(x, y));
-            }
-        }
-    }
-
-
-
-    /* cluster erase */
-    // add this at a later project stage after other new features hab been validated 
-    //cluster_erase(cluster_img, ThreadId);
-
-    /* pca */
-    Mat data_roi(points_roi.size(), 2, CV_32F);    
-    for (size_t i = 0; i < points_roi.size(); i++) {
-        data_roi.at<float>(i, 0) = points_roi[i].x;
-        data_roi.at<float>(i, 1) = points_roi[i].y;
-    }
-    PCA pca_roi(data_roi, Mat(), PCA::DATA_AS_ROW);
-
-    /* main axis of dart */
-    Vec2f mainAxis_roi(pca_roi.eigenvectors.row(0));
-
-    /* calc centroid of cluster */
-    Point2f centroid_roi(pca_roi.mean.at<float>(0, 0), pca_roi.mean.at<float>(0, 1));
-
-
-    /* creat image */
-    edge_bin_cont = cluster_img.clone();
-    
-    cvtColor(edge_bin_cont, edge_bin_cont, COLOR_GRAY2BGR);
-    
-    /* draw best roi */
-    rectangle(edge_bin_cont, bestRoi, Scalar(0, 255, 0), 2);
-
-    /* draw cluster main axis */
-    drawLine(edge_bin_cont, centroid_roi, mainAxis_roi, Scalar(0, 255, 0));
-
-    /* draw cluster centroid */
-    circle(edge_bin_cont, centroid_roi, 5, Scalar(0, 255, 0), -1);
 
-
-    /*** 
-     * do second cluster analysis with optimized roi 
+    /***
+     * cluster analysis for the best rois; the first LINE_CANDIDATES_MAX distinct lines
+     * are the candidates of this camera, the first one is the main line
     ***/
-    cluster_img = edge_bin.clone();
-    /* heavy noise reduction, dont care if dart gets blurry */
-    GaussianBlur(cluster_img, cluster_img, Size(29, 29), GAUSSIAN_BLUR_SIGMA, GAUSSIAN_BLUR_SIGMA);
-    threshold(cluster_img, cluster_img, 190, 255, THRESH_BINARY);
-    /* close open contours --> the goal is to get an even more symmetric cluster */
-    morphologyEx(cluster_img, cluster_img, MORPH_CLOSE, Mat::ones(5, 5, CV_8U));
-    //erode(cluster_img, cluster_img, Mat::ones(3, 3, CV_8U));  // Erosion
-    //dilate(cluster_img, cluster_img, Mat::ones(3, 3, CV_8U));  // Dilation
-
-    /* size of rotated rect */
-    float roiWidth2 = 30;       // 15 pixel around axis, should fit barrel and flight 
-    /* length of new roi is length of diagonal of old roi */
-    float roiHeight2 = std::sqrt(bestRoi.width * bestRoi.width + bestRoi.height * bestRoi.height); 
+    vector<struct cluster_line_s> clusters;
+    line->num_candidates = 0;
+    for (const auto& ranked : ranked_rois) {
+        if (line->num_candidates >= LINE_CANDIDATES_MAX) {
+            break;
+        }
 
-    /* roatetd rect with old main axis as angle */
-    RotatedRect rotatedROI(centroid_roi, Size2f(roiHeight2, roiWidth2), atan2(mainAxis_roi[1], mainAxis_roi[0]) * 180.0 / CV_PI);
+        struct cluster_line_s cl;
+        if (img_proc_cluster_line(cluster_img, edges, ranked.second, &cl) != EXIT_SUCCESS) {
+            continue;
+        }
 
-    /* mask for roatetd rect */
-    Mat mask = Mat::zeros(cluster_img.size(), CV_8UC1);
-    Point2f vertices[4];
-    rotatedROI.points(vertices);
-    vector<Point> roiContour = { vertices[0], vertices[1], vertices[2], vertices[3] };
-    fillConvexPoly(mask, roiContour, Scalar(255));
+        float r_cand = 0;
+        float theta_cand = 0;
+        calculatePolarCoordinates(cl.centroid, cl.axis, edge_bin, r_cand, theta_cand);
 
-    /* extract pixels from new roi */
-    vector<Point> roiPoints;
-    for (int y = 0; y < cluster_img.rows; y++) {
-        for (int x = 0; x < cluster_img.cols; x++) {
-            if (mask.at<uchar>(y, x) == 255 && cluster_img.at<uchar>(y, x) == 255) {
-                roiPoints.push_back(Point(x, y));
+        /* overlapping rois find the same dart more than once */
+        bool duplicate = false;
+        for (int i = 0; i < line->num_candidates; i++) {
+            if (img_proc_same_line(line->candidates[i].r, line->candidates[i].theta, r_cand, theta_cand)) {
+                duplicate = true;
+                break;
             }
         }
-    }
-
-    /* second pca in rotated roi */
-    Mat roiData(roiPoints.size(), 2, CV_32F);
-    for (size_t i = 0; i < roiPoints.size(); i++) {
-        roiData.at<float>(i, 0) = roiPoints[i].x;
-        roiData.at<float>(i, 1) = roiPoints[i].y;
-    }
-    PCA pca2(roiData, Mat(), PCA::DATA_AS_ROW);
-    Point2f centroid2(pca2.mean.at<float>(0, 0), pca2.mean.at<float>(0, 1));
-    Vec2f mainAxis2(pca2.eigenvectors.row(0));
+        if (duplicate) {
+            continue;
+        }
 
+        struct line_cand_s* cand = &line->candidates[line->num_candidates++];
+        cand->r = r_cand;
+        cand->theta = theta_cand;
+        cand->conf = cl.conf;
+        cand->tip_valid = img_proc_find_tip(cl.band_points, cl.centroid, cl.axis, cand->tip);
 
-    /* draw rotated roi */
-    drawRotatedRect(edge_bin_cont, rotatedROI, Scalar(255, 0, 255));
+        /* rotated rect with the main axis of this cluster as angle --> footprint of this dart */
+        cand->band = RotatedRect(cl.centroid, Size2f(cl.band.size.width - 100, cl.band.size.height - 16), cl.band.angle);
+        cand->band_valid = true;
+        clusters.push_back(cl);
+    }
 
-    /* draw ne main axis and new centroid */
-    drawLine(edge_bin_cont, centroid2, mainAxis2, Scalar(255, 0, 255));
-    circle(edge_bin_cont, centroid2, 5, Scalar(255, 0, 255), -1);
+    if (clusters.empty()) {
+        cout << "err: robust line fit failed" << endl;
+        return -1;
+    }
+    const struct cluster_line_s& best = clusters[0];
+    line->conf = best.conf;
 
 
     /*** 
      * get polar coordinates from final main axis 
     ***/
-    float theta = 0;
-    float r = 0;
-
-    calculatePolarCoordinates(centroid2, mainAxis2, edge_bin, r, theta);
-
-    //Mat pca_img = Mat::zeros(edge_bin.size(), CV_8UC3);
-    
-    //drawLine(pca_img, centroid2, mainAxis2, Scalar(255, 255, 255));
-    //pca_img = Mat::zeros(edge_bin.size(), CV_8UC3);
-    
-    //drawLine(pca_img, centroid2, mainAxis2, Scalar(255, 0, 255));
-    //circle(pca_img, centroid2, 5, Scalar(0, 255, 255), -1);
-    //Mat edge_bin_cont = pca_img.clone();
-    //ip::drawLine(edge_bin_cont, r, theta);   // Debug
-    
-
-    cur_line = cur.clone();
-    ip::drawLine(cur_line, r, theta);
-    ip::drawLine(edge_bin_cont, r, theta);
+    float theta = line->candidates[0].theta;
+    float r = line->candidates[0].r;
 
     /* return line values */
     line->r = r;
     line->theta = theta;
 
+    /* tip along the final main axis */
+    line->tip = line->candidates[0].tip;
+    line->tip_valid = line->candidates[0].tip_valid;
 
-    /* save roatetd rect with new main axis as angle */
-    RotatedRect rotatedROI_final(centroid2, Size2f(roiHeight2-100, roiWidth2-16), atan2(mainAxis2[1], mainAxis2[0]) * 180.0 / CV_PI);
-    /* set last roi default zero */
-    switch (ThreadId) {
-    case TOP_CAM:
-        img_proc.roi_last.top = rotatedROI_final;
-        break;
-    case RIGHT_CAM:
-        img_proc.roi_last.right = rotatedROI_final;
-        break;
-    case LEFT_CAM:
-        img_proc.roi_last.left = rotatedROI_final;
-        break;
-    default:
-        break;
-    }
+    if (Policy::capture) {
+        /***
+         * whats in earlier versions has been just the edge_bin image, the name
+         * edge_bin_cont is "historical" result for compatibility, dont worry about it :)
+         * debug drawings are done at full resolution
+        ***/
+        Mat& edge_bin_cont = debug->edge_bin_cont;
+        resize(cluster_img, edge_bin_cont, edge_bin.size(), 0, 0, INTER_NEAREST);
+        cvtColor(edge_bin_cont, edge_bin_cont, COLOR_GRAY2BGR);
 
-    
+        /* draw best roi */
+        rectangle(edge_bin_cont, best.roi, Scalar(0, 255, 0), 2);
 
-/*****************************************************************************/
+        /* draw cluster main axis */
+        drawLine(edge_bin_cont, best.centroid_roi, best.axis_roi, Scalar(0, 255, 0));
+
+        /* draw cluster centroid */
+        circle(edge_bin_cont, best.centroid_roi, 5, Scalar(0, 255, 0), -1);
+
+        /* draw rotated roi */
+        drawRotatedRect(edge_bin_cont, best.band, Scalar(255, 0, 255));
+
+        /* draw ne main axis and new centroid */
+        drawLine(edge_bin_cont, best.centroid, best.axis, Scalar(255, 0, 255));
+        circle(edge_bin_cont, best.centroid, 5, Scalar(255, 0, 255), -1);
+
+        /* draw the other candidates */
+        for (int i = 1; i < line->num_candidates; i++) {
+            ip::drawLine_light_add(edge_bin_cont, line->candidates[i].r, line->candidates[i].theta);
+        }
+
+        /* draw final line and tip */
+        debug->cur_line = cur.clone();
+        ip::drawLine(debug->cur_line, r, theta);
+        ip::drawLine(edge_bin_cont, r, theta);
+        if (line->tip_valid) {
+            circle(debug->cur_line, line->tip, 6, Scalar(0, 255, 255), 2);
+            circle(edge_bin_cont, line->tip, 6, Scalar(0, 255, 255), 2);
+        }
+    }
+
+    return EXIT_SUCCESS;
+}
 
 
 
+/***
+ *
+ * img_proc_line_contour<Policy>(struct line_edges_s* in, struct line_s* line, struct img_proc_debug_s* debug)
+ *
+ * LINE_METHOD_CONTOUR: barrel detection (added at later project stage), the
+ * rect fitted around the barrel contour predicts the window of the Hough
+ * transform
+ *
+ *
+ * @param:	struct line_edges_s* in --> edges of the camera, the edge image is modified
+ * @param:  struct line_s* line --> return main line
+ * @param:  struct img_proc_debug_s* debug --> intermediate images, only used if Policy::capture
+ *
+ *
+ * @return: int status 
+ *
+ *
+ * @note:   Without a barrel contour this is the same as LINE_METHOD_HOUGH.
+ *
+ *
+ * Example usage: None
+ *
+***/
+template <class Policy>
+static int img_proc_line_contour(struct line_edges_s* in, struct line_s* line, struct img_proc_debug_s* debug) {
 
-#else
+    Mat& edge_bin = in->edge_bin;
+    ip::EdgeList rect_edges;        // outline of the fitted rect, the edges of the camera stay for the strip
 
-    /* barrel detction (added at later project stage) */
     /***
      * idea is to find barrel cotour and delete flight contour and then draw a 
      * close fitting rectangle around the barrel and do edge detection with 
@@ -458,9 +715,11 @@ int img_proc_get_line(cv::Mat& lastImg, cv::Mat& currentImg, int ThreadId, struc
     cv::morphologyEx(edge_bin, edge_bin, cv::MORPH_CLOSE, cv::Mat::ones(2, 2, CV_8U));
     //GaussianBlur(edge_bin, edge_bin, Size(3, 3), 0.3, 0.3);
 
-    /* create this image for imshow(), whats in earlier versions has been just the edge_bin image */
-    Mat edge_bin_cont = edge_bin.clone();
-    cvtColor(edge_bin_cont, edge_bin_cont, COLOR_GRAY2BGR);
+    /* create this image for debug, whats in earlier versions has been just the edge_bin image */
+    Mat edge_bin_cont;
+    if (Policy::capture) {
+        cvtColor(edge_bin, edge_bin_cont, COLOR_GRAY2BGR);
+    }
 
     /* find contour of dart */
     vector<vector<Point>> cont;
@@ -469,8 +728,10 @@ int img_proc_get_line(cv::Mat& lastImg, cv::Mat& currentImg, int ThreadId, struc
 
     /* draw cont */
     //Mat contoursImg = Mat::zeros(edge_bin.size(), CV_8UC3);
-    for (size_t i = 0; i < cont.size(); i++) {
-        drawContours(edge_bin_cont, cont, (int)i, Scalar(255, 255, 0), 1, LINE_8, hier, 0);
+    if (Policy::capture) {
+        for (size_t i = 0; i < cont.size(); i++) {
+            drawContours(edge_bin_cont, cont, (int)i, Scalar(255, 255, 0), 1, LINE_8, hier, 0);
+        }
     }
 
     //Mat result = Mat::zeros(edge_bin.size(), CV_8UC3);
@@ -511,7 +772,9 @@ int img_proc_get_line(cv::Mat& lastImg, cv::Mat& currentImg, int ThreadId, struc
                 ar_last = aspectRatio;
                 /* reset contour */
                 allPoints.clear();
-                drawContours(edge_bin_cont, cont, (int)i, Scalar(0, 255, 255), 1);
+                if (Policy::capture) {
+                    drawContours(edge_bin_cont, cont, (int)i, Scalar(0, 255, 255), 1);
+                }
                 /* calculate corners of ratating rectangle */
                 Point2f points[4];
                 rotatedRect.points(points);
@@ -530,6 +793,9 @@ int img_proc_get_line(cv::Mat& lastImg, cv::Mat& currentImg, int ThreadId, struc
 
 
 
+    /* line predicted by the fitted rect */
+    struct hough_prior_s prior;
+
     /* calaculate just one rot rect which fits all other rects, their might be more than bc of shaft and barrel might be divided through its haptic */
     if (!allPoints.empty()) {
 
@@ -540,12 +806,26 @@ int img_proc_get_line(cv::Mat& lastImg, cv::Mat& currentImg, int ThreadId, struc
 
         /* draw rect */
         for (int j = 0; j < 4; j++) {
-            cv::line(edge_bin_cont, points_enc[j], points_enc[(j + 1) % 4], Scalar(255, 0, 0), 2);
+            if (Policy::capture) {
+                cv::line(edge_bin_cont, points_enc[j], points_enc[(j + 1) % 4], Scalar(255, 0, 0), 2);
+            }
             cv::line(cont_rect_fitted, points_enc[j], points_enc[(j + 1) % 4], Scalar(255, 0, 0), 1);
         }
         /* */
         cvtColor(cont_rect_fitted, edge_bin, COLOR_BGR2GRAY);
         cv::threshold(edge_bin, edge_bin, 10, 255, THRESH_BINARY);
+
+        /* the fitted rect has no gradient, its barrel edges vote with the normal of the long side */
+        float axis_angle = (enclosingRect.size.width >= enclosingRect.size.height) ? enclosingRect.angle : enclosingRect.angle + 90;
+        float normal_angle = fmod(axis_angle + 90 + 360, 180);
+        ip::edgeListFromImage(edge_bin, rect_edges);
+        rect_edges.dir.assign(rect_edges.size(), (float)(normal_angle * CV_PI / 180.0));
+
+        /* the axis of the rect is the prior, its long sides are within half the short side */
+        prior.theta = normal_angle * CV_PI / 180.0;
+        prior.r = (enclosingRect.center.x - edge_bin.cols / 2) * cos(prior.theta) + (enclosingRect.center.y - edge_bin.rows / 2) * sin(prior.theta);
+        prior.r_tol = min(enclosingRect.size.width, enclosingRect.size.height) / 2.0 + HOUGH_PRIOR_R_MARGIN;
+        prior.valid = true;
     }
     /* if there were no conts, which fitted criteria do normal edge detection */
     else {
@@ -559,351 +839,1265 @@ int img_proc_get_line(cv::Mat& lastImg, cv::Mat& currentImg, int ThreadId, struc
     //imshow("contoura", contoursImg);
     //imshow("Fitted all", cont_rect_fitted);
 
-    /* Calculate Hough transform */
-    cur_line = cur.clone();
-    ip::houghTransform(edge_bin, houghSpace);
-
-    cv::GaussianBlur(houghSpace, houghSpace, Size(SMOOTHING_KERNEL_SIZE, SMOOTHING_KERNEL_SIZE), 0.0);
-
-
-    /* find 2 gloabl maxima */
-    Mat houghSpaceClone = houghSpace.clone();
-    /* Prepare Hough space image for display */
-    houghSpace = 255 - houghSpace;				// Invert
-    ip::drawHoughLineLabels(houghSpace);		// Axes
-
-    Point houghMaxLocation;
-    double r, theta;
-    double r_avg = 0;
-    double theta_avg = 0;
-    /* find global maxima */
-    int global_max = 2;
-    for (int i = 0; i < global_max; i++) {
-        minMaxLoc(houghSpaceClone, NULL, NULL, NULL, &houghMaxLocation);
-        ip::houghSpaceToLine(
-            Size(edge_bin.cols, edge_bin.rows),
-            Size(houghSpace.cols, houghSpace.rows),
-            houghMaxLocation.x, houghMaxLocation.y, r, theta);
-        //ip::drawLine(cur_line, r, theta);
-        //cout << "Debug x: " << houghMaxLocation.x << "\ty: " << houghMaxLocation.y << endl;
-
-        // set max to zero
-        int delete_size = 3;
-        for (int dx = -delete_size; dx <= delete_size; ++dx) {
-            for (int dy = -delete_size; dy <= delete_size; ++dy) {
-                int nx = houghMaxLocation.x + dx; // neighbor in x-dir
-                int ny = houghMaxLocation.y + dy; // neighbor in y-dir
-
-
-                if (nx >= 0 && nx < houghSpaceClone.cols && ny >= 0 && ny < houghSpaceClone.rows) {
-                    houghSpaceClone.at<uchar>(ny, nx) = 0;
-                }
-            }
+    return img_proc_hough_fit<Policy>(prior.valid ? rect_edges : in->edges, in->edges, &prior, edge_bin_cont, in->cur, line, debug);
+}
+
+
+
+/***
+ *
+ * img_proc_line_hough<Policy>(struct line_edges_s* in, struct line_s* line, struct img_proc_debug_s* debug)
+ *
+ * LINE_METHOD_HOUGH: coarse-to-fine oriented Hough transform of all edges
+ *
+ *
+ * @param:	struct line_edges_s* in --> edges of the camera
+ * @param:  struct line_s* line --> return main line
+ * @param:  struct img_proc_debug_s* debug --> intermediate images, only used if Policy::capture
+ *
+ *
+ * @return: int status 
+ *
+ *
+ * @note:   None
+ *
+ *
+ * Example usage: None
+ *
+***/
+template <class Policy>
+static int img_proc_line_hough(struct line_edges_s* in, struct line_s* line, struct img_proc_debug_s* debug) {
+
+    Mat edge_bin_cont;
+    if (Policy::capture) {
+        cvtColor(in->edge_bin, edge_bin_cont, COLOR_GRAY2BGR);
+    }
+
+    return img_proc_hough_fit<Policy>(in->edges, in->edges, NULL, edge_bin_cont, in->cur, line, debug);
+}
+
+
+
+/***
+ *
+ * img_proc_hough_fit<Policy>(const ip::EdgeList& edges, const ip::EdgeList& support, const struct hough_prior_s* prior, cv::Mat& edge_bin_cont, const cv::Mat& cur, struct line_s* line, struct img_proc_debug_s* debug)
+ *
+ * Hough transform of the edges and average of the two strongest lines
+ * (barrel edges), every distinct pair of peaks is a candidate line
+ *
+ *
+ * @param:	const ip::EdgeList& edges --> edge pixels (with gradient direction)
+ * @param:	const ip::EdgeList& support --> edge pixels of the camera for the strip along the line
+ * @param:	const struct hough_prior_s* prior --> predicted line, NULL or invalid for none
+ * @param:	cv::Mat& edge_bin_cont --> debug image, only used if Policy::capture
+ * @param:	const cv::Mat& cur --> current image, only used if Policy::capture
+ * @param:  struct line_s* line --> return main line and candidates
+ * @param:  struct img_proc_debug_s* debug --> intermediate images, only used if Policy::capture
+ *
+ *
+ * @return: int status 
+ *
+ *
+ * @note:   With a prior the transform is calculated in a window around the
+ *          predicted line only, without coarse-to-fine. Without a prior
+ *          every strong coarse line gets a window (other darts). The strip
+ *          of the support edges along a line is the footprint of the dart
+ *          (img_proc_footprint_store()), the robust fit of these edges
+ *          (img_proc_fit_line_robust()) is the confidence of the line and
+ *          locates its tip.
+ *
+ *
+ * Example usage: None
+ *
+***/
+template <class Policy>
+static int img_proc_hough_fit(const ip::EdgeList& edges, const ip::EdgeList& support, const struct hough_prior_s* prior, cv::Mat& edge_bin_cont, const cv::Mat& cur, struct line_s* line, struct img_proc_debug_s* debug) {
+
+    /* Calculate Hough transform only in a window around the predicted line, coarse-to-fine without prediction (one window per coarse line) */
+    vector<Mat> houghWindows;
+    vector<Rect> hough_wins;
+    if ((prior != NULL) && prior->valid) {
+        houghWindows.resize(1);
+        hough_wins.resize(1);
+        ip::houghAccumulateWindow(edges, houghWindows[0], hough_wins[0], prior->r, prior->theta, prior->r_tol, HOUGH_PRIOR_THETA_TOL, HOUGH_HEIGHT, HOUGH_WIDTH);
+    }
+    else {
+        ip::houghAccumulatePyramid(edges, houghWindows, hough_wins, HOUGH_PYR_R_TOL, HOUGH_PYR_THETA_TOL, LINE_CANDIDATES_MAX, HOUGH_PYR_PEAK_RADIUS, HOUGH_PYR_LEVELS, HOUGH_HEIGHT, HOUGH_WIDTH);
+    }
+
+    /* Prepare Hough space image for debug, the windows are not wrapped in theta */
+    if (Policy::capture) {
+        Mat& houghSpace = debug->hough_space;
+        double hough_max = 0;
+        for (const auto& houghWindow : houghWindows) {
+            double win_max = 0;
+            minMaxLoc(houghWindow, NULL, &win_max);
+            hough_max = std::max(hough_max, win_max);
         }
-        //cout << r << "\t" << theta << endl;
-        /* shift the edges exactly on the edge to be more centered in averaging */
-        int shift_val = 2;
-        if (r > shift_val) {
-            if (theta < CV_PI / 2) {
-                r = r + shift_val;
+        houghSpace = Mat::zeros(Size(HOUGH_WIDTH, HOUGH_HEIGHT), CV_8U);
+        for (size_t k = 0; k < houghWindows.size(); k++) {
+            Mat houghWindow8;
+            houghWindows[k].convertTo(houghWindow8, CV_8U, (hough_max > 0) ? 255.0 / hough_max : 0.0);
+            for (int i = 0; i < houghWindow8.cols; i++) {
+                int u = ((hough_wins[k].x + i) % HOUGH_WIDTH + HOUGH_WIDTH) % HOUGH_WIDTH;
+                Mat houghCol = houghSpace(Rect(u, hough_wins[k].y, 1, houghWindow8.rows));
+                cv::max(houghCol, houghWindow8.col(i), houghCol);
             }
-            else {
-                r = r - shift_val;
+        }
+        houghSpace = 255 - houghSpace;				// Invert
+        ip::drawHoughLineLabels(houghSpace);		// Axes
+    }
+
+    /***
+     * candidates: the two strongest peaks of every window are the barrel edges of a dart
+     * (averaged to its axis), further peaks pair up with the strongest peak of the same dart;
+     * the first pair of the first window (strongest coarse line) is the main line
+    ***/
+    vector<struct hough_pair_s> pairs;
+    for (size_t k = 0; k < houghWindows.size(); k++) {
+        std::vector<ip::HoughPeak> peaks;
+        int num_peaks = ip::houghPeaks(houghWindows[k], peaks, HOUGH_CAND_PEAKS, HOUGH_PEAK_RADIUS);
+
+        /* peaks as lines */
+        double r[HOUGH_CAND_PEAKS], theta[HOUGH_CAND_PEAKS];
+        bool used[HOUGH_CAND_PEAKS] = { false };
+        for (int i = 0; i < num_peaks; i++) {
+            double u = peaks[i].u + hough_wins[k].x;
+            double v = peaks[i].v + hough_wins[k].y;
+            ip::houghSpaceToLine(Size(edges.cols, edges.rows), Size(HOUGH_WIDTH, HOUGH_HEIGHT), u, v, r[i], theta[i]);
+            ip::normalizeLine(r[i], theta[i]);
+
+            if (Policy::capture) {
+                ip::drawLine(edge_bin_cont, r[i], theta[i]);   // Debug
+                int u_disp = ((cvRound(u) % HOUGH_WIDTH) + HOUGH_WIDTH) % HOUGH_WIDTH;
+                cv::circle(debug->hough_space, Point(u_disp, cvRound(v)), 5, Scalar(0, 0, 255), 2);		// Peak
             }
         }
-        else if (r < -shift_val) {
-            if (theta < CV_PI / 2){
-                r = r - shift_val;
+
+        for (int i = 0; i < num_peaks; i++) {
+            if (used[i]) {
+                continue;
             }
-            else {
-                r = r + shift_val;
+            used[i] = true;
+
+            /* partner: next peak for the first pair, otherwise the strongest free peak of the same dart */
+            int j = i + 1;
+            if (i > 0) {
+                while ((j < num_peaks) && (used[j] || !img_proc_same_line(r[i], theta[i], r[j], theta[j]))) {
+                    j++;
+                }
             }
-        }
-        //cout << r << endl;
-        ip::drawLine(edge_bin_cont, r, theta);   // Debug
-        cv::circle(houghSpace, houghMaxLocation, 5, Scalar(0, 0, 255), 2);		// Global maximum
-        /* averaging */
-        //out << "Debug r: " << r << "\ttheta" << theta << endl;
-        /* !watch out when delta_theta > 90 */
-        if ((i > 0) && (fabs(theta_avg - theta) > (CV_PI / 2))) {
-            r_avg = r_avg + (-r);   // toggle sign
-            if (theta > 0) {
-                theta_avg = theta_avg + (CV_PI - theta);
+
+            struct hough_pair_s pair;
+            if (j < num_peaks) {
+                used[j] = true;
+                img_proc_line_pair_mean(r[i], theta[i], r[j], theta[j], pair.r, pair.theta);
+                pair.votes = peaks[i].votes + peaks[j].votes;
+            }
+            else if (i == 0) {
+                /* single peak of the window */
+                pair.r = r[i];
+                pair.theta = theta[i];
+                pair.votes = peaks[i].votes;
             }
             else {
-                theta_avg = theta_avg + (-CV_PI - theta);
+                continue;   // lone edge (flight, noise)
             }
-        }
-        else {
-            r_avg += r; // / (double)global_max;
-            theta_avg += theta; /// (double)global_max;
+            pairs.push_back(pair);
         }
     }
-    r_avg = r_avg / global_max;
-    theta_avg = theta_avg / global_max;
 
+    if (pairs.empty()) {
+        cout << "err: no Hough peak" << endl;
+        return -1;
+    }
 
+    /* rank the other pairs by their votes */
+    std::stable_sort(pairs.begin() + 1, pairs.end(), [](const struct hough_pair_s& a, const struct hough_pair_s& b) { return a.votes > b.votes; });
 
-    //cout << r_avg << "\t" << theta_avg << endl;
-    /* draw average line */
-    ip::drawLine(cur_line, r_avg, theta_avg);
+    /* distinct pairs are the candidates, the strip of the supporting edges is the footprint of the dart */
+    line->num_candidates = 0;
+    for (const auto& pair : pairs) {
+        if (line->num_candidates >= LINE_CANDIDATES_MAX) {
+            break;
+        }
+
+        bool duplicate = false;
+        for (int i = 0; i < line->num_candidates; i++) {
+            if (img_proc_same_line(line->candidates[i].r, line->candidates[i].theta, pair.r, pair.theta)) {
+                duplicate = true;
+                break;
+            }
+        }
+        if (duplicate) {
+            continue;
+        }
+
+        struct line_cand_s* cand = &line->candidates[line->num_candidates++];
+        *cand = line_cand_s();
+        cand->r = pair.r;
+        cand->theta = pair.theta;
+
+        vector<Point> strip_points;
+        cand->band_valid = img_proc_line_strip(support, pair.r, pair.theta, cand->band, strip_points);
+
+        /* confidence and tip of the line: robust fit of the strip edges, as the PCA band (left empty below 2 inliers) */
+        Point2f centroid;
+        Vec2f axis;
+        if (img_proc_fit_line_robust(strip_points, centroid, axis, &cand->conf) == EXIT_SUCCESS) {
+            cand->tip_valid = img_proc_find_tip(strip_points, centroid, axis, cand->tip);
+        }
+        else {
+            cand->conf = line_conf_s();
+        }
+        cand->conf.cluster_area = (double)strip_points.size();
+    }
 
     /* return line values */
-    line->r = r_avg;
-    line->theta = theta_avg;
-    //cout << "Debug r_avg: " << r_avg << "\ttheta_avg" << theta_avg << endl;
+    const struct line_cand_s& main = line->candidates[0];
+    line->r = main.r;
+    line->theta = main.theta;
+    line->conf = main.conf;
+    line->tip = main.tip;
+    line->tip_valid = main.tip_valid;
+
+    /* draw average lines */
+    if (Policy::capture) {
+        for (int i = 1; i < line->num_candidates; i++) {
+            ip::drawLine_light_add(edge_bin_cont, line->candidates[i].r, line->candidates[i].theta);
+        }
+        if (main.band_valid) {
+            drawRotatedRect(edge_bin_cont, main.band, Scalar(255, 0, 255));
+        }
+        debug->edge_bin_cont = edge_bin_cont;
+        debug->cur_line = cur.clone();
+        ip::drawLine(debug->cur_line, main.r, main.theta);
+        if (main.tip_valid) {
+            circle(debug->cur_line, main.tip, 6, Scalar(0, 255, 255), 2);
+            circle(edge_bin_cont, main.tip, 6, Scalar(0, 255, 255), 2);
+        }
+    }
 
-#endif
+    return EXIT_SUCCESS;
+}
+
+
+
+/* average of two lines, !watch out when delta_theta > 90 deg: continue the line beyond pi (toggle sign of r) */
+static void img_proc_line_pair_mean(double r0, double theta0, double r1, double theta1, double& r, double& theta) {
+
+    if (fabs(theta0 - theta1) > (CV_PI / 2)) {
+        r1 = -r1;
+        theta1 = (theta1 > theta0) ? theta1 - CV_PI : theta1 + CV_PI;
+    }
+    r = (r0 + r1) / 2;
+    theta = (theta0 + theta1) / 2;
+    ip::normalizeLine(r, theta);
+}
+
+
+
+/***
+ * strip of the edge pixels within HOUGH_FOOTPRINT_WIDTH / 2 of a line (r
+ * around the image center), from the first to the last of them along the
+ * line without HOUGH_FOOTPRINT_TRIM at both ends; points returns these edge
+ * pixels (image coordinates)
+***/
+static bool img_proc_line_strip(const ip::EdgeList& edges, double r, double theta, cv::RotatedRect& strip, std::vector<cv::Point>& points) {
+
+    double ct = cos(theta);
+    double st = sin(theta);
+    double cx = edges.cols / 2.0;
+    double cy = edges.rows / 2.0;
+
+    /* position of the supporting edge pixels along the line, direction (-sin, cos) */
+    vector<float> along;
+    points.clear();
+    for (size_t i = 0; i < edges.size(); i++) {
+        double dx = edges.x[i] - cx;
+        double dy = edges.y[i] - cy;
+        if (fabs(dx * ct + dy * st - r) <= HOUGH_FOOTPRINT_WIDTH / 2.0) {
+            along.push_back((float)(-dx * st + dy * ct));
+            points.push_back(Point(edges.x[i], edges.y[i]));
+        }
+    }
+    if (along.size() < HOUGH_FOOTPRINT_MIN) {
+        return false;
+    }
 
+    size_t trim = (size_t)(along.size() * HOUGH_FOOTPRINT_TRIM);
+    std::nth_element(along.begin(), along.begin() + trim, along.end());
+    double t0 = along[trim];
+    std::nth_element(along.begin(), along.end() - 1 - trim, along.end());
+    double t1 = along[along.size() - 1 - trim];
+
+    /* foot point of the line plus the middle of the strip */
+    double tm = (t0 + t1) / 2;
+    Point2f center((float)(cx + r * ct - tm * st), (float)(cy + r * st + tm * ct));
+    strip = RotatedRect(center, Size2f((float)(t1 - t0), (float)HOUGH_FOOTPRINT_WIDTH), (float)(atan2(ct, -st) * 180.0 / CV_PI));
+
+    return true;
+}
+
+
+
+/***
+ *
+ * img_proc_get_line(cv::Mat& lastImg, cv::Mat& currentImg, int ThreadId, struct line_s* line, int show_imgs, std::string CamNameId)
+ *
+ * Image Processing Main Function
+ * --> processes current and last image and returns main line through the tip
+ * of the dart
+ *
+ *
+ * @param:	cv::Mat& lastImg --> last Image 
+ * @param:	cv::Mat& currentImg --> current Image
+ * @param:  int ThreadId --> defines camera perspective
+ * @param:  struct line_s* line --> return single line in Polar Coordinates
+ * @param:  int show_imgs --> defines Image to be displayed
+ * @param   std::string CamNameId --> Name displayed Windows
+ *
+ *
+ * @return: int status 
+ *
+ *
+ * @note:   This function is the kernel compoment of the Darts detection 
+ *          System. This function works based on difference images and
+ *          Image processing steps to isolated the Dart and detect the barrel
+ *          position and draw a line through the barrel and the tip of the 
+ *          Dart. After this function a intersection function is called 
+ *          to get the intersection of the three camera perspectives
+ *
+ *
+ * Example usage: None
+ *
+***/
+int img_proc_get_line(cv::Mat& lastImg, cv::Mat& currentImg, int ThreadId, struct line_s* line, int show_imgs, std::string CamNameId) {
 
-    /* create windows */
+    /* nothing to display --> production version without any debug images */
     if (show_imgs == SHOW_NO_IMAGES) {
-        return EXIT_SUCCESS;
+        return img_proc_get_line_impl<img_proc_prod_policy_s>(lastImg, currentImg, ThreadId, img_proc_get_line_method(ThreadId), true, line, NULL);
     }
-    else if (show_imgs == SHOW_ALL_IMAGES) {
 
-        /* curent image plots */
-        string image_basic = string("Current Image (").append(CamNameId).append(" Cam)");
-        string image_gray = string("Current Image Gray (").append(CamNameId).append(" Cam)");
-        cv::imshow(image_basic, cur);
-        cv::imshow(image_gray, cur_gray);
+    /* capture all stages and display the requested ones */
+    struct img_proc_debug_s debug;
+    int status = img_proc_get_line_impl<img_proc_debug_policy_s>(lastImg, currentImg, ThreadId, img_proc_get_line_method(ThreadId), true, line, &debug);
+    if (status == EXIT_SUCCESS) {
+        img_proc_show_debug(&debug, show_imgs, CamNameId);
+    }
+
+    return status;
+}
+
+
+
+/***
+ *
+ * img_proc_get_line_debug(cv::Mat& lastImg, cv::Mat& currentImg, int ThreadId, struct line_s* line, struct img_proc_debug_s* debug)
+ *
+ * Same as img_proc_get_line(), but all intermediate images are returned
+ * instead of displayed
+ *
+ *
+ * @param:	cv::Mat& lastImg --> last Image 
+ * @param:	cv::Mat& currentImg --> current Image
+ * @param:  int ThreadId --> defines camera perspective
+ * @param:  struct line_s* line --> return single line in Polar Coordinates
+ * @param:  struct img_proc_debug_s* debug --> return intermediate images
+ *
+ *
+ * @return: int status 
+ *
+ *
+ * @note:   Images of stages which have not been reached (error status) or
+ *          do not exist in the line method of the camera stay empty.
+ *          Display them with img_proc_show_debug().
+ *
+ *
+ * Example usage: None
+ *
+***/
+int img_proc_get_line_debug(cv::Mat& lastImg, cv::Mat& currentImg, int ThreadId, struct line_s* line, struct img_proc_debug_s* debug) {
+
+    *debug = img_proc_debug_s();
+    return img_proc_get_line_impl<img_proc_debug_policy_s>(lastImg, currentImg, ThreadId, img_proc_get_line_method(ThreadId), true, line, debug);
+}
+
+
+
+/***
+ *
+ * img_proc_run_line_method(const cv::Mat& lastImg, const cv::Mat& currentImg, int ThreadId, int method, struct line_s* line, bool calibrate)
+ *
+ * Production version of img_proc_get_line() with a given line extraction
+ * method, independent of the method selected for the camera
+ *
+ *
+ * @param:	const cv::Mat& lastImg --> last Image 
+ * @param:	const cv::Mat& currentImg --> current Image
+ * @param:  int ThreadId --> defines camera perspective
+ * @param:  int method --> line extraction method (LINE_METHOD_*)
+ * @param:  struct line_s* line --> return single line in Polar Coordinates
+ * @param:  bool calibrate --> false for images which are calibrated already
+ *
+ *
+ * @return: int status 
+ *
+ *
+ * @note:   Used by the benchmark to compare the methods on the same frames.
+ *
+ *
+ * Example usage: None
+ *
+***/
+int img_proc_run_line_method(const cv::Mat& lastImg, const cv::Mat& currentImg, int ThreadId, int method, struct line_s* line, bool calibrate) {
+
+    return img_proc_get_line_impl<img_proc_prod_policy_s>(lastImg, currentImg, ThreadId, method, calibrate, line, NULL);
+}
+
+
+
+/***
+ *
+ * img_proc_line_to_board(const cv::Mat& H, cv::Size frameSize, struct line_s* line, const cv::Matx33d& K, const cv::Mat& dist)
+ *
+ * Map a line fitted in camera coordinates to the reference board: lines
+ * with H^-T, tips with H
+ *
+ *
+ * @param:	const cv::Mat& H --> homography raw image --> reference board
+ * @param:  cv::Size frameSize --> image size, r is around the image center on both sides
+ * @param:  struct line_s* line --> line and candidates, mapped in place
+ * @param:  const cv::Matx33d& K --> camera matrix, only used with dist
+ * @param:  const cv::Mat& dist --> lens distortion of the camera, empty := none
+ *
+ *
+ * @return: void
+ *
+ *
+ * @note:   The homography is almost affine on the dart, so the residual rms
+ *          and the cluster area are scaled by the local scale of H at the
+ *          tip (foot point of the line without tip). With lens distortion
+ *          the line is undistorted around the tip first, H is on
+ *          undistorted pixels then (see calibration_match()).
+ *
+ *
+ * Example usage: None
+ *
+***/
+void img_proc_line_to_board(const cv::Mat& H, cv::Size frameSize, struct line_s* line, const cv::Matx33d& K, const cv::Mat& dist) {
+
+    Matx33d H_board = Matx33d(H);
+    Matx33d H_inv_t = H_board.inv().t();
+    Point2d c(frameSize.width / 2, frameSize.height / 2);
+
+    /* lens distortion: straight line around the tip, undistorted tips */
+    if (!dist.empty()) {
+        for (int i = 0; i < line->num_candidates; i++) {
+            struct line_cand_s* cand = &line->candidates[i];
+            Point2f anchor = cand->tip_valid ? cand->tip : Point2f((float)(c.x + cand->r * cos(cand->theta)), (float)(c.y + cand->r * sin(cand->theta)));
+            img_proc_polar_undistort(K, dist, c, anchor, cand->r, cand->theta);
+            if (cand->tip_valid) {
+                vector<Point2f> tip(1, cand->tip);
+                undistortPoints(tip, tip, K, dist, noArray(), K);
+                cand->tip = tip[0];
+            }
+        }
+        Point2f anchor = line->tip_valid ? line->tip : Point2f((float)(c.x + line->r * cos(line->theta)), (float)(c.y + line->r * sin(line->theta)));
+        img_proc_polar_undistort(K, dist, c, anchor, line->r, line->theta);
+        if (line->tip_valid) {
+            vector<Point2f> tip(1, line->tip);
+            undistortPoints(tip, tip, K, dist, noArray(), K);
+            line->tip = tip[0];
+        }
+    }
+
+    /* local scale: area of the mapped unit square */
+    Point2f p = line->tip_valid ? line->tip : Point2f((float)(c.x + line->r * cos(line->theta)), (float)(c.y + line->r * sin(line->theta)));
+    Point2f q = img_proc_point_to_board(H_board, p);
+    Point2f qx = img_proc_point_to_board(H_board, p + Point2f(1, 0)) - q;
+    Point2f qy = img_proc_point_to_board(H_board, p + Point2f(0, 1)) - q;
+    double scale = sqrt(fabs(qx.x * qy.y - qx.y * qy.x));
+
+    img_proc_polar_to_board(H_inv_t, c, line->r, line->theta);
+    if (line->tip_valid) {
+        line->tip = img_proc_point_to_board(H_board, line->tip);
+    }
+    line->conf.rms *= scale;
+    line->conf.cluster_area *= scale * scale;
+
+    for (int i = 0; i < line->num_candidates; i++) {
+        struct line_cand_s* cand = &line->candidates[i];
+        img_proc_polar_to_board(H_inv_t, c, cand->r, cand->theta);
+        if (cand->tip_valid) {
+            cand->tip = img_proc_point_to_board(H_board, cand->tip);
+        }
+        cand->conf.rms *= scale;
+        cand->conf.cluster_area *= scale * scale;
+    }
+}
+
+/* polar line around the image center c through a homography, H_inv_t = H^-T */
+static void img_proc_polar_to_board(const cv::Matx33d& H_inv_t, cv::Point2d c, double& r, double& theta) {
+
+    double ct = cos(theta);
+    double st = sin(theta);
+    Vec3d l = H_inv_t * Vec3d(ct, st, -(r + ct * c.x + st * c.y));
+    double s = sqrt(l[0] * l[0] + l[1] * l[1]);
+
+    theta = atan2(l[1], l[0]);
+    r = -(l[2] + l[0] * c.x + l[1] * c.y) / s;
+
+    /* shift angle [0, pi] as calculatePolarCoordinates() */
+    if (theta < 0) {
+        theta += CV_PI;
+        r = -r;
+    }
+}
+
+/* polar line around the image center c through the undistortion, straight between two points around anchor */
+static void img_proc_polar_undistort(const cv::Matx33d& K, const cv::Mat& dist, cv::Point2d c, cv::Point2f anchor, double& r, double& theta) {
+
+    /* project anchor on the line, then one point on each side */
+    Point2f n((float)cos(theta), (float)sin(theta));
+    Point2f d(-n.y, n.x);
+    Point2f p = anchor - n * (float)((anchor.x - c.x) * n.x + (anchor.y - c.y) * n.y - r);
+    vector<Point2f> points = { p - d * NATIVE_UNDISTORT_SPAN, p + d * NATIVE_UNDISTORT_SPAN };
+    undistortPoints(points, points, K, dist, noArray(), K);
+
+    /* normal of the undistorted line, angle [0, pi] as calculatePolarCoordinates() */
+    Point2f dir = points[1] - points[0];
+    double len = norm(dir);
+    if (len <= 0) {
+        return;
+    }
+    double nx = -dir.y / len;
+    double ny = dir.x / len;
+    theta = atan2(ny, nx);
+    r = (points[0].x - c.x) * nx + (points[0].y - c.y) * ny;
+    if (theta < 0) {
+        theta += CV_PI;
+        r = -r;
+    }
+}
+
+/* point through a homography */
+static cv::Point2f img_proc_point_to_board(const cv::Matx33d& H, cv::Point2f p) {
+
+    Vec3d q = H * Vec3d(p.x, p.y, 1.0);
+    return Point2f((float)(q[0] / q[2]), (float)(q[1] / q[2]));
+}
+
+
 
-        /* sharpend images */
-        //string image_sharp = string("Image Sharp (").append(CamNameId).append(" Cam)");
-        //string image_sharp_gray = string("Image Sharp Gray (").append(CamNameId).append(" Cam)");
-        //cv::imshow(image_sharp, cur_sharp);
-        //cv::imshow(image_sharp_gray, cur_sharp_gray);
+/***
+ *
+ * img_proc_show_debug(const struct img_proc_debug_s* debug, int show_imgs, std::string CamNameId)
+ *
+ * Display the intermediate images of img_proc_get_line_debug()
+ *
+ *
+ * @param:	const struct img_proc_debug_s* debug --> intermediate images
+ * @param:  int show_imgs --> defines Image to be displayed
+ * @param   std::string CamNameId --> Name displayed Windows
+ *
+ *
+ * @return: void
+ *
+ *
+ * @note:   Empty images are skipped.
+ *
+ *
+ * Example usage: None
+ *
+***/
+void img_proc_show_debug(const struct img_proc_debug_s* debug, int show_imgs, std::string CamNameId) {
+
+    if (show_imgs == SHOW_ALL_IMAGES) {
+
+        /* curent image plots */
+        img_proc_show(string("Current Image (").append(CamNameId).append(" Cam)"), debug->cur);
+        img_proc_show(string("Current Image Gray (").append(CamNameId).append(" Cam)"), debug->cur_gray);
 
         /* difference images */
-        //string image_diff_basic = string("Image Diff (").append(CamNameId).append(" Cam)");
-        string image_diff_gray = string("Image Diff Gray (").append(CamNameId).append(" Cam)");
-        //string image_diff_sharp = string("Image Diff Sharp (").append(CamNameId).append(" Cam)");
-        //string image_diff_sharp_gray = string("Image Diff Sharp Gray (").append(CamNameId).append(" Cam)");
-        //cv::imshow(image_diff_basic, diff);
-        cv::imshow(image_diff_gray, diff_gray);
-        //cv::imshow(image_diff_sharp, diff_sharp);
-        //cv::imshow(image_diff_sharp_gray, diff_sharp_gray);
+        img_proc_show(string("Image Diff Gray (").append(CamNameId).append(" Cam)"), debug->diff_gray);
 
         /* sharpened images after diff */
-        //string image_sharp_diff = string("Image Sharpened After Diff (").append(CamNameId).append(" Cam)");
-        string image_sharp_diff_gray = string("Image Sharpened After Diff Gray (").append(CamNameId).append(" Cam)");
-        //cv::imshow(image_sharp_diff, sharp_after_diff);
-        cv::imshow(image_sharp_diff_gray, sharp_after_diff_gray);
-
+        img_proc_show(string("Image Sharpened After Diff Gray (").append(CamNameId).append(" Cam)"), debug->sharp_after_diff_gray);
 
         /* edge image */
-        string image_edge = string("Edge Image (").append(CamNameId).append(" Cam)");
-        cv::imshow(image_edge, edge);
+        img_proc_show(string("Edge Image (").append(CamNameId).append(" Cam)"), debug->edge);
         /* edge binary image */
-        string image_edge_bin = string("Image Edge Bin (").append(CamNameId).append(" Cam)");
-        //cv::imshow(image_edge_bin, edge_bin);
-        cv::imshow(image_edge_bin, edge_bin_cont);
+        img_proc_show(string("Image Edge Bin (").append(CamNameId).append(" Cam)"), debug->edge_bin_cont);
 
         /* Hough transform (line images) */
-        string image_orig = string("Image Orig with line (").append(CamNameId).append(" Cam)");
-        cv::imshow(image_orig, cur_line);
-        // redundant string image_edge = string("Edge Image ").append(CamNameId);
-        string image_hspace = string("HoughSpace (").append(CamNameId).append(" Cam)");
-        cv::imshow(image_hspace, houghSpace);
-
-
-        return EXIT_SUCCESS;
-
+        img_proc_show(string("Image Orig with line (").append(CamNameId).append(" Cam)"), debug->cur_line);
+        img_proc_show(string("HoughSpace (").append(CamNameId).append(" Cam)"), debug->hough_space);
     }
     else if (show_imgs == SHOW_SHORT_ANALYSIS) {
 
         /* Hough transform (line images) */
-        string image_orig = string("1 Image Orig with line (").append(CamNameId).append(" Cam)");
-        cv::imshow(image_orig, cur_line);
-        //string wimg_write = image_orig.append(".jpg");
-        //cv::imwrite(image_orig, cur_line);
+        img_proc_show(string("1 Image Orig with line (").append(CamNameId).append(" Cam)"), debug->cur_line);
+        /* edge binary image */
+        img_proc_show(string("3 Image Edge Bin (").append(CamNameId).append(" Cam)"), debug->edge_bin_cont);
+    }
+    else if (show_imgs == SHOW_IMG_LINE) {
+        /* Hough transform (line images) */
+        img_proc_show(string("Image Orig with line (").append(CamNameId).append(" Cam)"), debug->cur_line);
+    }
+    else if (show_imgs == SHOW_EDGE_IMG) {
         /* edge image */
-        //string image_edge = string("2 Edge Image (").append(CamNameId).append(" Cam)");
-        //cv::imshow(image_edge, edge);
+        img_proc_show(string("Edge Image (").append(CamNameId).append(" Cam)"), debug->edge);
+    }
+    else if (show_imgs == SHOW_EDGE_BIN) {
         /* edge binary image */
-        string image_edge_bin = string("3 Image Edge Bin (").append(CamNameId).append(" Cam)");
-        //cv::imshow(image_edge_bin, edge_bin);
-        cv::imshow(image_edge_bin, edge_bin_cont);
-        //string img_write = image_edge_bin.append(".jpg");
-        //cv::imwrite(img_write, edge_bin_cont);
+        img_proc_show(string("Image Edge Bin (").append(CamNameId).append(" Cam)"), debug->edge_bin_cont);
+    }
+    else if (show_imgs == SHOW_SHARP_AFTER_DIFF) {
         /* sharpened images after diff */
-        //string image_sharp_diff = string("Image Sharpened After Diff (").append(CamNameId).append(" Cam)");
-        //string image_sharp_diff_gray = string("4 Image Sharpened After Diff Gray (").append(CamNameId).append(" Cam)");
-        //cv::imshow(image_sharp_diff, sharp_after_diff);
-        //cv::imshow(image_sharp_diff_gray, sharp_after_diff_gray);
-        return EXIT_SUCCESS;
+        img_proc_show(string("Image Sharpened After Diff Gray (").append(CamNameId).append(" Cam)"), debug->sharp_after_diff_gray);
     }
+}
 
 
-    if (show_imgs == SHOW_IMG_LINE) {
-        /* Hough transform (line images) */
-        string image_orig = string("Image Orig with line (").append(CamNameId).append(" Cam)");
-        cv::imshow(image_orig, cur_line);
-        //cv::imwrite(image_orig, cur_line);
+/* imshow() of a debug image, stages which have not been reached are empty */
+static void img_proc_show(const std::string& name, const cv::Mat& img) {
+
+    if (!img.empty()) {
+        cv::imshow(name, img);
     }
-    if (show_imgs == SHOW_EDGE_IMG) {
-        /* edge image */
-        string image_edge = string("Edge Image (").append(CamNameId).append(" Cam)");
-        cv::imshow(image_edge, edge);
+}
+
+
+
+/******************************************************************************
+ * Image Processing Help Functions
+ ******************************************************************************/
+ /***
+  *
+  * img_proc_sharpen_img(const cv::Mat& inputImage, cv::Mat& outputImage)
+  *
+  * Image Sharpening
+  *
+  *
+  * @param: const cv::Mat& inputImage --> Image to be sharpened
+  * @param: cv::Mat& outputImage --> sharpened Image 
+  *          
+  *
+  *
+  * @return: void
+  *
+  *
+  * @note:	None
+  *
+  *
+  * Example usage: None
+  *
+ ***/
+void img_proc_sharpen_img(const cv::Mat& inputImage, cv::Mat& outputImage) {
+    /* define sharpening kernel */
+    /* Mat kernel = (Mat_<float>(3, 3) <<
+        0, -1, 0,
+        -1, 5, -1,
+        0, -1, 0);*/
+    Mat kernel = (Mat_<float>(3, 3) <<
+        0, -1, 0,
+        -1, SHARPEN_KERNEL_CENTER, -1,
+        0, -1, 0);
+
+    /* sharpen */
+    filter2D(inputImage, outputImage, -1, kernel);
+}
+
+
+
+/* draw main axis */
+void drawLine(cv::Mat& img, cv::Point p, cv::Vec2f dir, cv::Scalar color, int length) {
+    cv::Point p1 = p + cv::Point(dir[0] * length, dir[1] * length);
+    cv::Point p2 = p - cv::Point(dir[0] * length, dir[1] * length);
+    cv::line(img, p1, p2, color, 2);
+}
+
+/* get polar coordinates (r, theta) from main axis (line) */
+void calculatePolarCoordinates(cv::Point2f p, cv::Vec2f dir, cv::Mat& img, float& r, float& theta) {
+
+    /* image center */
+    cv::Point center(img.cols / 2, img.rows / 2);
+
+    /* normal vector of line */
+    cv::Vec2f normal(-dir[1], dir[0]);
+
+    /* get angle theta from normal vector[-pi / 2 und pi / 2] */
+    theta = std::atan2(normal[1], normal[0]);
+
+    /* get distance r of line to image center */
+    r = (p.x - center.x) * normal[0] + (p.y - center.y) * normal[1];
+
+    /* shift angle [0, pi] */
+    if (theta < 0) {
+        theta += CV_PI;
+        r = -r;
     }
-    if (show_imgs == SHOW_EDGE_BIN) {
-        /* edge binary image */
-        string image_edge_bin = string("Image Edge Bin (").append(CamNameId).append(" Cam)");
-        //cv::imshow(image_edge_bin, edge_bin);
-        cv::imshow(image_edge_bin, edge_bin_cont);
+
+}
+
+/* extract roatetd rect from center and main axis */
+cv::Mat getRotatedROI(const cv::Mat& img, cv::Point2f center, cv::Vec2f axis, int width, int height) {
+    /* calc rot matrix */
+    double angle = atan2(axis[1], axis[0]) * 180.0 / CV_PI;
+    cv::Mat rotationMatrix = cv::getRotationMatrix2D(center, angle, 1.0);
+
+    /* rotate original image */
+    cv::Mat rotatedImg;
+    cv::warpAffine(img, rotatedImg, rotationMatrix, img.size(), cv::INTER_LINEAR, cv::BORDER_CONSTANT, cv::Scalar(0));
+
+    /* define new roi window */
+    cv::Rect roiRect(center.x - width / 2, center.y - height / 2, width, height);
+
+    /* boundaries */
+    roiRect &= cv::Rect(0, 0, img.cols, img.rows);
+
+    return rotatedImg(roiRect);
+}
+
+
+/* draw rotated rect */
+void drawRotatedRect(cv::Mat& img, cv::RotatedRect rRect, cv::Scalar color) {
+    cv::Point2f vertices[4];
+    rRect.points(vertices);
+    for (int i = 0; i < 4; i++) {
+        cv::line(img, vertices[i], vertices[(i + 1) % 4], color, 2);
+    }
+}
+
+
+/* get the pixels of a binary image inside a rotated rect, only the bounding rect is scanned */
+void img_proc_band_points(const cv::Mat& bin, const cv::RotatedRect& band, std::vector<cv::Point>& points) {
+
+    /* band axis and normal */
+    float angle = band.angle * CV_PI / 180.0;
+    float ax = std::cos(angle);
+    float ay = std::sin(angle);
+    float half_len = band.size.width / 2;
+    float half_width = band.size.height / 2;
+
+    cv::Rect scan = band.boundingRect() & cv::Rect(0, 0, bin.cols, bin.rows);
+
+    /* row stripes of the bounding rect in parallel */
+    ip::parallelGather(scan.height, 0, points, [&](int begin, int end, std::vector<cv::Point>& local) {
+        for (int y = scan.y + begin; y < scan.y + end; y++) {
+            const uchar* row = bin.ptr<uchar>(y);
+            float dy = y - band.center.y;
+            for (int x = scan.x; x < scan.x + scan.width; x++) {
+                if (row[x] != 255) {
+                    continue;
+                }
+                float dx = x - band.center.x;
+                if (std::abs(dx * ax + dy * ay) <= half_len && std::abs(dy * ax - dx * ay) <= half_width) {
+                    local.push_back(cv::Point(x, y));
+                }
+            }
+        }
+    });
+}
+
+
+/* get the edge pixels of an edge list inside a rotated rect */
+void img_proc_band_points(const ip::EdgeList& edges, const cv::RotatedRect& band, std::vector<cv::Point>& points) {
+
+    /* band axis and normal */
+    float angle = band.angle * CV_PI / 180.0;
+    float ax = std::cos(angle);
+    float ay = std::sin(angle);
+    float half_len = band.size.width / 2;
+    float half_width = band.size.height / 2;
+
+    /* chunks of the edge list in parallel */
+    ip::parallelGather((int)edges.size(), BAND_POINTS_GRAIN, points, [&](int begin, int end, std::vector<cv::Point>& local) {
+        for (int i = begin; i < end; i++) {
+            float dx = edges.x[i] - band.center.x;
+            float dy = edges.y[i] - band.center.y;
+            if (std::abs(dx * ax + dy * ay) <= half_len && std::abs(dy * ax - dx * ay) <= half_width) {
+                local.push_back(cv::Point(edges.x[i], edges.y[i]));
+            }
+        }
+    });
+}
+
+
+/***
+ *
+ * img_proc_cluster_line(const cv::Mat& cluster_img, const ip::EdgeList& edges, cv::Rect roi, struct cluster_line_s* cl)
+ *
+ * Main axis of the dart cluster inside one roi (coarse-to-fine)
+ * --> first pca on the coarse cluster pixels of the roi, second pca in a
+ * rotated roi around this axis and a robust fit on the full resolution edge
+ * pixels in a narrow band around the second axis
+ *
+ *
+ * @param:  const cv::Mat& cluster_img --> coarse (pyrDown'ed) binary cluster image
+ * @param:  const ip::EdgeList& edges --> full resolution edge pixels
+ * @param:  cv::Rect roi --> roi in coarse coordinates
+ * @param:  struct cluster_line_s* cl --> return axes, band and band pixels (full resolution)
+ *
+ *
+ * @return: int status
+ *
+ *
+ * @note:   None
+ *
+ *
+ * Example usage: None
+ *
+***/
+static int img_proc_cluster_line(const cv::Mat& cluster_img, const ip::EdgeList& edges, cv::Rect roi, struct cluster_line_s* cl) {
+
+    int ctf_levels = img_proc.ctf_levels;
+    float ctf_scale = (float)(1 << ctf_levels);
+
+    /* extract pxiels from roi (row stripes in parallel) */
+    vector<Point> points_roi;
+    ip::parallelGather(roi.height, 0, points_roi, [&](int begin, int end, vector<Point>& local) {
+        for (int y = roi.y + begin; y < roi.y + end; y++) {
+            const uchar* row = cluster_img.ptr<uchar>(y);
+            for (int x = roi.x; x < roi.x + roi.width; x++) {
+                if (row[x] == 255) {
+                    local.push_back(Point(x, y));
+                }
+            }
+        }
+    });
+    if (points_roi.size() < 2) {
+        return EXIT_FAILURE;
+    }
+
+    /* pca */
+    Mat data_roi(points_roi.size(), 2, CV_32F);    
+    for (size_t i = 0; i < points_roi.size(); i++) {
+        data_roi.at<float>(i, 0) = points_roi[i].x;
+        data_roi.at<float>(i, 1) = points_roi[i].y;
+    }
+    PCA pca_roi(data_roi, Mat(), PCA::DATA_AS_ROW);
+
+    /* main axis and centroid of cluster */
+    Vec2f mainAxis_roi(pca_roi.eigenvectors.row(0));
+    Point2f centroid_roi(pca_roi.mean.at<float>(0, 0), pca_roi.mean.at<float>(0, 1));
+
+    cl->roi = Rect(roi.x << ctf_levels, roi.y << ctf_levels, roi.width << ctf_levels, roi.height << ctf_levels);
+    cl->centroid_roi = centroid_roi * ctf_scale;
+    cl->axis_roi = mainAxis_roi;
+
+
+    /*** 
+     * do second cluster analysis with optimized roi 
+    ***/
+
+    /* size of rotated rect (full resolution) */
+    float roiWidth2 = CTF_BAND_WIDTH;       // +/-15 pixel around axis, should fit barrel and flight 
+    /* length of new roi is length of diagonal of old roi */
+    float roiHeight2 = std::sqrt(cl->roi.width * cl->roi.width + cl->roi.height * cl->roi.height); 
+
+    /* roatetd rect with old main axis as angle */
+    RotatedRect rotatedROI(centroid_roi, Size2f(roiHeight2 / ctf_scale, roiWidth2 / ctf_scale), atan2(mainAxis_roi[1], mainAxis_roi[0]) * 180.0 / CV_PI);
+
+    /* extract pixels from new roi */
+    vector<Point> roiPoints;
+    img_proc_band_points(cluster_img, rotatedROI, roiPoints);
+    if (roiPoints.size() < 2) {
+        return EXIT_FAILURE;
+    }
+
+    /* second pca in rotated roi */
+    Mat roiData(roiPoints.size(), 2, CV_32F);
+    for (size_t i = 0; i < roiPoints.size(); i++) {
+        roiData.at<float>(i, 0) = roiPoints[i].x;
+        roiData.at<float>(i, 1) = roiPoints[i].y;
+    }
+    PCA pca2(roiData, Mat(), PCA::DATA_AS_ROW);
+    cl->centroid = Point2f(pca2.mean.at<float>(0, 0), pca2.mean.at<float>(0, 1)) * ctf_scale;
+    cl->axis = Vec2f(pca2.eigenvectors.row(0));
+
+
+    /***
+     * refine main axis on the full resolution edge pixels in a narrow band around the
+     * coarse axis with a robust fit, only the edge list is scanned
+    ***/
+    cl->band = RotatedRect(cl->centroid, Size2f(roiHeight2, roiWidth2), atan2(cl->axis[1], cl->axis[0]) * 180.0 / CV_PI);
+
+    img_proc_band_points(edges, cl->band, cl->band_points);
+    if (img_proc_fit_line_robust(cl->band_points, cl->centroid, cl->axis, &cl->conf) != EXIT_SUCCESS) {
+        return EXIT_FAILURE;
+    }
+    cl->conf.cluster_area = points_roi.size() * ctf_scale * ctf_scale;
+
+    return EXIT_SUCCESS;
+}
+
+
+/* check if two lines in polar coordinates describe the same dart */
+bool img_proc_same_line(double r1, double theta1, double r2, double theta2) {
+
+    /* theta is in [0, pi], lines close to theta = 0 and theta = pi have flipped r */
+    double d_theta = fabs(theta1 - theta2);
+    double d_r = fabs(r1 - r2);
+    if (d_theta > CV_PI / 2) {
+        d_theta = CV_PI - d_theta;
+        d_r = fabs(r1 + r2);
+    }
+
+    return (d_theta < CAND_SAME_THETA) && (d_r < CAND_SAME_R);
+}
+
+
+
+/***
+ *
+ * img_proc_fit_line_robust(const std::vector<cv::Point>& points, cv::Point2f& centroid, cv::Vec2f& axis, struct line_conf_s* conf)
+ *
+ * Robust sub-pixel line fit through edge pixels
+ * --> iteratively reweighted total least squares with Tukey biweight, the
+ * residual scale is estimated from the median absolute deviation
+ *
+ *
+ * @param:  const std::vector<cv::Point>& points --> edge pixels (e.g. inside the rotated band)
+ * @param:  cv::Point2f& centroid --> return weighted centroid of the line
+ * @param:  cv::Vec2f& axis --> return unit direction of the line
+ * @param:  struct line_conf_s* conf --> return inlier count, residual rms and
+ *          angular uncertainty (cluster_area is left untouched)
+ *
+ *
+ * @return: int status
+ *
+ *
+ * @note:   The first iteration is an ordinary PCA, outliers like flight edges
+ *          or parts of other darts are down-weighted in the following ones.
+ *
+ *
+ * Example usage: None
+ *
+***/
+int img_proc_fit_line_robust(const std::vector<cv::Point>& points, cv::Point2f& centroid, cv::Vec2f& axis, struct line_conf_s* conf) {
+
+    size_t n = points.size();
+    if (n < 2) {
+        return EXIT_FAILURE;
+    }
+
+    vector<double> w(n, 1.0);
+    vector<double> res(n);
+    vector<double> abs_res(n);
+    double cx = 0, cy = 0, ax = 1, ay = 0;
+    double c = 0;
+
+    for (int it = 0; it < IRLS_MAX_ITER; it++) {
+
+        /* weighted centroid */
+        double sw = 0, sx = 0, sy = 0;
+        for (size_t i = 0; i < n; i++) {
+            sw += w[i];
+            sx += w[i] * points[i].x;
+            sy += w[i] * points[i].y;
+        }
+        if (sw <= 0) {
+            return EXIT_FAILURE;
+        }
+        double cx_new = sx / sw;
+        double cy_new = sy / sw;
+
+        /* weighted covariance --> main axis */
+        double sxx = 0, syy = 0, sxy = 0;
+        for (size_t i = 0; i < n; i++) {
+            double dx = points[i].x - cx_new;
+            double dy = points[i].y - cy_new;
+            sxx += w[i] * dx * dx;
+            syy += w[i] * dy * dy;
+            sxy += w[i] * dx * dy;
+        }
+        double phi = 0.5 * atan2(2 * sxy, sxx - syy);
+        double ax_new = cos(phi);
+        double ay_new = sin(phi);
+
+        bool converged = (it > 0) && (fabs(ax_new * ay - ay_new * ax) < 1e-5) && (fabs(cx_new - cx) + fabs(cy_new - cy) < 1e-3);
+        cx = cx_new;
+        cy = cy_new;
+        ax = ax_new;
+        ay = ay_new;
+
+        /* normal distances to the line */
+        for (size_t i = 0; i < n; i++) {
+            res[i] = (points[i].y - cy) * ax - (points[i].x - cx) * ay;
+            abs_res[i] = fabs(res[i]);
+        }
+
+        /* robust scale from the median absolute residual */
+        std::nth_element(abs_res.begin(), abs_res.begin() + n / 2, abs_res.end());
+        double sigma = std::max(1.4826 * abs_res[n / 2], (double)IRLS_SIGMA_MIN);
+        c = IRLS_TUKEY_C * sigma;
+
+        if (converged) {
+            break;
+        }
+
+        /* tukey biweights */
+        for (size_t i = 0; i < n; i++) {
+            double u = res[i] / c;
+            w[i] = (fabs(u) < 1) ? (1 - u * u) * (1 - u * u) : 0;
+        }
+    }
+
+    /* quality of the fit */
+    int inliers = 0;
+    double sum_res2 = 0;
+    double sum_axial2 = 0;
+    for (size_t i = 0; i < n; i++) {
+        if (fabs(res[i]) < c) {
+            double s = (points[i].x - cx) * ax + (points[i].y - cy) * ay;
+            inliers++;
+            sum_res2 += res[i] * res[i];
+            sum_axial2 += s * s;
+        }
+    }
+
+    centroid = Point2f((float)cx, (float)cy);
+    axis = Vec2f((float)ax, (float)ay);
+
+    if (conf != nullptr) {
+        conf->inliers = inliers;
+        conf->rms = (inliers > 0) ? sqrt(sum_res2 / inliers) : 0;
+        conf->theta_sigma = (sum_axial2 > 0) ? conf->rms / sqrt(sum_axial2) : CV_PI;
+    }
+
+    return (inliers >= 2) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+
+/***
+ *
+ * img_proc_find_tip(const std::vector<cv::Point>& points, cv::Point2f centroid, cv::Vec2f axis, cv::Point2f& tip)
+ *
+ * Dart tip localization along the main axis
+ * --> builds the edge density profile along the axis and walks from the
+ * centroid to the tip side until the density drops
+ *
+ *
+ * @param:  const std::vector<cv::Point>& points --> edge pixels of the dart (rotated band)
+ * @param:  cv::Point2f centroid --> point on the main axis
+ * @param:  cv::Vec2f axis --> unit direction of the main axis
+ * @param:  cv::Point2f& tip --> return tip position on the main axis
+ *
+ *
+ * @return: bool --> true if a tip has been found
+ *
+ *
+ * @note:   The tip side is the half of the cluster with the smaller spread
+ *          perpendicular to the axis, the flight is always the wide end.
+ *
+ *
+ * Example usage: None
+ *
+***/
+bool img_proc_find_tip(const std::vector<cv::Point>& points, cv::Point2f centroid, cv::Vec2f axis, cv::Point2f& tip) {
+
+    if (points.size() < 2) {
+        return false;
+    }
+
+    /* axial and normal coordinates of every pixel */
+    vector<float> axial(points.size());
+    float s_min = 0, s_max = 0;
+    double spread_pos = 0, spread_neg = 0;
+    int count_pos = 0, count_neg = 0;
+    for (size_t i = 0; i < points.size(); i++) {
+        float dx = points[i].x - centroid.x;
+        float dy = points[i].y - centroid.y;
+        float s = dx * axis[0] + dy * axis[1];
+        float d = std::abs(dy * axis[0] - dx * axis[1]);
+        axial[i] = s;
+        s_min = std::min(s_min, s);
+        s_max = std::max(s_max, s);
+        if (s >= 0) {
+            spread_pos += d;
+            count_pos++;
+        }
+        else {
+            spread_neg += d;
+            count_neg++;
+        }
     }
-    if (show_imgs == SHOW_SHARP_AFTER_DIFF) {
-        /* sharpened images after diff */
-        //string image_sharp_diff = string("Image Sharpened After Diff (").append(CamNameId).append(" Cam)");
-        string image_sharp_diff_gray = string("Image Sharpened After Diff Gray (").append(CamNameId).append(" Cam)");
-        //cv::imshow(image_sharp_diff, sharp_after_diff);
-        cv::imshow(image_sharp_diff_gray, sharp_after_diff_gray);
+    if ((count_pos == 0) || (count_neg == 0)) {
+        return false;
     }
 
+    /* narrow half --> tip side */
+    int dir = ((spread_pos / count_pos) < (spread_neg / count_neg)) ? 1 : -1;
 
-    return EXIT_SUCCESS;
-
-}
+    /* axial edge density profile, bin 'zero_bin' holds the centroid */
+    int zero_bin = (int)std::ceil(-s_min / TIP_BIN_SIZE);
+    int num_bins = zero_bin + (int)std::ceil(s_max / TIP_BIN_SIZE) + 1;
+    vector<int> profile(num_bins, 0);
+    for (float s : axial) {
+        int b = zero_bin + (int)std::floor(s / TIP_BIN_SIZE + 0.5f);
+        if ((b >= 0) && (b < num_bins)) {
+            profile[b]++;
+        }
+    }
 
+    /* density threshold from the median of the occupied bins */
+    vector<int> occupied;
+    for (int c : profile) {
+        if (c > 0) {
+            occupied.push_back(c);
+        }
+    }
+    std::nth_element(occupied.begin(), occupied.begin() + occupied.size() / 2, occupied.end());
+    int min_count = std::max(1, (int)(TIP_DENSITY_RATIO * occupied[occupied.size() / 2]));
 
+    /* walk from the centroid to the tip side until the barrel ends */
+    int last_dense = zero_bin;
+    int gap = 0;
+    for (int b = zero_bin; (b >= 0) && (b < num_bins); b += dir) {
+        if (profile[b] >= min_count) {
+            last_dense = b;
+            gap = 0;
+        }
+        else if (++gap >= TIP_MAX_GAP) {
+            break;
+        }
+    }
 
-/******************************************************************************
- * Image Processing Help Functions
- ******************************************************************************/
- /***
-  *
-  * img_proc_sharpen_img(const cv::Mat& inputImage, cv::Mat& outputImage)
-  *
-  * Image Sharpening
-  *
-  *
-  * @param: const cv::Mat& inputImage --> Image to be sharpened
-  * @param: cv::Mat& outputImage --> sharpened Image 
-  *          
-  *
-  *
-  * @return: void
-  *
-  *
-  * @note:	None
-  *
-  *
-  * Example usage: None
-  *
- ***/
-void img_proc_sharpen_img(const cv::Mat& inputImage, cv::Mat& outputImage) {
-    /* define sharpening kernel */
-    /* Mat kernel = (Mat_<float>(3, 3) <<
-        0, -1, 0,
-        -1, 5, -1,
-        0, -1, 0);*/
-    Mat kernel = (Mat_<float>(3, 3) <<
-        0, -1, 0,
-        -1, 11, -1,
-        0, -1, 0);
+    float s_tip = (last_dense - zero_bin) * TIP_BIN_SIZE + dir * 0.5f * TIP_BIN_SIZE;
+    tip = Point2f(centroid.x + s_tip * axis[0], centroid.y + s_tip * axis[1]);
 
-    /* sharpen */
-    filter2D(inputImage, outputImage, -1, kernel);
+    return true;
 }
 
 
+/* 
+ * print the quality of an extracted line, used to monitor the cameras; with
+ * SHOW_NO_IMAGES (production) only missing and low confidence lines are printed
+ */
+void img_proc_print_line_conf(int status, struct line_s* line, std::string CamNameId) {
 
-/* draw main axis */
-void drawLine(cv::Mat& img, cv::Point p, cv::Vec2f dir, cv::Scalar color, int length) {
-    cv::Point p1 = p + cv::Point(dir[0] * length, dir[1] * length);
-    cv::Point p2 = p - cv::Point(dir[0] * length, dir[1] * length);
-    cv::line(img, p1, p2, color, 2);
+    if (status != EXIT_SUCCESS) {
+        std::cout << "[WARNING] " << CamNameId << " Cam: no line detected" << std::endl;
+        return;
+    }
+
+    bool low = (line->conf.inliers == 0) || (line->conf.rms > LINE_CONF_RMS_WARN) || (line->conf.theta_sigma > LINE_CONF_THETA_SIGMA_WARN);
+    if (!low && (img_proc.show_imgs == SHOW_NO_IMAGES)) {
+        return;
+    }
+
+    std::cout << (low ? "[WARNING] " : "") << CamNameId << " Cam line: r = " << line->r << ", theta = " << line->theta
+        << " | inliers: " << line->conf.inliers
+        << ", rms: " << line->conf.rms
+        << ", theta sigma: " << line->conf.theta_sigma
+        << ", cluster area: " << line->conf.cluster_area << std::endl;
 }
 
-/* get polar coordinates (r, theta) from main axis (line) */
-void calculatePolarCoordinates(cv::Point p, cv::Vec2f dir, cv::Mat& img, float& r, float& theta) {
 
-    /* image center */
-    cv::Point center(img.cols / 2, img.rows / 2);
+/* get the footprint store of a camera perspective */
+static vector<RotatedRect>* img_proc_get_footprints(int ThreadId) {
 
-    /* normal vector of line */
-    cv::Vec2f normal(-dir[1], dir[0]);
+    if ((ThreadId < 0) || (ThreadId >= RIG_CAMS_MAX)) {
+        return nullptr;
+    }
 
-    /* get angle theta from normal vector[-pi / 2 und pi / 2] */
-    theta = std::atan2(normal[1], normal[0]);
+    return &img_proc.footprints[ThreadId];
+}
 
-    /* get distance r of line to image center */
-    r = (p.x - center.x) * normal[0] + (p.y - center.y) * normal[1];
+/* clear footprints of all cameras, call this when the darts are removed from the board */
+void img_proc_footprint_clear(void) {
 
-    /* shift angle [0, pi] */
-    if (theta < 0) {
-        theta += CV_PI;
-        r = -r;
+    for (int i = 0; i < RIG_CAMS_MAX; i++) {
+        img_proc.footprints[i].clear();
     }
-
 }
 
-/* extract roatetd rect from center and main axis */
-cv::Mat getRotatedROI(const cv::Mat& img, cv::Point2f center, cv::Vec2f axis, int width, int height) {
-    /* calc rot matrix */
-    double angle = atan2(axis[1], axis[0]) * 180.0 / CV_PI;
-    cv::Mat rotationMatrix = cv::getRotationMatrix2D(center, angle, 1.0);
+/* 
+ * store the footprint of the selected candidate of a line, call this after
+ * img_proc_cross_point_math() so a wrong main line does not erase the other dart;
+ * a camera rejected by the fusion stores the candidate through the cross point
+ * (within XP_REJECT_DIST) or nothing, it has locked onto another edge
+ */
+void img_proc_footprint_store(const struct line_s* line, int ThreadId, cv::Size frameSize, const struct cross_point_s* cross) {
 
-    /* rotate original image */
-    cv::Mat rotatedImg;
-    cv::warpAffine(img, rotatedImg, rotationMatrix, img.size(), cv::INTER_LINEAR, cv::BORDER_CONSTANT, cv::Scalar(0));
+    vector<RotatedRect>* footprints = img_proc_get_footprints(ThreadId);
+    if ((footprints == nullptr) || !line->valid || (line->selected >= line->num_candidates)) {
+        return;
+    }
 
-    /* define new roi window */
-    cv::Rect roiRect(center.x - width / 2, center.y - height / 2, width, height);
+    bool rejected = false;
+    for (const auto& reject : cross->rejected) {
+        rejected |= (reject.line == ThreadId);
+    }
 
-    /* boundaries */
-    roiRect &= cv::Rect(0, 0, img.cols, img.rows);
+    int selected = line->selected;
+    if (rejected) {
+        /* candidate closest to the cross point, r is around the image center */
+        Point2d p(cross->p.x - frameSize.width / 2, cross->p.y - frameSize.height / 2);
+        double d_min = XP_REJECT_DIST;
+        selected = -1;
+        for (int i = 0; i < line->num_candidates; i++) {
+            const struct line_cand_s& cand = line->candidates[i];
+            double d = fabs(p.x * cos(cand.theta) + p.y * sin(cand.theta) - cand.r);
+            if (d <= d_min) {
+                d_min = d;
+                selected = i;
+            }
+        }
+        if (selected < 0) {
+            return;
+        }
+    }
 
-    return rotatedImg(roiRect);
+    const struct line_cand_s& cand = line->candidates[selected];
+    if (cand.band_valid) {
+        footprints->push_back(cand.band);
+    }
 }
 
+/* 
+ * function to erase double darts when following dart touched the dart before;
+ * every footprint stored in the current visit is removed from the edge list
+ */
+void cluster_erase(ip::EdgeList& edges, int ThreadId) {
 
-/* draw rotated rect */
-void drawRotatedRect(cv::Mat& img, cv::RotatedRect rRect, cv::Scalar color) {
-    cv::Point2f vertices[4];
-    rRect.points(vertices);
-    for (int i = 0; i < 4; i++) {
-        cv::line(img, vertices[i], vertices[(i + 1) % 4], color, 2);
+    vector<RotatedRect>* footprints = img_proc_get_footprints(ThreadId);
+    if (footprints == nullptr) {
+        return;
     }
-}
 
+    for (const auto& roi : *footprints) {
+        ip::edgeListEraseRotatedRect(edges, roi);
+    }
+}
 
 /* 
- * function to erase double darts when following dart touched the dart before
- * and to detect and cluster contours based on PCA orientation 
+ * function to erase double darts when following dart touched the dart before;
+ * every footprint stored in the current visit is masked out of the image
  */
 void cluster_erase(cv::Mat& image, int ThreadId) {
 
-    RotatedRect roi;
-
-    /* set last roi default zero */
-    switch (ThreadId) {
-    case TOP_CAM:
-        roi = img_proc.roi_last.top;
-        break;
-    case RIGHT_CAM:
-        roi = img_proc.roi_last.right;
-        break;
-    case LEFT_CAM:
-        roi = img_proc.roi_last.left;
-        break;
-    default:
-        break;
+    vector<RotatedRect>* footprints = img_proc_get_footprints(ThreadId);
+    if (footprints == nullptr) {
+        return;
     }
 
-    /* ro rect corners */
-    cv::Point2f vertices[4];
-    roi.points(vertices);
+    for (const auto& roi : *footprints) {
+        /* ro rect corners */
+        cv::Point2f vertices[4];
+        roi.points(vertices);
 
+        std::vector<cv::Point> polygon;
+        for (int i = 0; i < 4; i++) {
+            polygon.push_back(vertices[i]);
+        }
 
-    std::vector<cv::Point> polygon;
-    for (int i = 0; i < 4; i++) {
-        polygon.push_back(vertices[i]);
+        /* reset rot rect roi */
+        fillConvexPoly(image, polygon, cv::Scalar(0, 0, 0));
     }
 
-    /* reset last rot rect roi */
-    fillConvexPoly(image, polygon, cv::Scalar(0, 0, 0));
-
     return;
 
 #if 0
@@ -1016,15 +2210,19 @@ void img_proc_get_cross_points(const cv::Mat& image, std::vector<cv::Point>& max
     Mat image_gray;
     cvtColor(image, image_gray, COLOR_BGR2GRAY);
 
-    /* look up cross points */
-    for (int y = 0; y < image.rows; y++) {
-        uchar* row = image_gray.ptr<uchar>(y);
-        for (int x = 0; x < image_gray.cols; x++) {
-            if (image_gray.at<uchar>(y, x) > CROSS_POINT_INTENSITY_MIN) {
-                maxLocations.push_back(Point(x, y));
+    /* look up cross points (row stripes in parallel) */
+    vector<Point> points;
+    ip::parallelGather(image_gray.rows, 0, points, [&](int begin, int end, vector<Point>& local) {
+        for (int y = begin; y < end; y++) {
+            const uchar* row = image_gray.ptr<uchar>(y);
+            for (int x = 0; x < image_gray.cols; x++) {
+                if (row[x] > CROSS_POINT_INTENSITY_MIN) {
+                    local.push_back(Point(x, y));
+                }
             }
         }
-    }
+    });
+    maxLocations.insert(maxLocations.end(), points.begin(), points.end());
 
 }
 
@@ -1032,15 +2230,16 @@ void img_proc_get_cross_points(const cv::Mat& image, std::vector<cv::Point>& max
 
 /***
   *
-  * img_proc_cross_point(cv::Size frameSize, struct tripple_line_s* tri_line, cv::Point& cross_p) 
+  * img_proc_cross_point(cv::Size frameSize, struct line_s* const* lines, int num, cv::Point& cross_p) 
   *
-  * Grafic Method to find the midpoint of multiple intersections of three lines.
+  * Grafic Method to find the midpoint of multiple intersections of the lines.
   *
   *
   *
   * @param: cv::Size frameSize --> Size of calibrated Images
-  * @param: struct tripple_line_s* tri_line --> Input three lines in Polar 
-  *         Coordinates
+  * @param: struct line_s* const* lines --> Input lines in Polar Coordinates,
+  *         one per camera of the rig
+  * @param: int num --> number of lines
   * @param: cv::Point& cross_p --> return midpoint f intersections --> final 
   *         detection poont 
   *
@@ -1055,14 +2254,14 @@ void img_proc_get_cross_points(const cv::Mat& image, std::vector<cv::Point>& max
   * Example usage: None
   *
  ***/
-int img_proc_cross_point(cv::Size frameSize, struct tripple_line_s* tri_line, cv::Point& cross_p) {
+int img_proc_cross_point(cv::Size frameSize, struct line_s* const* lines, int num, cv::Point& cross_p) {
 
     Mat frame = Mat::zeros(frameSize, CV_8UC3);
 
 
-    ip::drawLine_light_add(frame, tri_line->line_top.r, tri_line->line_top.theta);
-    ip::drawLine_light_add(frame, tri_line->line_right.r, tri_line->line_right.theta);
-    ip::drawLine_light_add(frame, tri_line->line_left.r, tri_line->line_left.theta);
+    for (int i = 0; i < num; i++) {
+        ip::drawLine_light_add(frame, lines[i]->r, lines[i]->theta);
+    }
 
 
 
@@ -1165,19 +2364,158 @@ void img_proc_polar_to_cart(const cv::Mat& image, struct line_s l, struct line_c
 
 /***
   *
-  * img_proc_find_intersection(const line_cart_s& line1, const line_cart_s& line2, cv::Point& intersection)
+  * img_proc_select_candidates(cv::Size frameSize, struct line_s* const* lines, int num)
+  *
+  * 
+  * Joint selection of the candidate lines of all cameras. Every combination
+  * of candidates is intersected (weighted least squares as in
+  * img_proc_intersect_lines()) and the most consistent one (smallest
+  * residual and tip distance) is written to the lines.
+  *
+  *
+  * @param: cv::Size frameSize --> refered image size
+  * @param: struct line_s* const* lines --> lines with candidates in Polar Coordinates, one per camera
+  * @param: int num --> number of lines
+  *
+  *
+  * @return: void
+  *
+  *
+  * @note:  When two darts are close together each camera might pick
+  *         another dart as main line, this is solved here. The number of
+  *         combinations is LINE_CANDIDATES_MAX^num. Two lines always
+  *         intersect, with two cameras the tips of the candidates decide.
+  *
+  *
+  * Example usage: None
+  *
+ ***/
+void img_proc_select_candidates(cv::Size frameSize, struct line_s* const* lines, int num) {
+
+    /* candidates per camera, invalid cameras do not take part */
+    int num_cand[RIG_CAMS_MAX];
+    int valid_lines = 0;
+    num = std::min(num, RIG_CAMS_MAX);
+    bool choice = false;
+    for (int c = 0; c < num; c++) {
+        num_cand[c] = (lines[c]->valid && (lines[c]->num_candidates > 0)) ? lines[c]->num_candidates : 0;
+        valid_lines += (num_cand[c] > 0);
+        choice |= (num_cand[c] > 1);
+    }
+    if ((valid_lines < 2) || !choice) {
+        return;
+    }
+
+    /* evaluate all combinations, idx counts through the candidates of all cameras */
+    int idx[RIG_CAMS_MAX] = { 0 };
+    int best[RIG_CAMS_MAX] = { 0 };
+    double r[RIG_CAMS_MAX], theta[RIG_CAMS_MAX], w[RIG_CAMS_MAX];
+    const struct line_cand_s* cands[RIG_CAMS_MAX];
+    double best_cost = DBL_MAX;
+    bool done = false;
+    while (!done) {
+
+        /* least squares intersection, lines are n * p = r around the image center */
+        int n = 0;
+        int rank = 0;
+        for (int c = 0; c < num; c++) {
+            if (num_cand[c] == 0) {
+                continue;
+            }
+            cands[n] = &lines[c]->candidates[idx[c]];
+            r[n] = cands[n]->r;
+            theta[n] = cands[n]->theta;
+            w[n] = 1.0 / img_proc_line_var(&cands[n]->conf);
+            rank += idx[c];
+            n++;
+        }
+        Point2d p;
+        Matx22d normal_inv;
+        if (img_proc_lines_lsq(n, r, theta, w, p, normal_inv)
+            && (fabs(p.x) <= frameSize.width / 2) && (fabs(p.y) <= frameSize.height / 2)) {
+
+            /* weighted rms distance of the point to the lines, distance of the tips to the point */
+            double sum = 0;
+            double sum_w = 0;
+            double tip_sum = 0;
+            for (int i = 0; i < n; i++) {
+                double d = p.x * cos(theta[i]) + p.y * sin(theta[i]) - r[i];
+                sum += w[i] * d * d;
+                sum_w += w[i];
+                if (cands[i]->tip_valid) {
+                    Point2d tip(cands[i]->tip.x - frameSize.width / 2, cands[i]->tip.y - frameSize.height / 2);
+                    tip_sum += std::min(norm(tip - p), XP_TIP_DIST_MAX);
+                }
+                else {
+                    tip_sum += XP_TIP_DIST_MAX;
+                }
+            }
+            double cost = sqrt(sum / sum_w) + CAND_TIP_WEIGHT * tip_sum / n + CAND_RANK_PENALTY * rank;
+
+            if (cost < best_cost) {
+                best_cost = cost;
+                std::copy(idx, idx + num, best);
+            }
+        }
+
+        /* next combination */
+        int c = 0;
+        for (; c < num; c++) {
+            if (++idx[c] < std::max(num_cand[c], 1)) {
+                break;
+            }
+            idx[c] = 0;
+        }
+        done = (c == num);
+    }
+
+    /* write the selected candidates to the lines */
+    for (int c = 0; c < num; c++) {
+        if ((num_cand[c] == 0) || (best[c] == 0)) {
+            continue;
+        }
+        const struct line_cand_s& cand = lines[c]->candidates[best[c]];
+        lines[c]->r = cand.r;
+        lines[c]->theta = cand.theta;
+        lines[c]->conf = cand.conf;
+        lines[c]->tip = cand.tip;
+        lines[c]->tip_valid = cand.tip_valid;
+        lines[c]->selected = best[c];
+    }
+}
+
+
+
+/*
+ * variance of a line for the least squares weights [pixel^2], a line without
+ * confidence (no inliers) counts as a low confidence line
+ */
+static double img_proc_line_var(const struct line_conf_s* conf) {
+
+    double rms = (conf->inliers > 0) ? conf->rms : LINE_CONF_RMS_WARN;
+    return XP_SIGMA_MIN * XP_SIGMA_MIN + rms * rms;
+}
+
+
+
+/***
   *
-  * get math intersection of two lines (cartesian coordinates)
+  * img_proc_lines_lsq(int num, const double* r, const double* theta, const double* w, cv::Point2d& p, cv::Matx22d& normal_inv)
   *
+  * 
+  * Closed form weighted least squares point of lines in Hesse normal form
+  * n * p = r, n = (cos(theta), sin(theta)): minimizes sum w * (n * p - r)^2
   *
-  * @param: const line_cart_s& line1 --> input line 01
-  * @param: const line_cart_s& line2 --> input line 02
-  * @param: cv::Point& intersection --> calculated intersection; set to 
-  *         (-66666,-66666) on error    
   *
+  * @param: int num --> number of lines
+  * @param: const double* r --> distances of the lines (around the image center)
+  * @param: const double* theta --> angles of the normals
+  * @param: const double* w --> weights, 1 / variance of the lines [1 / pixel^2]
+  * @param: cv::Point2d& p --> return point (around the image center)
+  * @param: cv::Matx22d& normal_inv --> return inverse normal matrix, covariance of p for w = 1 / variance
   *
   *
-  * @return: bool status
+  * @return: bool --> false for less than two (non parallel) lines
   *
   *
   * @note:	None
@@ -1186,208 +2524,509 @@ void img_proc_polar_to_cart(const cv::Mat& image, struct line_s l, struct line_c
   * Example usage: None
   *
  ***/
-bool img_proc_find_intersection(const line_cart_s& line1, const line_cart_s& line2, cv::Point& intersection) {
-    
-    /* first line */
-    float x0_1 = line1.p0.x, y0_1 = line1.p0.y;
-    float x1_1 = line1.p1.x, y1_1 = line1.p1.y;
-    
-    /* second line */
-    float x0_2 = line2.p0.x, y0_2 = line2.p0.y;
-    float x1_2 = line2.p1.x, y1_2 = line2.p1.y;
-
-    /* calc params for equation */
-    float A1 = y1_1 - y0_1;
-    float B1 = x0_1 - x1_1;
-    float C1 = x1_1 * y0_1 - x0_1 * y1_1;
-
-    float A2 = y1_2 - y0_2;
-    float B2 = x0_2 - x1_2;
-    float C2 = x1_2 * y0_2 - x0_2 * y1_2;
-
-    /* calc determinant */
-    float det = A1 * B2 - A2 * B1;
-
-    /* if determinant == 0 --> no cross point; set unrealistic point */
-    if (det == 0) {
-        intersection.x = -66666;
-        intersection.y = -66666;
+static bool img_proc_lines_lsq(int num, const double* r, const double* theta, const double* w, cv::Point2d& p, cv::Matx22d& normal_inv) {
+
+    /* normal equations: sum w * n * n^T * p = sum w * n * r */
+    double a11 = 0, a12 = 0, a22 = 0, b1 = 0, b2 = 0;
+    for (int i = 0; i < num; i++) {
+        double nx = cos(theta[i]);
+        double ny = sin(theta[i]);
+        a11 += w[i] * nx * nx;
+        a12 += w[i] * nx * ny;
+        a22 += w[i] * ny * ny;
+        b1 += w[i] * nx * r[i];
+        b2 += w[i] * ny * r[i];
+    }
+
+    /* (almost) parallel lines, the weights are normalized for the check */
+    double trace = a11 + a22;
+    double det = a11 * a22 - a12 * a12;
+    if ((num < 2) || (trace <= 0) || (det < XP_DET_MIN * trace * trace)) {
         return false;
     }
-    /* Note: usage of this macro at this point makes it easy but not generic anymore for other frame sizes */
-    if ((intersection.x < 0) || (intersection.x > RAW_CAL_IMG_WIDTH)) {
-        intersection.x = -66666;
-        intersection.y = -66666;
-        return false;
+
+    normal_inv = Matx22d(a22 / det, -a12 / det, -a12 / det, a11 / det);
+    p.x = (a22 * b1 - a12 * b2) / det;
+    p.y = (a11 * b2 - a12 * b1) / det;
+
+    return true;
+}
+
+
+
+/***
+  *
+  * img_proc_find_outlier(const struct line_s* const* lines, int n, const int* ids, const double* r, const double* theta, const double* w, cv::Size frameSize, struct line_reject_s* reject)
+  *
+  * 
+  * Pick the camera whose line is the outlier of an inconsistent intersection:
+  * every camera is left out once and the other lines are intersected, the
+  * most consistent rest wins.
+  *
+  *
+  * @param: const struct line_s* const* lines --> all lines, one per camera
+  * @param: int n --> number of lines taking part
+  * @param: const int* ids --> lines taking part
+  * @param: const double* r --> distances of these lines (around the image center)
+  * @param: const double* theta --> angles of these lines
+  * @param: const double* w --> weights of these lines
+  * @param: cv::Size frameSize --> refered image size
+  * @param: struct line_reject_s* reject --> return camera and reason
+  *
+  *
+  * @return: int --> position of the camera in ids, -1 if no camera explains the inconsistency
+  *
+  *
+  * @note:  With three cameras the other two lines always intersect; the
+  *         located tips of the remaining cameras decide then, without tips
+  *         the camera with the worst line fit is rejected.
+  *
+  *
+  * Example usage: None
+  *
+ ***/
+static int img_proc_find_outlier(const struct line_s* const* lines, int n, const int* ids, const double* r, const double* theta, const double* w, cv::Size frameSize, struct line_reject_s* reject) {
+
+    Point2d center(frameSize.width / 2, frameSize.height / 2);
+
+    /* tips only decide if every camera has one, otherwise cameras without tip are preferred */
+    bool all_tips = true;
+    for (int i = 0; i < n; i++) {
+        all_tips &= lines[ids[i]]->tip_valid;
+    }
+
+    double r_o[RIG_CAMS_MAX], theta_o[RIG_CAMS_MAX], w_o[RIG_CAMS_MAX];
+    int best = -1;
+    double best_cost = DBL_MAX;
+    for (int k = 0; k < n; k++) {
+
+        /* intersection without camera k */
+        int m = 0;
+        for (int i = 0; i < n; i++) {
+            if (i != k) {
+                r_o[m] = r[i];
+                theta_o[m] = theta[i];
+                w_o[m] = w[i];
+                m++;
+            }
+        }
+        Point2d p;
+        Matx22d normal_inv;
+        if (!img_proc_lines_lsq(m, r_o, theta_o, w_o, p, normal_inv)) {
+            continue;
+        }
+
+        /* camera k has to be off that point, otherwise it is no explanation */
+        double residual = fabs(p.x * cos(theta[k]) + p.y * sin(theta[k]) - r[k]);
+        if (residual <= XP_REJECT_DIST) {
+            continue;
+        }
+
+        /* consistency of the remaining lines and their tips */
+        double sum2 = 0;
+        for (int i = 0; i < m; i++) {
+            double d = p.x * cos(theta_o[i]) + p.y * sin(theta_o[i]) - r_o[i];
+            sum2 += d * d;
+        }
+        double rms = sqrt(sum2 / m);
+        double tip_mean = 0;
+        if (all_tips) {
+            for (int i = 0; i < n; i++) {
+                if (i != k) {
+                    const Point2f& tip = lines[ids[i]]->tip;
+                    tip_mean += norm(Point2d(tip.x - center.x - p.x, tip.y - center.y - p.y));
+                }
+            }
+            tip_mean /= m;
+        }
+
+        /* the worse the fit of camera k, the more likely it is the outlier */
+        double sigma_k = sqrt(1.0 / w[k]);
+        double cost = rms + tip_mean - sigma_k;
+        if (cost < best_cost) {
+            best_cost = cost;
+            best = k;
+
+            reject->line = ids[k];
+            reject->residual = residual;
+            reject->tip_dist = -1;
+            if (lines[ids[k]]->tip_valid) {
+                const Point2f& tip = lines[ids[k]]->tip;
+                reject->tip_dist = norm(Point2d(tip.x - center.x - p.x, tip.y - center.y - p.y));
+            }
+
+            ostringstream reason;
+            reason.precision(3);
+            reason << "line " << residual << " px off the intersection of the other " << m << " cameras (max " << XP_REJECT_DIST << " px)";
+            if (all_tips) {
+                reason << ", their tips agree within " << tip_mean << " px";
+            }
+            else {
+                reason << ", line fit rms " << lines[ids[k]]->conf.rms << " px";
+            }
+            if (reject->tip_dist >= 0) {
+                reason << ", own tip " << reject->tip_dist << " px away";
+            }
+            reject->reason = reason.str();
+        }
+    }
+
+    return best;
+}
+
+
+
+/***
+  *
+  * img_proc_intersect_lines(const struct line_s* const* lines, int num, cv::Size frameSize, struct cross_point_s* cross)
+  *
+  * 
+  * Weighted least squares intersection of any number of lines directly on
+  * their polar coordinates, with covariance and uncertainty ellipse
+  *
+  *
+  * @param: const struct line_s* const* lines --> lines in Polar Coordinates, invalid lines are skipped
+  * @param: int num --> number of lines
+  * @param: cv::Size frameSize --> refered image size
+  * @param: struct cross_point_s* cross --> return intersection
+  *
+  *
+  * @return: int status --> EXIT_FAILURE if there is no intersection inside the frame
+  *
+  *
+  * @note:  Every line is weighted with 1 / (XP_SIGMA_MIN^2 + rms^2) of its
+  *         fit, a line without confidence with rms = LINE_CONF_RMS_WARN.
+  *         With more than two lines the covariance is scaled with the
+  *         reduced chi^2 of the residuals, if it is above 1.
+  *         As long as three or more lines remain, a line further than
+  *         XP_REJECT_DIST away from the intersection rejects one camera
+  *         (img_proc_find_outlier()) and the point is solved again. The
+  *         rejected cameras and the reason are reported in cross.
+  *
+  *
+  * Example usage: None
+  *
+ ***/
+int img_proc_intersect_lines(const struct line_s* const* lines, int num, cv::Size frameSize, struct cross_point_s* cross) {
+
+    *cross = cross_point_s();
+
+    /* lines which have been extracted, one per camera of the rig */
+    int ids[RIG_CAMS_MAX];
+    double r[RIG_CAMS_MAX], theta[RIG_CAMS_MAX], w[RIG_CAMS_MAX];
+    int n = 0;
+    num = std::min(num, RIG_CAMS_MAX);
+    for (int i = 0; i < num; i++) {
+        if (!lines[i]->valid) {
+            continue;
+        }
+        double sigma2 = img_proc_line_var(&lines[i]->conf);
+        ids[n] = i;
+        r[n] = lines[i]->r;
+        theta[n] = lines[i]->theta;
+        w[n] = 1.0 / sigma2;
+        n++;
+    }
+
+    Point2d p;
+    Matx22d normal_inv;
+    if (!img_proc_lines_lsq(n, r, theta, w, p, normal_inv)) {
+        return EXIT_FAILURE;
+    }
+
+    /* outlier cameras, only while the remaining lines over-determine the point */
+    while (n >= 3) {
+        double d_max = 0;
+        for (int i = 0; i < n; i++) {
+            d_max = std::max(d_max, fabs(p.x * cos(theta[i]) + p.y * sin(theta[i]) - r[i]));
+        }
+        if (d_max <= XP_REJECT_DIST) {
+            break;
+        }
+
+        struct line_reject_s reject;
+        int k = img_proc_find_outlier(lines, n, ids, r, theta, w, frameSize, &reject);
+        if (k < 0) {
+            break;
+        }
+        cross->rejected.push_back(reject);
+
+        /* solve again without the camera */
+        n--;
+        for (int i = k; i < n; i++) {
+            ids[i] = ids[i + 1];
+            r[i] = r[i + 1];
+            theta[i] = theta[i + 1];
+            w[i] = w[i + 1];
+        }
+        if (!img_proc_lines_lsq(n, r, theta, w, p, normal_inv)) {
+            return EXIT_FAILURE;
+        }
+    }
+
+    /* intersection has to be inside the frame */
+    if ((fabs(p.x) > frameSize.width / 2) || (fabs(p.y) > frameSize.height / 2)) {
+        return EXIT_FAILURE;
     }
-    if ((intersection.y < 0) || (intersection.y > RAW_CAL_IMG_HEIGHT)) {
-        intersection.x = -66666;
-        intersection.y = -66666;
-        return false;
+
+    /* residuals */
+    double chi2 = 0;
+    double sum2 = 0;
+    for (int i = 0; i < n; i++) {
+        double d = p.x * cos(theta[i]) + p.y * sin(theta[i]) - r[i];
+        chi2 += w[i] * d * d;
+        sum2 += d * d;
+    }
+    double scale = (n > 2) ? std::max(1.0, chi2 / (n - 2)) : 1.0;
+
+    /* image coordinates, r is around the image center (see houghSpaceToLine()) */
+    cross->p = Point2f((float)(p.x + frameSize.width / 2), (float)(p.y + frameSize.height / 2));
+    cross->cov = normal_inv * scale;
+    cross->rms = sqrt(sum2 / n);
+    cross->num_lines = n;
+    cross->valid = true;
+
+    /* residual of every camera, rejected ones included */
+    cross->residuals.assign(num, -1.0);
+    for (int i = 0; i < num; i++) {
+        if (lines[i]->valid) {
+            cross->residuals[i] = fabs(p.x * cos(lines[i]->theta) + p.y * sin(lines[i]->theta) - lines[i]->r);
+        }
     }
 
-    /* intersectio coordinates */
-    intersection.x = (int)((B1 * C2 - B2 * C1) / det);
-    intersection.y = (int)((A2 * C1 - A1 * C2) / det);
+    /* 1 sigma ellipse: eigen values and vectors of the covariance */
+    double a = cross->cov(0, 0);
+    double b = cross->cov(0, 1);
+    double c = cross->cov(1, 1);
+    double mean = (a + c) / 2;
+    double diff = sqrt((a - c) * (a - c) / 4 + b * b);
+    double angle = 0.5 * atan2(2 * b, a - c) * 180.0 / CV_PI;
+    cross->ellipse = RotatedRect(cross->p, Size2f((float)(2 * sqrt(mean + diff)), (float)(2 * sqrt(std::max(mean - diff, 0.0)))), (float)angle);
 
-    return true;
+    return EXIT_SUCCESS;
 }
 
 
 
 /***
   *
-  * img_proc_calculate_midpoint(const cv::Point& p1, const cv::Point& p2, const cv::Point& p3)
+  * img_proc_triangulate(const struct line_s* const* lines, int num, cv::Size frameSize, struct cross_point_s* cross)
   *
-  * get math center of three intersection points
+  * 
+  * Metric cross point: every line is the trace of a plane through the center
+  * of its camera, p_mm is the board point (z = 0) with the least squares
+  * distance to these planes.
   *
   *
-  * @param: const cv::Point& p1 --> intersection point
-  * @param: const cv::Point& p2 --> intersection point
-  * @param: const cv::Point& p3 --> intersection point
+  * @param: const struct line_s* const* lines --> lines in Polar Coordinates, one per camera of the rig
+  * @param: int num --> number of lines
+  * @param: cv::Size frameSize --> refered image size
+  * @param: struct cross_point_s* cross --> intersection of img_proc_intersect_lines(), gets p_mm, cov_mm and rms_mm
   *
   *
-  * @return: cv::Point --> midpoint of 3 intersection
+  * @return: int status --> EXIT_FAILURE if a camera taking part has no pose
   *
   *
-  * @note:	None
+  * @note:  Rejected cameras of cross are left out. The warped line goes back
+  *         to the raw image with H^T, to the camera plane with K^T and to
+  *         the board with the pose (calibration_pose()).
+  *         The pose is solved on landmarks of H, so the trace of every plane
+  *         is the warped line in mm: p_mm is the pixel intersection of
+  *         img_proc_intersect_lines() with every camera reweighted by s^2
+  *         (s = sine of the angle between plane and board), which down
+  *         weights grazing cameras. Scoring stays on p, cov and ellipse
+  *         belong to p; p_mm is reported next to it.
   *
   *
   * Example usage: None
   *
  ***/
-cv::Point img_proc_calculate_midpoint(cv::Point& p1, cv::Point& p2, cv::Point& p3){
-    Point midpoint;
+int img_proc_triangulate(const struct line_s* const* lines, int num, cv::Size frameSize, struct cross_point_s* cross) {
 
-    /***
-     * calculate distance between each point; 
-     * if there were almost parallel lines due to unlucky cam angle, one point might be far away
-     * two avoid other errors this is done max. ones (if, else if,...)
-    ***/
-    double eps = 120.0;
-    if ((norm(p1 - p2) > eps) && (norm(p1 - p3) > eps)) {
-        p1.x = -66666;
-        p1.y = -66666;
+    bool used[RIG_CAMS_MAX];
+    num = std::min(num, RIG_CAMS_MAX);
+    for (int i = 0; i < num; i++) {
+        used[i] = lines[i]->valid;
     }
-    else if ((norm(p2 - p1) > eps) && (norm(p2 - p3) > eps)) {
-        p2.x = -66666;
-        p2.y = -66666;
-    }
-    else if ((norm(p3 - p1) > eps) && (norm(p3 - p2) > eps)) {
-        p3.x = -66666;
-        p3.y = -66666;
+    for (const auto& reject : cross->rejected) {
+        used[reject.line] = false;
     }
 
-    /* all points are valid */
-    if (!(p1 == Point(-66666, -66666)) && !(p2 == Point(-66666, -66666)) && !(p3 == Point(-66666, -66666))) {
-        midpoint.x = (p1.x + p2.x + p3.x) / 3;
-        midpoint.y = (p1.y + p2.y + p3.y) / 3;
-        return midpoint;
-    }
+    Point2d c(frameSize.width / 2, frameSize.height / 2);
+    double r[RIG_CAMS_MAX], theta[RIG_CAMS_MAX], w[RIG_CAMS_MAX];
+    Vec4d planes[RIG_CAMS_MAX];
+    int n_planes = 0;
+    for (int i = 0; i < num; i++) {
+        if (!used[i]) {
+            continue;
+        }
+        struct rig_cam_s* cam = rig_cam(i);
+        if ((cam == nullptr) || !cam->pose_valid) {
+            return EXIT_FAILURE;
+        }
 
+        /* warped line (r around the image center) --> raw image --> plane through the camera center */
+        double ct = cos(lines[i]->theta);
+        double st = sin(lines[i]->theta);
+        Vec3d l_warp(ct, st, -(lines[i]->r + ct * c.x + st * c.y));
+        Matx33d H = cam->H;
+        Vec3d l_raw = H.t() * l_warp;
+        Vec3d plane_cam = cam->K.t() * l_raw;
+
+        /* plane in board coordinates: normal R^T * plane, offset plane * t */
+        Vec3d n = cam->R.t() * plane_cam;
+        double d = plane_cam.dot(cam->t);
+        double len = norm(n);
+        if (len <= 0) {
+            return EXIT_FAILURE;
+        }
+        n = n * (1.0 / len);
+        d /= len;
 
-    /* error handling */
-    /* all points are invalid */
-    if ((p1 == Point(-66666, -66666)) && (p2 == Point(-66666, -66666)) && (p3 == Point(-66666, -66666))) {
-        /* just return invalid point */
-        return p1;
-    }
-    /* two points are invalid; return only valid point */
-    else if ((p1 == Point(-66666, -66666)) && (p2 == Point(-66666, -66666))) {
-        return p3;
-    }
-    else if ((p1 == Point(-66666, -66666)) && (p3 == Point(-66666, -66666))) {
-        return p2;
-    }
-    else if ((p2 == Point(-66666, -66666)) && (p3 == Point(-66666, -66666))) {
-        return p1;
-    }
-    /* one point is invalid; return intersection between the two valid points */
-    else if (p1 == Point(-66666, -66666)) {
-        midpoint.x = (p2.x + p3.x) / 2;
-        midpoint.y = (p2.y + p3.y) / 2;
-        return midpoint;
+        /***
+         * trace of the plane on the board; the distance to the plane is s times
+         * the distance to the trace, so the weight is s^2 / variance
+        ***/
+        double s = sqrt(n[0] * n[0] + n[1] * n[1]);
+        if (s < XP_DET_MIN) {
+            continue;   // plane parallel to the board
+        }
+        double sigma_mm = CAL_MM_PER_PIXEL * sqrt(img_proc_line_var(&lines[i]->conf));
+        r[n_planes] = -d / s;
+        theta[n_planes] = atan2(n[1], n[0]);
+        w[n_planes] = s * s / (sigma_mm * sigma_mm);
+        planes[n_planes] = Vec4d(n[0], n[1], n[2], d);
+        n_planes++;
     }
-    else if (p2== Point(-66666, -66666)) {
-        midpoint.x = (p1.x + p3.x) / 2;
-        midpoint.y = (p1.y + p3.y) / 2;
-        return midpoint;
+
+    Point2d p;
+    Matx22d normal_inv;
+    if (!img_proc_lines_lsq(n_planes, r, theta, w, p, normal_inv)) {
+        return EXIT_FAILURE;
     }
-    else if (p3 == Point(-66666, -66666)) {
-        midpoint.x = (p1.x + p2.x) / 2;
-        midpoint.y = (p1.y + p2.y) / 2;
-        return midpoint;
+
+    /* distances to the camera planes, reduced chi^2 as in img_proc_intersect_lines() */
+    double chi2 = 0;
+    double sum2 = 0;
+    for (int i = 0; i < n_planes; i++) {
+        double d = planes[i][0] * p.x + planes[i][1] * p.y + planes[i][3];
+        chi2 += w[i] * d * d / (planes[i][0] * planes[i][0] + planes[i][1] * planes[i][1]);
+        sum2 += d * d;
     }
+    double scale = (n_planes > 2) ? std::max(1.0, chi2 / (n_planes - 2)) : 1.0;
+
+    /* p, cov and ellipse stay the pixel intersection */
+    cross->p_mm = Point2f((float)p.x, (float)p.y);
+    cross->cov_mm = normal_inv * scale;
+    cross->rms_mm = sqrt(sum2 / n_planes);
+    cross->metric = true;
+
+    return EXIT_SUCCESS;
 }
 
 
+
 /***
   *
-  * img_proc_calculate_midpoint(const cv::Point& p1, const cv::Point& p2, const cv::Point& p3)
+  * img_proc_cross_point_math(cv::Size frameSize, struct line_s* const* lines, int num, struct cross_point_s* cross, int show_imgs)
   *
   * 
   * Call this function with Polar Coordinates and do math computation of
-  * intersections of three lines.
+  * the intersection of the camera lines (weighted least squares).
   *
   *
   * @param: cv::Size frameSize --> refered image size
-  * @param: struct tripple_line_s* --> 3 lines in Polar Coordinates
-  * @param: cv::Point& cross_p --> final intersection point 
+  * @param: struct line_s* const* lines --> lines in Polar Coordinates, one per camera of the rig
+  * @param: int num --> number of lines
+  * @param: struct cross_point_s* cross --> final intersection point with uncertainty
+  * @param: int show_imgs --> SHOW_NO_IMAGES or display "Z Line Intersection"
   *
   *
   * @return: int status
   *
   *
-  * @note:  Displays Intersection Image as "Z Line Intersection"
+  * @note:  With less than three lines the intersection is checked against
+  *         the located tips, with a single line the tip is the only
+  *         information left. No image is allocated for SHOW_NO_IMAGES.
   *
   *
   * Example usage: None
   *
  ***/
-int img_proc_cross_point_math(cv::Size frameSize, struct tripple_line_s* tri_line, cv::Point& cross_p) {
+int img_proc_cross_point_math(cv::Size frameSize, struct line_s* const* lines, int num, struct cross_point_s* cross, int show_imgs) {
 
-    /* cartesian tripple lines */
-    struct tri_line_cart_s tlk;
-    /* intersection points */
-    Point intersection1, intersection2, intersection3;
+    /* pick the most consistent candidate lines */
+    img_proc_select_candidates(frameSize, lines, num);
 
-    /* show intersection images */
-    Mat frame = Mat::zeros(frameSize, CV_8UC3);
+    /* least squares intersection of all extracted lines */
+    img_proc_intersect_lines(lines, num, frameSize, cross);
+
+#if XP_TRIANGULATE
+    /* metric board point of the camera planes next to the pixel intersection, needs camera poses */
+    if (cross->valid && (cross->num_lines >= 2)) {
+        img_proc_triangulate(lines, num, frameSize, cross);
+    }
+#endif
 
-    /* visualize; has nothig to do with intersection computation */
-    ip::drawLine_light_add(frame, tri_line->line_top.r, tri_line->line_top.theta);
-    ip::drawLine_light_add(frame, tri_line->line_right.r, tri_line->line_right.theta);
-    ip::drawLine_light_add(frame, tri_line->line_left.r, tri_line->line_left.theta);
+    /***
+     * less than three usable cameras: check the intersection against the located tips,
+     * with a single camera the tip is the only information left; rejected cameras do not count
+    ***/
+    bool used[RIG_CAMS_MAX];
+    int valid_lines = 0;
+    num = std::min(num, RIG_CAMS_MAX);
+    for (int i = 0; i < num; i++) {
+        used[i] = lines[i]->valid;
+    }
+    for (const auto& reject : cross->rejected) {
+        used[reject.line] = false;
+    }
+    for (int i = 0; i < num; i++) {
+        valid_lines += used[i];
+    }
+    if (valid_lines < 3) {
+        Point2f tip_sum(0, 0);
+        int tip_count = 0;
+        for (int i = 0; i < num; i++) {
+            if (used[i] && lines[i]->tip_valid) {
+                tip_sum += lines[i]->tip;
+                tip_count++;
+            }
+        }
+        if (tip_count > 0) {
+            Point2f tip_p = tip_sum * (1.0f / tip_count);
+            /* no intersection or intersection of almost parallel lines far away from the tips */
+            if (!cross->valid || (norm(cross->p - tip_p) > XP_TIP_DIST_MAX)) {
+                vector<struct line_reject_s> rejected = cross->rejected;
+                *cross = cross_point_s();
+                cross->p = tip_p;
+                cross->valid = true;
+                cross->rejected = rejected;
+            }
+        }
+    }
 
-    
-    /* transform coordinates */
-    img_proc_polar_to_cart(frame, tri_line->line_top, tlk.top);
-    img_proc_polar_to_cart(frame, tri_line->line_right, tlk.right);
-    img_proc_polar_to_cart(frame, tri_line->line_left, tlk.left);
-
-    /* get intersections */
-    img_proc_find_intersection(tlk.top, tlk.right, intersection1);
-    img_proc_find_intersection(tlk.top, tlk.left, intersection2);
-    img_proc_find_intersection(tlk.left, tlk.right, intersection3);
-
-    /* get midpoint */
-    cross_p = img_proc_calculate_midpoint(intersection1, intersection2, intersection3);
-
-    /* draw interections */
-    //circle(image, intersection1, 5, Scalar(0, 0, 255), 1);
-    //circle(image, intersection2, 5, Scalar(0, 255, 0), 1);
-    //circle(image, intersection3, 5, Scalar(255, 0, 0), 1);
-    
-    /* draw midpoint*/
-    cv::circle(frame, cross_p, 8, Scalar(255, 255, 0), 1.5); 
+    if (show_imgs != SHOW_NO_IMAGES) {
+        /* visualize; has nothig to do with intersection computation */
+        Mat frame = Mat::zeros(frameSize, CV_8UC3);
+        for (int i = 0; i < num; i++) {
+            ip::drawLine_light_add(frame, lines[i]->r, lines[i]->theta);
+        }
 
-    // Debug 
-    //cout << "midpoint: x: " << centerOfMass.x << ", y: " << centerOfMass.y << endl;
-    dart_board_draw_sectors(frame, TOP_CAM, 0, 0);
-    imshow("Z Line Intersection", frame);
-    //cv::imwrite("lines_intersection_math.jpg", frame);
-    
-    return EXIT_SUCCESS;
+        /* draw intersection and uncertainty */
+        if (cross->valid) {
+            cv::circle(frame, cross->p, 8, Scalar(255, 255, 0), 1.5);
+            if (cross->num_lines > 0) {
+                cv::ellipse(frame, cross->ellipse, Scalar(0, 255, 255), 1);
+            }
+        }
+
+        dart_board_draw_sectors(frame, TOP_CAM, 0, 0);
+        imshow("Z Line Intersection", frame);
+        //cv::imwrite("lines_intersection_math.jpg", frame);
+    }
+
+    return cross->valid ? EXIT_SUCCESS : EXIT_FAILURE;
 
 }
 
@@ -1445,9 +3084,11 @@ int img_proc_diff_check(cv::Mat& last_f, cv::Mat& cur_f, int ThreadId) {
     cv::GaussianBlur(cur, cur, Size(9, 9), 1.25, 1.25);
     cv::GaussianBlur(last, last, Size(9, 9), 1.25, 1.25);
 
-    /* calibrate images */
-    calibration_get_img(cur, cur, ThreadId);
-    calibration_get_img(last, last, ThreadId);
+    /* calibrate images, the native mode counts the edges on the board in camera coordinates */
+    if (!img_proc.native) {
+        calibration_get_img(cur, cur, ThreadId);
+        calibration_get_img(last, last, ThreadId);
+    }
 
     /* gray conversion */
     cvtColor(cur, cur, COLOR_BGR2GRAY);
@@ -1457,21 +3098,26 @@ int img_proc_diff_check(cv::Mat& last_f, cv::Mat& cur_f, int ThreadId) {
     /* check difference */
     absdiff(last, cur, diff);
 
-    /* sharpen images after difference */
-    img_proc_sharpen_img(diff, diff);
-
-    /* edge image */
-    ip::sobelFilter(diff, diff);
+    /* sharpen images after difference and edge image, thresholded in the sobel kernel */
+    //img_proc_sharpen_img(diff, diff);
     //threshold(diff, diff, BIN_THRESH, 255, THRESH_BINARY);    // fixed macro
-    cv::threshold(diff, diff, img_proc.bin_thresh, 255, THRESH_BINARY);      // set by trackbar
+    Mat diff_bin;
+    int edge_count = ip::sharpenSobelThreshold(diff, diff_bin, img_proc_bin_thresh(ThreadId), SHARPEN_KERNEL_CENTER);      // set by trackbar or rig
+
+    /* native mode: only the edges on the board count, as on the warped images */
+    Mat raw_mask;
+    if (img_proc.native && (calibration_raw_mask(ThreadId, diff_bin.size(), raw_mask) == EXIT_SUCCESS)) {
+        bitwise_and(diff_bin, raw_mask, diff_bin);
+        edge_count = countNonZero(diff_bin);
+    }
 
-    imshow(DIFF_IMG, diff);
+    imshow(DIFF_IMG, diff_bin);
     
     /* sum up all pixel */
-    p_sum = sum(diff);
+    p_sum = Scalar(255.0 * edge_count);
     //cout << "sum of pixel: " << p_sum[0] << endl;
     //if (p_sum[0]>DIFF_MIN_THRESH) { // fixed macro
-    if (p_sum[0]>img_proc.diff_min_thresh) { 
+    if (p_sum[0] > img_proc_diff_min_thresh(ThreadId)) { 
         return IMG_DIFFERENCE;
     }
     else {
@@ -1536,9 +3182,11 @@ int img_proc_diff_check_cal(cv::Mat& last_f, cv::Mat& cur_f, int ThreadId, int*
     cv::GaussianBlur(cur, cur, Size(9, 9), 1.25, 1.25);
     cv::GaussianBlur(last, last, Size(9, 9), 1.25, 1.25);
 
-    /* calibrate images */
-    calibration_get_img(cur, cur, ThreadId);
-    calibration_get_img(last, last, ThreadId);
+    /* calibrate images, the native mode counts the edges on the board in camera coordinates */
+    if (!img_proc.native) {
+        calibration_get_img(cur, cur, ThreadId);
+        calibration_get_img(last, last, ThreadId);
+    }
 
     /* gray conversion */
     cvtColor(cur, cur, COLOR_BGR2GRAY);
@@ -1548,24 +3196,29 @@ int img_proc_diff_check_cal(cv::Mat& last_f, cv::Mat& cur_f, int ThreadId, int*
     /* check difference */
     absdiff(last, cur, diff);
 
-    /* sharpen images after difference */
-    img_proc_sharpen_img(diff, diff);
-
-    /* edge image */
-    ip::sobelFilter(diff, diff);
+    /* sharpen images after difference and edge image, thresholded in the sobel kernel */
+    //img_proc_sharpen_img(diff, diff);
     //threshold(diff, diff, BIN_THRESH, 255, THRESH_BINARY);    // fixed macro
-    cv::threshold(diff, diff, img_proc.bin_thresh, 255, THRESH_BINARY);      // set by trackbar
+    Mat diff_bin;
+    int edge_count = ip::sharpenSobelThreshold(diff, diff_bin, img_proc_bin_thresh(ThreadId), SHARPEN_KERNEL_CENTER);      // set by trackbar or rig
+
+    /* native mode: only the edges on the board count, as on the warped images */
+    Mat raw_mask;
+    if (img_proc.native && (calibration_raw_mask(ThreadId, diff_bin.size(), raw_mask) == EXIT_SUCCESS)) {
+        bitwise_and(diff_bin, raw_mask, diff_bin);
+        edge_count = countNonZero(diff_bin);
+    }
 
-    imshow(DIFF_IMG, diff);
+    imshow(DIFF_IMG, diff_bin);
 
     /* sum up all pixel */
-    p_sum = sum(diff);
+    p_sum = Scalar(255.0 * edge_count);
     if (show)
         cout << "sum of pixel: " << p_sum[0] << endl;
     
     *pixel_sum = (int)(p_sum[0]);
     //if (p_sum[0]>DIFF_MIN_THRESH) { // fixed macro
-    if (p_sum[0] > img_proc.diff_min_thresh) { 
+    if (p_sum[0] > img_proc_diff_min_thresh(ThreadId)) { 
         return IMG_DIFFERENCE;
     }
     else {
@@ -1708,18 +3361,14 @@ void computeAndShowCorrelation(const cv::Mat& img1, const cv::Mat& img2) {
 
 /***
   *
-  * img_proc_calibration(cv::Mat& raw_top, cv::Mat& raw_right, cv::Mat& raw_left, cv::Mat& dart_top, cv::Mat& dart_right, cv::Mat& dart_left)
+  * img_proc_calibration(void)
   *
   *
-  * Calibrate Difference Image Parameters
+  * Calibrate Difference Image Parameters on every camera of the rig
   *
   *
-  * @param: cv::Mat& raw_top --> raw Dart Board Image (Top)
-  * @param: cv::Mat& raw_right --> raw Dart Board Image (Right)
-  * @param: cv::Mat& raw_left --> raw Dart Board Image (Left)
-  * @param: cv::Mat& dart_top --> Dart Board Image with Dart for Cal (Top)
-  * @param: cv::Mat& dart_top --> Dart Board Image with Dart for Cal (Right)
-  * @param: cv::Mat& dart_top --> Dart Board Image with Dart for Cal (Left)
+  * @param: void --> last frames of the rig are the raw Dart Board Images,
+  *         current frames the Dart Board Images with Dart for Cal
   *
   *
   * @return: void 
@@ -1731,7 +3380,7 @@ void computeAndShowCorrelation(const cv::Mat& img1, const cv::Mat& img2) {
   * Example usage: None
   *
  ***/
-void img_proc_calibration(cv::Mat& raw_top, cv::Mat& raw_right, cv::Mat& raw_left, cv::Mat& dart_top, cv::Mat& dart_right, cv::Mat& dart_left) {
+void img_proc_calibration(void) {
 
     Mat frame;
     int key = 0;
@@ -1764,19 +3413,12 @@ void img_proc_calibration(cv::Mat& raw_top, cv::Mat& raw_right, cv::Mat& raw_lef
     /* view diff, and wait for escape to quit img analysis */
     while ((waitKey(10) != 27) && running){
 
-        while ((waitKey(10) != 13) && running){
-            img_proc_diff_check_cal(raw_top, dart_top, TOP_CAM, &p_sum, false);
-            this_thread::sleep_for(chrono::milliseconds(10));
-        }
-        
-        while ((waitKey(10) != 13) && running) {
-            img_proc_diff_check_cal(raw_right, dart_right, RIGHT_CAM, &p_sum, false);
-            this_thread::sleep_for(chrono::milliseconds(10));
-        }
-
-        while ((waitKey(10) != 13) && running) {
-            img_proc_diff_check_cal(raw_left, dart_left, LEFT_CAM, &p_sum, false);
-            this_thread::sleep_for(chrono::milliseconds(10));
+        for (int i = 0; i < rig_num_cams(); i++) {
+            struct rig_cam_s* cam = rig_cam(i);
+            while ((waitKey(10) != 13) && running) {
+                img_proc_diff_check_cal(cam->last, cam->cur, cam->id, &p_sum, false);
+                this_thread::sleep_for(chrono::milliseconds(10));
+            }
         }
 
         /* hit enter to view images again and [Esc] to leave calibration */
@@ -1796,17 +3438,12 @@ void img_proc_calibration(cv::Mat& raw_top, cv::Mat& raw_right, cv::Mat& raw_lef
         return;
 
     /* now adjust diff_min_thresh (depends directly on bin_thresh) */
-    img_proc_diff_check_cal(raw_top, dart_top, TOP_CAM, &p_sum, true);
-    if (p_sum < p_sum_last)
-        p_sum_last = p_sum;
-
-    img_proc_diff_check_cal(raw_right, dart_right, RIGHT_CAM, &p_sum, true);
-    if (p_sum < p_sum_last)
-        p_sum_last = p_sum;
-
-    img_proc_diff_check_cal(raw_left, dart_left, LEFT_CAM, &p_sum, true);
-    if (p_sum < p_sum_last)
-        p_sum_last = p_sum;
+    for (int i = 0; i < rig_num_cams(); i++) {
+        struct rig_cam_s* cam = rig_cam(i);
+        img_proc_diff_check_cal(cam->last, cam->cur, cam->id, &p_sum, true);
+        if (p_sum < p_sum_last)
+            p_sum_last = p_sum;
+    }
 
     /* p_sum_last is smallest sum val */
     cout << "smallest sum: " << p_sum_last << "\tsuggested diff min thresh: " << p_sum_last * 0.6 << " (Trackbar: " << p_sum_last * 0.6 / 1e+4 << ")" << endl;
@@ -1950,385 +3587,151 @@ void img_proc_set_short_edge_max(int short_edge_max) {
 
 }
 
+/* set line extraction method (LINE_METHOD_*) of a camera */
+int img_proc_set_line_method(int ThreadId, int method) {
 
-
-
-/******************************************************************************
- * Imange Processing Debug and tryout Function
-/*****************************************************************************/
-/***
- * Large Debug Copy for tryouts and various image display,
- * that's why this def is at the bottom. 
- * For Documentation see img_proc_get_line() at the top of the module 
-***/
-int img_proc_get_line_debug(cv::Mat& lastImg, cv::Mat& currentImg, int ThreadId, struct line_s* line, int show_imgs, std::string CamNameId) {
-
-
-    /* declare images */
-    Mat cur;
-    Mat cur_gray;
-    Mat cur_sharp;
-    Mat cur_sharp_gray;
-
-    Mat last;
-    Mat last_gray;
-    Mat last_sharp;
-    Mat last_sharp_gray;
-
-    Mat diff;
-    Mat diff_gray;
-    Mat diff_sharp;
-    Mat diff_sharp_gray;
-
-    Mat sharp_after_diff;
-    Mat sharp_after_diff_gray;
-
-    Mat edge;
-    Mat edge_bin;
-
-    Mat houghSpace;
-    Mat cur_line;
-
-
-    /* clone images */
-    cur = currentImg.clone();
-    if (cur.empty()) {
-        std::cout << "[ERROR] Current Image is empty" << endl;
-        return EXIT_FAILURE;
-    }
-
-    last = lastImg.clone();
-    if (last.empty()) {
-        std::cout << "[ERROR] Last Image is empty" << endl;
+    struct rig_cam_s* cam = rig_cam(ThreadId);
+    if ((cam == nullptr) || (method < 0) || (method >= LINE_METHOD_COUNT)) {
         return EXIT_FAILURE;
     }
 
-    /* noise reduction */
-    cv::GaussianBlur(cur, cur, Size(3, 3), GAUSSIAN_BLUR_SIGMA, GAUSSIAN_BLUR_SIGMA);
-    cv::GaussianBlur(last, last, Size(3, 3), GAUSSIAN_BLUR_SIGMA, GAUSSIAN_BLUR_SIGMA);
-
-    /* calibrate images */
-    calibration_get_img(cur, cur, ThreadId);
-    calibration_get_img(last, last, ThreadId);
-
-    /* gray conversion */
-    cvtColor(cur, cur_gray, COLOR_BGR2GRAY);
-    cvtColor(last, last_gray, COLOR_BGR2GRAY);
-
-    /* sharpen images */
-    img_proc_sharpen_img(cur, cur_sharp);
-    img_proc_sharpen_img(cur_gray, cur_sharp_gray);
-
-    img_proc_sharpen_img(last, last_sharp);
-    img_proc_sharpen_img(last_gray, last_sharp_gray);
-
-
-    /* check difference */
-    absdiff(last, cur, diff);
-    absdiff(last_gray, cur_gray, diff_gray);
-    absdiff(last_sharp, cur_sharp, diff_sharp);
-    absdiff(last_sharp_gray, cur_sharp_gray, diff_sharp_gray);
-
-
-    /* sharpen images after difference */
-    img_proc_sharpen_img(diff, sharp_after_diff);
-    img_proc_sharpen_img(diff_gray, sharp_after_diff_gray);
+    /* update value */
+    cam->line_method = method;
 
-    /* edge image */
-    //int thresh_top = 55;
-    ip::sobelFilter(sharp_after_diff_gray, edge);
-    //threshold(edge, edge_bin, BIN_THRESH, 255, THRESH_BINARY);    // fixed macro
-    cv::threshold(edge, edge_bin, img_proc.bin_thresh, 255, THRESH_BINARY);      // set by trackbar
+    return EXIT_SUCCESS;
+}
 
-#if 1
-    /*********************************************** under construction *****************************************************/
-    /* everything thats outcommented is for performance reasons, but are images for debug and analysis */
+/***
+ * set the line space: native lines are fitted in camera coordinates and
+ * mapped to the board, no image is warped per frame; the footprints of the
+ * visit are cleared since they belong to the old space
+***/
+void img_proc_set_native(bool native) {
 
-    /* use the original if contours does not work */
-    Mat edge_bin_original = edge_bin.clone();
+    /* update value */
+    if (img_proc.native != native) {
+        img_proc_footprint_clear();
+    }
+    img_proc.native = native;
 
-    /* draw box, bc darts contours could be open if out of image */
-    cv::line(edge_bin, Point(0, 0), Point(0, edge_bin.rows - 1), Scalar(255, 255, 255), 1);
-    cv::line(edge_bin, Point(0, 0), Point(edge_bin.cols - 1, 0), Scalar(255, 255, 255), 1);
-    cv::line(edge_bin, Point(edge_bin.cols - 1, 0), Point(edge_bin.cols - 1, edge_bin.rows - 1), Scalar(255, 255, 255), 2);
-    cv::line(edge_bin, Point(0, edge_bin.rows - 1), Point(edge_bin.cols - 1, edge_bin.rows - 1), Scalar(255, 255, 255), 2);
+}
 
+/* get line space, true := native camera coordinates */
+bool img_proc_get_native(void) {
 
+    return img_proc.native;
+}
 
-    /* close open contours */
-    cv::morphologyEx(edge_bin, edge_bin, cv::MORPH_CLOSE, cv::Mat::ones(2, 2, CV_8U));
-    //GaussianBlur(edge_bin, edge_bin, Size(3, 3), 0.3, 0.3);
+/* set show level (SHOW_*) of the game loop, SHOW_NO_IMAGES runs the production path without debug images */
+void img_proc_set_show(int show_imgs) {
 
+    /* update value */
+    img_proc.show_imgs = show_imgs;
 
-    Mat edge_bin_cont = edge_bin.clone();
-    cvtColor(edge_bin_cont, edge_bin_cont, COLOR_GRAY2BGR);
-    /* find contour of dart */
-    vector<vector<Point>> cont;
-    vector<Vec4i> hier;
-    findContours(edge_bin, cont, hier, RETR_TREE, CHAIN_APPROX_SIMPLE);
+}
 
-    /* draw cont */
+/* set pyrDown steps of the coarse cluster search (0 := full resolution), the benchmark compares both paths */
+int img_proc_set_ctf_levels(int levels) {
 
-    //Mat contoursImg = Mat::zeros(edge_bin.size(), CV_8UC3);
-    for (size_t i = 0; i < cont.size(); i++) {
-        drawContours(edge_bin_cont, cont, (int)i, Scalar(255, 255, 0), 1, LINE_8, hier, 0);
+    if ((levels < 0) || (levels > CTF_PYR_LEVELS_MAX)) {
+        return EXIT_FAILURE;
     }
 
+    /* update value */
+    img_proc.ctf_levels = levels;
 
+    return EXIT_SUCCESS;
+}
 
-    //Mat result = Mat::zeros(edge_bin.size(), CV_8UC3);
-    //Mat cont_rect = Mat::zeros(edge_bin.size(), CV_8UC3);
-
-    /* fitted final contour --> just the barrel as rectangle */
-    Mat cont_rect_fitted = Mat::zeros(edge_bin.size(), CV_8UC3);
-    /* store all endpoints */
-    vector<Point> allPoints;
-
-    for (size_t i = 0; i < cont.size(); i++) {
-        /* rotating bounding box */
-        RotatedRect rotatedRect = minAreaRect(cont[i]);
-
-        /* calculate properties */
-        float width = rotatedRect.size.width;
-        float height = rotatedRect.size.height;
-
-        float aspectRatio = (width < height) ? width / height : height / width;
+/* get pyrDown steps of the coarse cluster search */
+int img_proc_get_ctf_levels(void) {
 
-        double area = contourArea(cont[i]);
+    return img_proc.ctf_levels;
+}
 
+/* get show level (SHOW_*) of the game loop */
+int img_proc_get_show(void) {
 
-        /* criteria: narrow and elongated */
-        if ((aspectRatio < 0.2) && (aspectRatio > 0.01) && (area > 450)) {
-            drawContours(edge_bin_cont, cont, (int)i, Scalar(0, 255, 255), 1);
-            /* calculate corners of ratating rectangle */
-            Point2f points[4];
-            rotatedRect.points(points);
-
-            /* draw rot rect */
-            for (int j = 0; j < 4; j++) {
-                allPoints.push_back(points[j]);
-                //cv::line(cont_rect_fitted, points[j], points[(j + 1) % 4], Scalar(0, 255, 255), 1);
-                //line(result, points[j], points[(j + 1) % 4], Scalar(255, 0, 0), 1);
-            }
+    return img_proc.show_imgs;
+}
 
+/* show level of a name (off, short, all, line, edge, edge_bin, sharp) */
+int img_proc_show_from_name(const char* name, int* show_imgs) {
+
+    static const struct {
+        const char* name;
+        int show_imgs;
+    } levels[] = {
+        { "off", SHOW_NO_IMAGES },
+        { "short", SHOW_SHORT_ANALYSIS },
+        { "all", SHOW_ALL_IMAGES },
+        { "line", SHOW_IMG_LINE },
+        { "edge", SHOW_EDGE_IMG },
+        { "edge_bin", SHOW_EDGE_BIN },
+        { "sharp", SHOW_SHARP_AFTER_DIFF },
+    };
+
+    for (const auto& level : levels) {
+        if (strcmp(name, level.name) == 0) {
+            *show_imgs = level.show_imgs;
+            return EXIT_SUCCESS;
         }
     }
 
+    return EXIT_FAILURE;
+}
 
+/* get line extraction method (LINE_METHOD_*) of a camera */
+int img_proc_get_line_method(int ThreadId) {
 
-    /* calaculate just one rot rect which fits all other rects, their might be more than bc of shaft and barrel might be divided through its haptic */
-    if (!allPoints.empty()) {
-        RotatedRect enclosingRect = minAreaRect(allPoints);
-        Point2f points_enc[4];
-        enclosingRect.points(points_enc);
-
-        /* draw rect */
-        for (int j = 0; j < 4; j++) {
-            cv::line(edge_bin_cont, points_enc[j], points_enc[(j + 1) % 4], Scalar(255, 0, 0), 2);
-            cv::line(cont_rect_fitted, points_enc[j], points_enc[(j + 1) % 4], Scalar(255, 0, 0), 1);
-        }
-        /**/
-        cvtColor(cont_rect_fitted, edge_bin, COLOR_BGR2GRAY);
-        cv::threshold(edge_bin, edge_bin, 10, 255, THRESH_BINARY);
-    }
-    /* if there were no conts, which fitted criteria do normal edge detection */
-    else {
-        edge_bin = edge_bin_original;
+    struct rig_cam_s* cam = rig_cam(ThreadId);
+    if (cam == nullptr) {
+        return LINE_METHOD_DEFAULT;
     }
 
+    return cam->line_method;
+}
 
+/* binarisation threshold of a camera, the global parameter if the rig does not set one */
+static int img_proc_bin_thresh(int ThreadId) {
 
-    //imshow("narrow contours", result);
-    //imshow("edges", edge_bin);
-    //imshow("contoura", contoursImg);
-    //imshow("Fitted all", cont_rect_fitted);
-
-    /*********************************************** under construction end **************************************************/
-#endif 
-
-
-    /* Calculate Hough transform */
-    cur_line = cur.clone();
-    ip::houghTransform(edge_bin, houghSpace);
-
-    cv::GaussianBlur(houghSpace, houghSpace, Size(SMOOTHING_KERNEL_SIZE, SMOOTHING_KERNEL_SIZE), 0.0);
-
-
-
-
-    /* find 2 gloabl maxima */
-    Mat houghSpaceClone = houghSpace.clone();
-    /* Prepare Hough space image for display */
-    houghSpace = 255 - houghSpace;				// Invert
-    ip::drawHoughLineLabels(houghSpace);		// Axes
-
-    Point houghMaxLocation;
-    double r, theta;
-    double r_avg = 0;
-    double theta_avg = 0;
-    /* find global maxima */
-    int global_max = 2;
-    for (int i = 0; i < global_max; i++) {
-        minMaxLoc(houghSpaceClone, NULL, NULL, NULL, &houghMaxLocation);
-        ip::houghSpaceToLine(
-            Size(edge_bin.cols, edge_bin.rows),
-            Size(houghSpace.cols, houghSpace.rows),
-            houghMaxLocation.x, houghMaxLocation.y, r, theta);
-        //ip::drawLine(cur_line, r, theta);
-        //cout << "Debug x: " << houghMaxLocation.x << "\ty: " << houghMaxLocation.y << endl;
-
-        // set max to zero
-        int delete_size = 3;
-        for (int dx = -delete_size; dx <= delete_size; ++dx) {
-            for (int dy = -delete_size; dy <= delete_size; ++dy) {
-                int nx = houghMaxLocation.x + dx; // neighbor in x-dir
-                int ny = houghMaxLocation.y + dy; // neighbor in y-dir
-
-
-                if (nx >= 0 && nx < houghSpaceClone.cols && ny >= 0 && ny < houghSpaceClone.rows) {
-                    houghSpaceClone.at<uchar>(ny, nx) = 0;
-                }
-            }
-        }
-
-        /* shift the edges exactly on the edge to be more centered in averaging */
-        int shift_val = 2;
-        if (r > shift_val) {
-            r = r + shift_val;
-        }
-        else if (r < -shift_val) {
-            r = r - shift_val;
-        }
-
-        ip::drawLine(edge_bin_cont, r, theta);   // Debug
-        cv::circle(houghSpace, houghMaxLocation, 5, Scalar(0, 0, 255), 2);		// Global maximum
-        /* averaging */
-        //out << "Debug r: " << r << "\ttheta" << theta << endl;
-        /* !watch out when delta_theta > 90 */
-        if ((i > 0) && (fabs(theta_avg - theta) > (CV_PI / 2))) {
-            r_avg = r_avg + (-r);   // toggle sign
-            if (theta > 0) {
-                theta_avg = theta_avg + (CV_PI - theta);
-            }
-            else {
-                theta_avg = theta_avg + (-CV_PI - theta);
-            }
-        }
-        else {
-            r_avg += r; // / (double)global_max;
-            theta_avg += theta; /// (double)global_max;
-        }
+    struct rig_cam_s* cam = rig_cam(ThreadId);
+    if ((cam == nullptr) || (cam->bin_thresh <= 0)) {
+        return img_proc.bin_thresh;
     }
-    r_avg = r_avg / global_max;
-    theta_avg = theta_avg / global_max;
 
-    //cout << r_avg << "\t" << theta_avg << endl;
-    /* draw average line */
-    ip::drawLine(cur_line, r_avg, theta_avg);
+    return cam->bin_thresh;
+}
 
-    /* return line values */
-    line->r = r_avg;
-    line->theta = theta_avg;
-    //cout << "Debug r_avg: " << r_avg << "\ttheta_avg" << theta_avg << endl;
+/* minimum difference of a camera, the global parameter if the rig does not set one */
+static int img_proc_diff_min_thresh(int ThreadId) {
 
-    /* create windows */
-    if (show_imgs == SHOW_NO_IMAGES) {
-        return EXIT_SUCCESS;
+    struct rig_cam_s* cam = rig_cam(ThreadId);
+    if ((cam == nullptr) || (cam->diff_min_thresh <= 0)) {
+        return img_proc.diff_min_thresh;
     }
-    else if (show_imgs == SHOW_ALL_IMAGES) {
-
-        /* curent image plots */
-        string image_basic = string("Current Image (").append(CamNameId).append(" Cam)");
-        string image_gray = string("Current Image Gray (").append(CamNameId).append(" Cam)");
-        cv::imshow(image_basic, cur);
-        cv::imshow(image_gray, cur_gray);
-
-        /* sharpend images */
-        string image_sharp = string("Image Sharp (").append(CamNameId).append(" Cam)");
-        string image_sharp_gray = string("Image Sharp Gray (").append(CamNameId).append(" Cam)");
-        cv::imshow(image_sharp, cur_sharp);
-        cv::imshow(image_sharp_gray, cur_sharp_gray);
-
-        /* difference images */
-        string image_diff_basic = string("Image Diff (").append(CamNameId).append(" Cam)");
-        string image_diff_gray = string("Image Diff Gray (").append(CamNameId).append(" Cam)");
-        string image_diff_sharp = string("Image Diff Sharp (").append(CamNameId).append(" Cam)");
-        string image_diff_sharp_gray = string("Image Diff Sharp Gray (").append(CamNameId).append(" Cam)");
-        cv::imshow(image_diff_basic, diff);
-        cv::imshow(image_diff_gray, diff_gray);
-        cv::imshow(image_diff_sharp, diff_sharp);
-        cv::imshow(image_diff_sharp_gray, diff_sharp_gray);
-
-        /* sharpened images after diff */
-        string image_sharp_diff = string("Image Sharpened After Diff (").append(CamNameId).append(" Cam)");
-        string image_sharp_diff_gray = string("Image Sharpened After Diff Gray (").append(CamNameId).append(" Cam)");
-        cv::imshow(image_sharp_diff, sharp_after_diff);
-        cv::imshow(image_sharp_diff_gray, sharp_after_diff_gray);
-
-
-        /* edge image */
-        string image_edge = string("Edge Image (").append(CamNameId).append(" Cam)");
-        cv::imshow(image_edge, edge);
-        /* edge binary image */
-        string image_edge_bin = string("Image Edge Bin (").append(CamNameId).append(" Cam)");
-        cv::imshow(image_edge_bin, edge_bin);
-
-        /* Hough transform (line images) */
-        string image_orig = string("Image Orig with line (").append(CamNameId).append(" Cam)");
-        cv::imshow(image_orig, cur_line);
-        // redundant string image_edge = string("Edge Image ").append(CamNameId);
-        string image_hspace = string("HoughSpace (").append(CamNameId).append(" Cam)");
-        cv::imshow(image_hspace, houghSpace);
 
+    return cam->diff_min_thresh;
+}
 
-        return EXIT_SUCCESS;
+/* name of a line extraction method, NULL if unknown */
+const char* img_proc_line_method_name(int method) {
 
+    if ((method < 0) || (method >= LINE_METHOD_COUNT)) {
+        return NULL;
     }
-    else if (show_imgs == SHOW_SHORT_ANALYSIS) {
 
-        /* Hough transform (line images) */
-        string image_orig = string("Image Orig with line (").append(CamNameId).append(" Cam)");
-        cv::imshow(image_orig, cur_line);
-        /* edge image */
-        string image_edge = string("Edge Image (").append(CamNameId).append(" Cam)");
-        cv::imshow(image_edge, edge);
-        /* edge binary image */
-        string image_edge_bin = string("Image Edge Bin (").append(CamNameId).append(" Cam)");
-        cv::imshow(image_edge_bin, edge_bin);
-        /* sharpened images after diff */
-        string image_sharp_diff = string("Image Sharpened After Diff (").append(CamNameId).append(" Cam)");
-        string image_sharp_diff_gray = string("Image Sharpened After Diff Gray (").append(CamNameId).append(" Cam)");
-        cv::imshow(image_sharp_diff, sharp_after_diff);
-        cv::imshow(image_sharp_diff_gray, sharp_after_diff_gray);
-        return EXIT_SUCCESS;
-    }
+    return line_extractors[method]->name();
+}
 
+/* line extraction method of a name, -1 if unknown */
+int img_proc_line_method_from_name(const char* name) {
 
-    if (show_imgs == SHOW_IMG_LINE) {
-        /* Hough transform (line images) */
-        string image_orig = string("Image Orig with line (").append(CamNameId).append(" Cam)");
-        cv::imshow(image_orig, cur_line);
-    }
-    if (show_imgs == SHOW_EDGE_IMG) {
-        /* edge image */
-        string image_edge = string("Edge Image (").append(CamNameId).append(" Cam)");
-        cv::imshow(image_edge, edge);
-    }
-    if (show_imgs == SHOW_EDGE_BIN) {
-        /* edge binary image */
-        string image_edge_bin = string("Image Edge Bin (").append(CamNameId).append(" Cam)");
-        cv::imshow(image_edge_bin, edge_bin);
-    }
-    if (show_imgs == SHOW_SHARP_AFTER_DIFF) {
-        /* sharpened images after diff */
-        string image_sharp_diff = string("Image Sharpened After Diff (").append(CamNameId).append(" Cam)");
-        string image_sharp_diff_gray = string("Image Sharpened After Diff Gray (").append(CamNameId).append(" Cam)");
-        cv::imshow(image_sharp_diff, sharp_after_diff);
-        cv::imshow(image_sharp_diff_gray, sharp_after_diff_gray);
+    for (int method = 0; method < LINE_METHOD_COUNT; method++) {
+        if (strcmp(name, line_extractors[method]->name()) == 0) {
+            return method;
+        }
     }
 
-
-    return EXIT_SUCCESS;
-
+    return -1;
 }
-
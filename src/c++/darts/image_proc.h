@@ -38,6 +38,7 @@
 /* Include files */
 #include <opencv2/opencv.hpp>
 #include <string>
+#include "EdgeList.h"
 
 
 /*************************** global Defines **********************************/
@@ -57,18 +58,55 @@
 
 #define GAUSSIAN_BLUR_SIGMA 0.75
 
+#define SHARPEN_KERNEL_CENTER 11	// center weight of the 3x3 sharpening kernel
+
+#define LINE_CANDIDATES_MAX 3	// candidate lines per camera (top-k)
+
+/* line extraction methods, selectable per camera (img_proc_set_line_method()) */
+#define LINE_METHOD_PCA 0		// coarse-to-fine PCA of the dart cluster with robust refit
+#define LINE_METHOD_HOUGH 1		// coarse-to-fine Hough transform of all edges
+#define LINE_METHOD_CONTOUR 2	// barrel contour predicts a window for the Hough transform
+#define LINE_METHOD_COUNT 3
+#define LINE_METHOD_DEFAULT LINE_METHOD_PCA
+
+/* quality of an extracted line */
+struct line_conf_s {
+
+	int inliers = 0;			// edge pixels supporting the line
+	double rms = 0;				// residual rms of the inliers [pixel]
+	double theta_sigma = 0;		// angular uncertainty [rad]
+	double cluster_area = 0;	// white pixels of the dart cluster (full resolution)
+
+};
+
+/* candidate line of one camera */
+struct line_cand_s {
+
+	double r = 0;
+	double theta = 0;
+	struct line_conf_s conf;	// quality of the candidate, conf.cluster_area ranks the candidates
+	cv::Point2f tip;
+	bool tip_valid = false;
+	cv::RotatedRect band;		// footprint of the dart for cluster_erase() (camera image)
+	bool band_valid = false;
+
+};
+
 /* polar coordinates */
 struct line_s {
 
 	double r = 0;
 	double theta= 0;
+	struct line_conf_s conf;
 
-};
+	bool valid = false;			// line has been extracted
+	cv::Point2f tip;			// dart tip on the line (image coordinates)
+	bool tip_valid = false;		// tip could be located
+
+	int num_candidates = 0;		// candidates[0] is the line above until img_proc_select_candidates()
+	int selected = 0;			// candidate written to r, theta, conf and tip
+	struct line_cand_s candidates[LINE_CANDIDATES_MAX];
 
-struct tripple_line_s {
-	struct line_s line_top;
-	struct line_s line_right;
-	struct line_s line_left;
 };
 
 /* cartesian coordinates */
@@ -77,11 +115,67 @@ struct line_cart_s {
 	cv::Point p1;
 };
 
-struct tri_line_cart_s {
-	struct line_cart_s top;
-	struct line_cart_s right;
-	struct line_cart_s left;
+/* line rejected by the fusion (outlier camera) */
+struct line_reject_s {
+	int line = -1;				// index of the line, camera id of the rig
+	double residual = 0;		// distance of the line to the intersection of the other lines [pixel]
+	double tip_dist = -1;		// distance of its tip to that intersection [pixel], -1 without tip
+	std::string reason;
+};
+
+/* least squares intersection of the camera lines */
+struct cross_point_s {
+	cv::Point2f p;				// intersection (image coordinates)
+	cv::Matx22d cov;			// covariance of p [pixel^2]
+	cv::RotatedRect ellipse;	// 1 sigma uncertainty ellipse
+	double rms = 0;				// rms distance of p to the lines [pixel]
+	int num_lines = 0;			// lines used, 0 if p is the tip of a single camera
+	bool valid = false;
+	std::vector<double> residuals;				// distance of every line to p [pixel], -1 if the line is missing
+	std::vector<struct line_reject_s> rejected;	// outlier cameras, not part of p
+	cv::Point2f p_mm;			// board coordinates around the bull [mm], see img_proc_triangulate()
+	cv::Matx22d cov_mm;			// covariance of p_mm [mm^2]
+	double rms_mm = 0;			// rms distance of p_mm to the camera planes [mm]
+	bool metric = false;		// p_mm, cov_mm and rms_mm are valid, p stays the pixel intersection
+};
 
+/* intermediate images of img_proc_get_line(), see img_proc_get_line_debug() */
+struct img_proc_debug_s {
+	cv::Mat cur;						// calibrated current image
+	cv::Mat cur_gray;
+	cv::Mat diff_gray;					// difference image
+	cv::Mat sharp_after_diff_gray;		// sharpened difference image
+	cv::Mat edge;						// sobel magnitude
+	cv::Mat edge_bin;					// binary edge image without detected darts
+	cv::Mat edge_bin_cont;				// edge image with clusters / contours and lines
+	cv::Mat hough_space;				// Hough space with peaks (Hough version only)
+	cv::Mat cur_line;					// current image with the final line
+};
+
+/* edges of one camera, input of a LineExtractor */
+struct line_edges_s {
+	int ThreadId;						// camera perspective
+	cv::Mat cur;						// calibrated current image (debug drawings)
+	cv::Mat edge_bin;					// binary edge image without the darts of the current visit
+	ip::EdgeList edges;					// same pixels, with gradient direction if needed
+};
+
+/* line extraction method, one implementation per LINE_METHOD_* */
+class LineExtractor {
+public:
+	virtual ~LineExtractor() {}
+
+	/* name for the command line and the benchmark */
+	virtual const char* name() const = 0;
+
+	/* true if the edge list needs the gradient direction */
+	virtual bool needsDirection() const = 0;
+
+	/* fit the line, production version without any debug images */
+	virtual int extract(struct line_edges_s* in, struct line_s* line) const = 0;
+
+	/* fit the line and capture every stage into debug */
+	virtual int extractDebug(struct line_edges_s* in, struct line_s* line, struct img_proc_debug_s* debug) const = 0;
 };
 
 /************************** Function Declaration *****************************/
@@ -89,20 +183,30 @@ extern int img_proc_get_line(cv::Mat& lastImg, cv::Mat& currentImg, int ThreadId
 
 extern void img_proc_sharpen_img(const cv::Mat& inputImage, cv::Mat& outputImage);
 extern void drawLine(cv::Mat& img, cv::Point p, cv::Vec2f dir, cv::Scalar color, int length = 1000);
-extern void calculatePolarCoordinates(cv::Point p, cv::Vec2f dir, cv::Mat& img, float& r, float& theta);
+extern void calculatePolarCoordinates(cv::Point2f p, cv::Vec2f dir, cv::Mat& img, float& r, float& theta);
 extern cv::Mat getRotatedROI(const cv::Mat& img, cv::Point2f center, cv::Vec2f axis, int width, int height);
 extern void drawRotatedRect(cv::Mat& img, cv::RotatedRect rRect, cv::Scalar color);
+extern void img_proc_band_points(const cv::Mat& bin, const cv::RotatedRect& band, std::vector<cv::Point>& points);
+extern void img_proc_band_points(const ip::EdgeList& edges, const cv::RotatedRect& band, std::vector<cv::Point>& points);
+extern bool img_proc_find_tip(const std::vector<cv::Point>& points, cv::Point2f centroid, cv::Vec2f axis, cv::Point2f& tip);
+extern void img_proc_print_line_conf(int status, struct line_s* line, std::string CamNameId);
+extern int img_proc_fit_line_robust(const std::vector<cv::Point>& points, cv::Point2f& centroid, cv::Vec2f& axis, struct line_conf_s* conf);
 extern void cluster_erase(cv::Mat& image, int ThreadId);
+extern void cluster_erase(ip::EdgeList& edges, int ThreadId);
+extern void img_proc_footprint_clear(void);
+extern void img_proc_footprint_store(const struct line_s* line, int ThreadId, cv::Size frameSize, const struct cross_point_s* cross);
 extern void skeletonize(const cv::Mat& input, cv::Mat& output);
 
 extern void img_proc_get_cross_points(const cv::Mat& image, std::vector<cv::Point>& maxLocations);
-extern int img_proc_cross_point(cv::Size frameSize, struct tripple_line_s* tri_line, cv::Point& cross_p);
+extern int img_proc_cross_point(cv::Size frameSize, struct line_s* const* lines, int num, cv::Point& cross_p);
 
 
 extern void img_proc_polar_to_cart(const cv::Mat& image, struct line_s l, struct line_cart_s& cart);
-extern bool img_proc_find_intersection(const line_cart_s& line1, const line_cart_s& line2, cv::Point& intersection);
-extern cv::Point img_proc_calculate_midpoint(cv::Point& p1, cv::Point& p2, cv::Point& p3);
-extern int img_proc_cross_point_math(cv::Size frameSize, struct tripple_line_s* tri_line, cv::Point& cross_p);
+extern bool img_proc_same_line(double r1, double theta1, double r2, double theta2);
+extern void img_proc_select_candidates(cv::Size frameSize, struct line_s* const* lines, int num);
+extern int img_proc_intersect_lines(const struct line_s* const* lines, int num, cv::Size frameSize, struct cross_point_s* cross);
+extern int img_proc_triangulate(const struct line_s* const* lines, int num, cv::Size frameSize, struct cross_point_s* cross);
+extern int img_proc_cross_point_math(cv::Size frameSize, struct line_s* const* lines, int num, struct cross_point_s* cross, int show_imgs = SHOW_NO_IMAGES);
 
 
 extern int img_proc_diff_check(cv::Mat& last_f, cv::Mat& cur_f, int ThreadId);
@@ -111,7 +215,7 @@ extern int img_proc_diff_check_cal(cv::Mat& last_f, cv::Mat& cur_f, int ThreadId
 extern void computeAndShowCorrelation(const cv::Mat& img1, const cv::Mat& img2);
 
 
-extern void img_proc_calibration(cv::Mat& raw_top, cv::Mat& raw_right, cv::Mat& raw_left, cv::Mat& dart_top, cv::Mat& dart_right, cv::Mat& dart_left);
+extern void img_proc_calibration(void);
 extern void img_proc_auto_calibration();
 
 extern void on_trackbar_bin_thresh(int thresh, void* arg);
@@ -128,9 +232,24 @@ extern void img_proc_set_aspect_ratio_min(int aspect_ratio_min);
 extern void img_proc_set_area_min(int area_min);
 extern void img_proc_set_short_edge_max(int short_edge_min);
 
+extern int img_proc_set_line_method(int ThreadId, int method);
+extern int img_proc_get_line_method(int ThreadId);
+extern const char* img_proc_line_method_name(int method);
+extern int img_proc_line_method_from_name(const char* name);
+extern void img_proc_set_native(bool native);
+extern bool img_proc_get_native(void);
+extern void img_proc_set_show(int show_imgs);
+extern int img_proc_get_show(void);
+extern int img_proc_show_from_name(const char* name, int* show_imgs);
+extern int img_proc_set_ctf_levels(int levels);
+extern int img_proc_get_ctf_levels(void);
+extern void img_proc_line_to_board(const cv::Mat& H, cv::Size frameSize, struct line_s* line, const cv::Matx33d& K = cv::Matx33d(), const cv::Mat& dist = cv::Mat());
+extern int img_proc_run_line_method(const cv::Mat& lastImg, const cv::Mat& currentImg, int ThreadId, int method, struct line_s* line, bool calibrate = true);
+
 
 
 
-extern int img_proc_get_line_debug(cv::Mat& lastImg, cv::Mat& currentImg, int ThreadId, struct line_s* line, int show_imgs = 0, std::string CamNameId = "Default");
+extern int img_proc_get_line_debug(cv::Mat& lastImg, cv::Mat& currentImg, int ThreadId, struct line_s* line, struct img_proc_debug_s* debug);
+extern void img_proc_show_debug(const struct img_proc_debug_s* debug, int show_imgs = SHOW_ALL_IMAGES, std::string CamNameId = "Default");
 
 #endif 
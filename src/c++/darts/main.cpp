@@ -61,6 +61,8 @@
 #include <cstring>
 #include "command_parser.h"
 #include "external_api.h"
+#include "benchmark.h"
+#include "rig.h"
 
 
 /****************************** namespaces ***********************************/
@@ -75,6 +77,7 @@ using namespace std;
 #define SIMULATION 0                // use Simluation Cams Thread instead of 
                                     // real cams Thread
 #define LOAD_STATIC_TEST_IMAGES 0   // use this macro for debugging and test
+#define RUN_BENCHMARK 0             // self-check and timing of the image processing kernels
 
 
 
@@ -99,7 +102,8 @@ void static_test(void);
 /****************************** main function ********************************/
 int main() {
     
-
+    /* camera rig: RIG_CONFIG or top / right / left */
+    rig_init();
     
     // call these lines to store new reference images 
     /*
@@ -216,6 +220,13 @@ int main() {
 
     static_test();
 
+#endif 
+
+/* self-check and timing of the image processing kernels on the test images */
+#if RUN_BENCHMARK
+
+    benchmark_run();
+
 #endif 
 
 
@@ -262,7 +273,9 @@ void static_test(void) {
 
     //destroyAllWindows();
     struct line_s line;
-    struct tripple_line_s t_line;
+    struct line_s t_line[3];
+    struct line_s* lines[3] = { &t_line[TOP_CAM], &t_line[RIGHT_CAM], &t_line[LEFT_CAM] };
+    struct img_proc_debug_s debug;
     line.r = 1;
     line.theta = 99;
 
@@ -271,30 +284,35 @@ void static_test(void) {
     left_raw = imread(LEFT_RAW_IMG_CAL, IMREAD_ANYCOLOR);
 
 #if 1
-    img_proc_get_line_debug(top_raw, top_image, TOP_CAM, &t_line.line_top, SHOW_SHORT_ANALYSIS, "Top Static Test");
+    img_proc_get_line_debug(top_raw, top_image, TOP_CAM, &t_line[TOP_CAM], &debug);
+    img_proc_show_debug(&debug, SHOW_SHORT_ANALYSIS, "Top Static Test");
     waitKey(0);
-    img_proc_get_line_debug(right_raw, right_image, RIGHT_CAM, &t_line.line_right, SHOW_SHORT_ANALYSIS, "Right Static Test");
+    img_proc_get_line_debug(right_raw, right_image, RIGHT_CAM, &t_line[RIGHT_CAM], &debug);
+    img_proc_show_debug(&debug, SHOW_SHORT_ANALYSIS, "Right Static Test");
     waitKey(0);
-    img_proc_get_line_debug(left_raw, left_image, LEFT_CAM, &t_line.line_left, SHOW_SHORT_ANALYSIS, "Left Static Test");
+    img_proc_get_line_debug(left_raw, left_image, LEFT_CAM, &t_line[LEFT_CAM], &debug);
+    img_proc_show_debug(&debug, SHOW_SHORT_ANALYSIS, "Left Static Test");
     waitKey(0);
 #endif 
 #if 0
-    img_proc_get_line(top_image, top_image2, TOP_CAM, &t_line.line_top, SHOW_SHORT_ANALYSIS, "Top Static Test");
-    img_proc_get_line(right_image, right_image2, RIGHT_CAM, &t_line.line_right, SHOW_SHORT_ANALYSIS, "Right Static Test");
-    img_proc_get_line(left_image, left_image2, LEFT_CAM, &t_line.line_left, SHOW_SHORT_ANALYSIS, "Left Static Test");
+    img_proc_get_line(top_image, top_image2, TOP_CAM, &t_line[TOP_CAM], SHOW_SHORT_ANALYSIS, "Top Static Test");
+    img_proc_get_line(right_image, right_image2, RIGHT_CAM, &t_line[RIGHT_CAM], SHOW_SHORT_ANALYSIS, "Right Static Test");
+    img_proc_get_line(left_image, left_image2, LEFT_CAM, &t_line[LEFT_CAM], SHOW_SHORT_ANALYSIS, "Left Static Test");
 #endif
 #if 0
-    img_proc_get_line(top_image2, top_image3, TOP_CAM, &t_line.line_top, SHOW_IMG_LINE, "Top Static Test");
-    img_proc_get_line(right_image2, right_image3, RIGHT_CAM, &t_line.line_right, SHOW_IMG_LINE, "Right Static Test");
-    img_proc_get_line(left_image2, left_image3, LEFT_CAM, &t_line.line_left, SHOW_SHORT_ANALYSIS, "Left Static Test");
+    img_proc_get_line(top_image2, top_image3, TOP_CAM, &t_line[TOP_CAM], SHOW_IMG_LINE, "Top Static Test");
+    img_proc_get_line(right_image2, right_image3, RIGHT_CAM, &t_line[RIGHT_CAM], SHOW_IMG_LINE, "Right Static Test");
+    img_proc_get_line(left_image2, left_image3, LEFT_CAM, &t_line[LEFT_CAM], SHOW_SHORT_ANALYSIS, "Left Static Test");
 #endif
 
     destroyAllWindows();
     Point cross_point;
+    struct cross_point_s cross;
     calibration_get_img(top_raw, top_raw, TOP_CAM);
     imwrite("top_raw_cal.jpg", top_raw);
-    img_proc_cross_point(top_raw.size(), &t_line, cross_point);
-    img_proc_cross_point_math(top_raw.size(), &t_line, cross_point);
+    img_proc_cross_point(top_raw.size(), lines, 3, cross_point);
+    img_proc_cross_point_math(top_raw.size(), lines, 3, &cross, SHOW_SHORT_ANALYSIS);
+    cross_point = Point(cvRound(cross.p.x), cvRound(cross.p.y));
     cout << "Raw Cal Size" << top_raw.size() << endl;
 
     /*
@@ -0,0 +1,344 @@
+/******************************************************************************
+ *
+ * rig.cpp
+ *
+ *
+ * Automated Dart Detection and Scoring System
+ *
+ *
+ * This project was developed as part of the Digital Image / Video Processing
+ * module at HAW Hamburg under Prof. Dr. Marc Hensel
+ *
+ *
+ *
+ * Author(s):   	Mika Paul Salewski <mika.paul.salewski@gmail.com>
+ *
+ * Created on :     2025-01-06
+ * Last revision :  None
+ *
+ *
+ *
+ * Copyright (c) 2025, Mika Paul Salewski
+ * Version: 2025.01.06
+ * License: CC BY-NC-SA 4.0,
+ *      see https://creativecommons.org/licenses/by-nc-sa/4.0/deed.en
+ *
+ *
+ * Further information about this source-file:
+ *      --> camera rig: any number of cameras (up to RIG_CAMS_MAX), each with
+ *          its own id, device, homography, thresholds and detection state
+ *      --> capture, detection, fusion and scoring loop over the rig; the
+ *          camera id is the ThreadId of the image processing
+ *      --> default rig is top / right / left, a fourth camera against
+ *          occlusion or a two camera board is described in RIG_CONFIG
+******************************************************************************/
+
+
+
+/* compiler settings */
+#define _CRT_SECURE_NO_WARNINGS     // enable getenv()
+/***************************** includes **************************************/
+#include <iostream>
+#include <cstdlib>
+#include <cctype>
+#include <string>
+#include <opencv2/opencv.hpp>
+#include "rig.h"
+#include "image_proc.h"
+#include "cams.h"
+#include "calibration.h"
+
+/****************************** namespaces ***********************************/
+using namespace cv;
+using namespace std;
+
+
+
+/*************************** local Defines ***********************************/
+
+
+/************************** local Structure ***********************************/
+/***
+ * cameras are stored in a fixed table, so pointers returned by rig_cam()
+ * stay valid while cameras are added
+***/
+static struct rig_s {
+    struct rig_cam_s cams[RIG_CAMS_MAX];
+    int num_cams = 0;
+}rig;
+
+
+/************************* local Variables ***********************************/
+
+
+
+/************************** Function Declaration *****************************/
+
+
+
+/************************** Function Definitions *****************************/
+/***
+ *
+ * rig_init(void)
+ *
+ * Create the camera rig: the cameras described in RIG_CONFIG or the default
+ * rig top / right / left (TOP_CAM, RIGHT_CAM, LEFT_CAM)
+ *
+ *
+ * @param:	void
+ *
+ *
+ * @return: void
+ *
+ *
+ * @note:	Call this once at program start before any thread is created.
+ *
+ *
+ * Example usage: None
+ *
+***/
+void rig_init(void) {
+
+    if (rig_load(RIG_CONFIG) == EXIT_SUCCESS) {
+        std::cout << "[INFO] camera rig: " << rig.num_cams << " cameras from " << RIG_CONFIG << std::endl;
+        return;
+    }
+
+    /* default rig, ids are TOP_CAM, RIGHT_CAM and LEFT_CAM */
+    rig.num_cams = 0;
+    rig_add_cam("Top", TOP_CAM, TOP_REF);
+    rig_add_cam("Right", RIGHT_CAM, RIGHT_REF);
+    rig_add_cam("Left", LEFT_CAM, LEFT_REF);
+}
+
+
+
+/***
+ *
+ * rig_load(const std::string& path)
+ *
+ * Load the camera rig from a file, e.g.:
+ *
+ *      cams:
+ *        - { name: "Top", device: 0, ref: "images/ref_w_light/top_ref.jpg" }
+ *        - { name: "Right", device: 1, ref: "images/ref_w_light/right_ref.jpg", bin_thresh: 35 }
+ *        - { name: "Bottom", device: 3, ref: "images/ref_w_light/bottom_ref.jpg", line_method: "hough" }
+ *
+ *
+ * @param:	const std::string& path --> yml / xml / json file (cv::FileStorage)
+ *
+ *
+ * @return: int status --> EXIT_FAILURE if the file is missing or invalid,
+ *          the rig is empty then
+ *
+ *
+ * @note:	bin_thresh, diff_min_thresh and line_method are optional, the
+ *          global image processing parameters are used without them;
+ *          hfov (degrees) is optional as well, RIG_HFOV_DEG without it;
+ *          intrinsics is the file of calibration_intrinsics_save().
+ *
+ *
+ * Example usage: None
+ *
+***/
+int rig_load(const std::string& path) {
+
+    rig.num_cams = 0;
+
+    FileStorage fs(path, FileStorage::READ);
+    if (!fs.isOpened()) {
+        return EXIT_FAILURE;
+    }
+
+    FileNode cams = fs["cams"];
+    if (cams.empty() || (cams.size() == 0)) {
+        std::cout << "[ERROR] " << path << ": no cameras" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    for (int i = 0; i < (int)cams.size(); i++) {
+        FileNode c = cams[i];
+        if (c["name"].empty() || c["device"].empty() || c["ref"].empty()) {
+            std::cout << "[ERROR] " << path << ": camera " << i << " needs name, device and ref" << std::endl;
+            rig.num_cams = 0;
+            return EXIT_FAILURE;
+        }
+
+        int id = rig_add_cam((string)c["name"], (int)c["device"], (string)c["ref"]);
+        if (id < 0) {
+            rig.num_cams = 0;
+            return EXIT_FAILURE;
+        }
+
+        /* optional camera specific parameters */
+        struct rig_cam_s* cam = rig_cam(id);
+        if (!c["bin_thresh"].empty()) {
+            cam->bin_thresh = (int)c["bin_thresh"];
+        }
+        if (!c["diff_min_thresh"].empty()) {
+            cam->diff_min_thresh = (int)c["diff_min_thresh"];
+        }
+        if (!c["line_method"].empty()) {
+            string method = (string)c["line_method"];
+            cam->line_method = img_proc_line_method_from_name(method.c_str());
+            if (cam->line_method < 0) {
+                std::cout << "[ERROR] " << path << ": unknown line method " << method << std::endl;
+                rig.num_cams = 0;
+                return EXIT_FAILURE;
+            }
+        }
+        if (!c["hfov"].empty()) {
+            cam->hfov = (double)c["hfov"];
+        }
+        if (!c["intrinsics"].empty() && (calibration_intrinsics_load(id, (string)c["intrinsics"]) != EXIT_SUCCESS)) {
+            rig.num_cams = 0;
+            return EXIT_FAILURE;
+        }
+    }
+
+    return EXIT_SUCCESS;
+}
+
+
+
+/* add a camera to the rig; returns the id of the camera or -1 if the rig is full */
+int rig_add_cam(const std::string& name, int device, const std::string& ref_img) {
+
+    if (rig.num_cams >= RIG_CAMS_MAX) {
+        std::cout << "[ERROR] camera rig is full (" << RIG_CAMS_MAX << " cameras)" << std::endl;
+        return -1;
+    }
+
+    /* slot might be left over from an invalid RIG_CONFIG (cv::VideoCapture is not assigned) */
+    struct rig_cam_s* cam = &rig.cams[rig.num_cams];
+    cam->id = rig.num_cams;
+    cam->device = device;
+    cam->name = name;
+    cam->ref_img = ref_img;
+    cam->H.release();
+    cam->map1.release();
+    cam->map2.release();
+    cam->hfov = RIG_HFOV_DEG;
+    cam->intrinsics = false;
+    cam->dist.release();
+    cam->pose_valid = false;
+    cam->bin_thresh = 0;
+    cam->diff_min_thresh = 0;
+    cam->line_method = LINE_METHOD_DEFAULT;
+    cam->win = name + " Cam [press Esc to quit]";
+    cam->last.release();
+    cam->cur.release();
+    cam->diff_flag = 0;
+    cam->line_status = EXIT_FAILURE;
+    cam->line = line_s();
+
+    return rig.num_cams++;
+}
+
+/* number of cameras in the rig */
+int rig_num_cams(void) {
+
+    return rig.num_cams;
+}
+
+/* camera of an id (ThreadId), nullptr if the rig has no such camera */
+struct rig_cam_s* rig_cam(int id) {
+
+    if ((id < 0) || (id >= rig.num_cams)) {
+        return nullptr;
+    }
+
+    return &rig.cams[id];
+}
+
+/* id of a camera name (case insensitive), -1 if unknown */
+int rig_find_cam(const char* name) {
+
+    for (int i = 0; i < rig.num_cams; i++) {
+        const string& cam_name = rig.cams[i].name;
+        size_t k = 0;
+        while ((k < cam_name.size()) && (name[k] != '\0') && (tolower((unsigned char)cam_name[k]) == tolower((unsigned char)name[k]))) {
+            k++;
+        }
+        if ((k == cam_name.size()) && (name[k] == '\0')) {
+            return i;
+        }
+    }
+
+    return -1;
+}
+
+
+
+/***
+ *
+ * rig_open(void)
+ *
+ * Open the devices of all cameras in the rig
+ *
+ *
+ * @param:	void
+ *
+ *
+ * @return: int status --> EXIT_FAILURE if a camera cannot be opened
+ *
+ *
+ * @note:	None
+ *
+ *
+ * Example usage: None
+ *
+***/
+int rig_open(void) {
+
+    for (int i = 0; i < rig.num_cams; i++) {
+        struct rig_cam_s* cam = &rig.cams[i];
+        cam->cap.open(cam->device, CAP_ANY);
+        if (!cam->cap.isOpened()) {
+            std::cout << "[ERROR] cannot open " << cam->name << " Camera" << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
+
+    return EXIT_SUCCESS;
+}
+
+/* read the current frames of all cameras; EXIT_FAILURE if any frame is empty */
+int rig_grab(void) {
+
+    int status = EXIT_SUCCESS;
+    for (int i = 0; i < rig.num_cams; i++) {
+        rig.cams[i].cap >> rig.cams[i].cur;
+        if (rig.cams[i].cur.empty()) {
+            status = EXIT_FAILURE;
+        }
+    }
+
+    return status;
+}
+
+/* show the current frames of all cameras */
+void rig_show(void) {
+
+    for (int i = 0; i < rig.num_cams; i++) {
+        if (!rig.cams[i].cur.empty()) {
+            imshow(rig.cams[i].win, rig.cams[i].cur);
+        }
+    }
+}
+
+/* current frames become the last frames */
+void rig_update_last(void) {
+
+    for (int i = 0; i < rig.num_cams; i++) {
+        rig.cams[i].last = rig.cams[i].cur.clone();
+    }
+}
+
+/* free the devices of all cameras */
+void rig_release(void) {
+
+    for (int i = 0; i < rig.num_cams; i++) {
+        rig.cams[i].cap.release();
+    }
+}
@@ -0,0 +1,113 @@
+/******************************************************************************
+ *
+ * rig.h
+ *
+ *
+ * Automated Dart Detection and Scoring System
+ *
+ *
+ * This project was developed as part of the Digital Image / Video Processing
+ * module at HAW Hamburg under Prof. Dr. Marc Hensel
+ *
+ *
+ *
+ * Author(s):   	Mika Paul Salewski <mika.paul.salewski@gmail.com>
+ *
+ * Created on :     2025-01-06
+ * Last revision :  None
+ *
+ *
+ *
+ * Copyright (c) 2025, Mika Paul Salewski
+ * Version: 2025.01.06
+ * License: CC BY-NC-SA 4.0,
+ *      see https://creativecommons.org/licenses/by-nc-sa/4.0/deed.en
+ *
+ *
+ * Further information about this source-file:
+ *      --> camera rig: any number of cameras, each with its own id, device,
+ *          homography, thresholds and detection state
+ *      --> default rig is top / right / left, other rigs are described in
+ *          RIG_CONFIG
+******************************************************************************/
+
+
+#ifndef RIG_H
+#define RIG_H
+
+/* Include files */
+#include <opencv2/opencv.hpp>
+#include <cstdlib>
+#include <string>
+#include "image_proc.h"
+#include "dart_board.h"
+
+
+/*************************** global Defines **********************************/
+#define RIG_CAMS_MAX 8				// cameras of one rig
+#define RIG_CONFIG "rig.yml"		// optional rig description, see rig_load()
+#define RIG_HFOV_DEG 60.0			// horizontal field of view of a camera without intrinsics [deg]
+
+
+/************************* global Structure **********************************/
+/* one camera of the rig */
+struct rig_cam_s {
+
+	/* identity */
+	int id = -1;						// index in the rig, ThreadId of the image processing
+	int device = 0;						// VideoCapture index
+	std::string name;					// "Top", "Right", ...
+	std::string ref_img;				// reference image of the auto calibration
+
+	/* calibration */
+	cv::Mat H;							// homography raw image --> reference board
+	cv::Mat map1, map2;					// fixed point remap tables of H (CV_16SC2 + interpolation), empty := rebuild
+	cv::Rect map_roi;					// board ROI of the tables in the warped image
+	cv::Size map_size;					// frame size of the tables
+	cv::Mat raw_mask;					// board ROI of the tables in the raw image (native mode), built with the tables
+	cv::Mat warp_board;					// scratch of calibration_get_img() for src == dst (camera thread only)
+
+	/* intrinsics (calibration_intrinsics()), H is on undistorted pixels then */
+	bool intrinsics = false;			// K and dist are calibrated
+	cv::Mat dist;						// distortion coefficients, empty := no lens distortion
+
+	/* pose on the board, board coordinates [mm] around the bull (calibration_pose()) */
+	double hfov = RIG_HFOV_DEG;			// intrinsics from the field of view without calibrated intrinsics
+	cv::Matx33d K;						// camera matrix
+	cv::Matx33d R;						// rotation board --> camera
+	cv::Vec3d t;						// translation board --> camera [mm]
+	bool pose_valid = false;
+
+	/* thresholds, 0 := global image processing parameter */
+	int bin_thresh = 0;
+	int diff_min_thresh = 0;
+	int line_method = LINE_METHOD_DEFAULT;
+
+	/* state */
+	cv::VideoCapture cap;
+	std::string win;					// camera window
+	cv::Mat last;						// last frame
+	cv::Mat cur;						// current frame
+	int diff_flag = 0;
+	int line_status = EXIT_FAILURE;
+	struct line_s line;
+
+};
+
+
+/************************** Function Declaration *****************************/
+extern void rig_init(void);
+extern int rig_load(const std::string& path);
+extern int rig_add_cam(const std::string& name, int device, const std::string& ref_img);
+
+extern int rig_num_cams(void);
+extern struct rig_cam_s* rig_cam(int id);
+extern int rig_find_cam(const char* name);
+
+extern int rig_open(void);
+extern int rig_grab(void);
+extern void rig_show(void);
+extern void rig_update_last(void);
+extern void rig_release(void);
+
+#endif